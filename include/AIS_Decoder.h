@@ -27,6 +27,8 @@
 
 #include "ais.h"
 #include "OCPN_SignalKEvent.h"
+#include "SignalKDelta.h"
+#include "AIS_Target_Grid.h"
 #include <map>
 
 #define TRACKTYPE_DEFAULT       0
@@ -70,7 +72,10 @@ public:
     AIS_Error Decode(const wxString& str);
     AIS_Target_Hash *GetTargetList(void) {return AISTargetList;}
     AIS_Target_Hash *GetAreaNoticeSourcesList(void) {return AIS_AreaNotice_Sources;}
+    const AIS_Target_Grid &GetTargetGrid(void) { return m_target_grid; }
+    const std::vector<int> &GetAlertTargets(void) { return m_alert_mmsi; }
     AIS_Target_Data *Get_Target_Data_From_MMSI(int mmsi);
+    void UpdateOneCPA(AIS_Target_Data *ptarget);
     int GetNumTargets(void){ return m_n_targets;}
     bool IsAISSuppressed(void){ return m_bSuppressed; }
     bool IsAISAlertGeneral(void) { return m_bGeneralAlert; }
@@ -89,7 +94,8 @@ private:
     bool NMEACheckSumOK(const wxString& str);
     bool Parse_VDXBitstring(AIS_Bitstring *bstr, AIS_Target_Data *ptd);
     void UpdateAllCPA(void);
-    void UpdateOneCPA(AIS_Target_Data *ptarget);
+    void UpdateOneRangeBrg(AIS_Target_Data *ptarget);
+    double GetCPAHorizon(void);
     void UpdateAllAlarms(void);
     void UpdateAllTracks(void);
     void UpdateOneTrack(AIS_Target_Data *ptarget);
@@ -100,14 +106,17 @@ private:
     void getAISTarget(long mmsi, AIS_Target_Data *&pTargetData, AIS_Target_Data *&pStaleTarget, bool &bnewtarget,
                       int &last_report_ticks, wxDateTime &now);
 
-    void handleUpdate(AIS_Target_Data *pTargetData, bool bnewtarget, wxJSONValue &update);
-    void updateItem(AIS_Target_Data *pTargetData, bool bnewtarget, wxJSONValue &item, wxString &sfixtime) const;
+    void handleUpdate(AIS_Target_Data *pTargetData, bool bnewtarget, const SignalKDeltaUpdate &update);
+    void updateItem(AIS_Target_Data *pTargetData, bool bnewtarget, const SignalKDeltaItem &item, wxString &sfixtime) const;
     
+    SignalKDelta m_signalk_delta;
     wxString m_signalk_selfid;
     AIS_Target_Hash *AISTargetList;
     AIS_Target_Hash *AIS_AreaNotice_Sources;
     AIS_Target_Name_Hash *AISTargetNamesC;
     AIS_Target_Name_Hash *AISTargetNamesNC;
+    AIS_Target_Grid   m_target_grid;
+    std::vector<int>  m_alert_mmsi;
 
     bool              m_busy;
     wxTimer           TimerAIS;
@@ -140,7 +140,7 @@ public:
     
     bool                      b_show_track;
 
-    AISTargetTrackList        *m_ptrack;
+    AISTargetTrack            m_track;
 
     AIS_Area_Notice_Hash     area_notices;
     bool                     b_SarAircraftPosnReport;
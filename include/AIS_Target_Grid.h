@@ -0,0 +1,86 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef __AIS_TARGET_GRID_H__
+#define __AIS_TARGET_GRID_H__
+
+#include <stddef.h>
+#include <unordered_map>
+#include <vector>
+
+class AIS_Target_Data;
+class LLBBox;
+
+//    A uniform Lat/Lon grid of AIS targets, keyed by MMSI.
+//    The grid holds non-owning pointers; the AIS_Decoder target hash owns the data,
+//    and must Remove() a target from the grid before deleting it.
+//    Cells are only allocated when occupied, so the grid is cheap at world scale.
+
+#define AIS_GRID_CELL_DEG       0.1             // about 6 NMi of latitude
+
+class AIS_Target_Grid
+{
+public:
+    AIS_Target_Grid( double cell_deg = AIS_GRID_CELL_DEG );
+    ~AIS_Target_Grid();
+
+    //  Insert a target, or move it to the cell of its current position.
+    //  Targets without a valid position are removed.
+    void Update( AIS_Target_Data *td );
+    void Remove( int mmsi );
+    void Clear( void );
+
+    size_t GetCount( void ) const { return m_cell_of_target.size(); }
+
+    //  Collect all targets whose cell intersects the box.
+    //  The result is a superset of the targets contained in the box.
+    void GetTargetsInBox( const LLBBox &box, std::vector<AIS_Target_Data *> &result ) const;
+    void GetTargetsInRange( double lat, double lon, double range_nm,
+                            std::vector<AIS_Target_Data *> &result ) const;
+    bool AnyTargetInBox( const LLBBox &box ) const;
+
+    //  Upper bound of target SOG, used to size query margins for predictors and tracks
+    double GetMaxSOG( void ) const { return m_max_sog; }
+    void SetMaxSOG( double sog ) { m_max_sog = sog; }
+
+private:
+    typedef std::vector<AIS_Target_Data *> TargetCell;
+
+    int GetRow( double lat ) const;
+    int GetCol( double lon ) const;
+    long GetKey( int row, int col ) const { return (long)row * m_ncols + col; }
+
+    template <typename Visitor>
+    bool VisitBox( const LLBBox &box, Visitor &visit ) const;
+
+    double m_cell_deg;
+    int m_nrows;
+    int m_ncols;
+    double m_max_sog;
+
+    std::unordered_map<long, TargetCell> m_cells;
+    std::unordered_map<int, long> m_cell_of_target;      // MMSI -> cell key
+};
+
+#endif
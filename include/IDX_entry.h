@@ -72,6 +72,7 @@ public:
     int       IDX_ref_file_num;              // # of reference file where reference station is
     char      IDX_reference_name[MAXNAMELEN];// Name of reference station
     int       IDX_ref_dbIndex;               // tcd index of reference station
+    int       IDX_dbIndex;                   // tcd index of this station
     double    max_amplitude;
     int       have_offsets;
     int       station_tz_offset;             // Offset in seconds to convert from harmonic data (epochs) to
@@ -94,12 +95,12 @@ public:
     time_t      epoch;
     int         epoch_year;
 
-    // Cached values
-    time_t      recent_highlow_calc_time;
-    float       recent_high_level;
-    time_t      recent_high_time;
-    float       recent_low_level;
-    time_t      recent_low_time;
+    // Per station harmonic tables for one year, built by figure_multipliers()
+    double      *m_year_mult;                // normalized amplitude times node factor
+    double      *m_year_phase;               // constant part of each constituent's phase
+    int         m_table_year;                // year of the tables, 0 if none
+    int         m_table_csts;
+    Station_Data *m_table_sta;               // reference data the tables were built from
 
 };
 
@@ -0,0 +1,128 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  NMEA/SignalK input capture and replay
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef __NMEACAPTURE_H__
+#define __NMEACAPTURE_H__
+
+#include <wx/string.h>
+#include <wx/ffile.h>
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+//    Capture file layout, all integers little-endian
+//
+//    Header:   8 bytes, NMEA_CAPTURE_MAGIC
+//    Record:   uint64  timestamp, microseconds since capture start (monotonic clock)
+//              uint16  stream id
+//              uint8   record type, one of CAPTURE_RECORD_*
+//              uint32  payload length
+//              payload bytes
+//
+//    A CAPTURE_RECORD_STREAM record, whose payload is the stream port name,
+//    precedes the first data record of each stream id.
+//----------------------------------------------------------------------------
+
+#define NMEA_CAPTURE_MAGIC              "OCPNCAP1"
+#define NMEA_CAPTURE_MAGIC_LEN          8
+#define NMEA_CAPTURE_RECORD_HEADER_LEN  15
+#define NMEA_CAPTURE_FLUSH_SIZE         (64 * 1024)
+#define NMEA_CAPTURE_MAX_PAYLOAD        (1024 * 1024)   // longer records are not written, nor trusted on read
+
+enum {
+    CAPTURE_RECORD_STREAM = 0,
+    CAPTURE_RECORD_NMEA,
+    CAPTURE_RECORD_SIGNALK
+};
+
+class NMEACaptureRecord
+{
+public:
+    uint64_t            m_timestamp_us;
+    uint16_t            m_stream_id;
+    uint8_t             m_type;
+    std::string         m_payload;
+};
+
+//    Appends timestamped input to a capture file.
+//    Records are accumulated in memory and written in large blocks,
+//    so that the cost on the input path is a buffer append.
+class NMEACaptureWriter
+{
+public:
+    NMEACaptureWriter();
+    ~NMEACaptureWriter();
+
+    bool Open( const wxString &path );
+    void Close();
+    bool IsOpen() const { return m_file.IsOpened(); }
+
+    void Write( int type, const wxString &port, const std::string &payload );
+    void Flush();
+
+private:
+    uint16_t GetStreamId( const wxString &port );
+    void AppendRecord( uint64_t timestamp_us, uint16_t stream_id, uint8_t type,
+                       const char *payload, size_t len );
+
+    wxFFile                     m_file;
+    std::vector<unsigned char>  m_buffer;
+    std::map<wxString, uint16_t> m_stream_ids;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+//    Sequential reader for capture files.
+//    Stream declaration records are consumed internally; ReadNext() returns data records only.
+class NMEACaptureReader
+{
+public:
+    NMEACaptureReader();
+    ~NMEACaptureReader();
+
+    bool Open( const wxString &path );
+    void Close();
+    bool IsOpen() const { return m_file.IsOpened(); }
+    bool Rewind();
+
+    bool ReadNext( NMEACaptureRecord &record );
+    wxString GetStreamName( uint16_t stream_id ) const;
+
+private:
+    bool ReadRecord( NMEACaptureRecord &record );
+
+    wxFFile                     m_file;
+    std::map<uint16_t, wxString> m_stream_names;
+};
+
+//    Drive the AIS decoder and the GPS handler synchronously from a capture file,
+//    and report throughput and per-message latency percentiles.
+//    Returns false if the capture could not be read.
+bool RunCaptureBenchmark( const wxString &path );
+
+#endif
@@ -28,8 +28,11 @@
 #include "pugixml.hpp"
 #include <wx/string.h>
 #include <wx/checkbox.h>
+#include <wx/ffile.h>
 #include "bbox.h"
 
+#include <string>
+
 class Track;
 class TrackList;
 class TrackPoint;
@@ -88,6 +91,46 @@ class RoutePoint;
 #define         RT_OUT_NO_RTPTS           1 << 4
 
 
+//----------------------------------------------------------------------------
+//    GPXStreamReader
+//
+//    Reads a GPX file one top level object at a time, so that the whole
+//    document never has to be held in memory. Each child element of the
+//    root (<wpt>, <rte>, <trk>, ...) is returned as its own XML text.
+//    Only UTF-8 files are streamed; Open() refuses anything else.
+//----------------------------------------------------------------------------
+
+class GPXStreamReader
+{
+public:
+    GPXStreamReader();
+    ~GPXStreamReader();
+
+    //  Read up to and including the root element start tag
+    bool Open( const wxString &path );
+    const std::string &GetRootTag() const { return m_root_tag; }
+
+    //  The next child element of the root; false at the end of the root
+    bool ReadNext( std::string &element );
+    //  The file ended before the root element was closed
+    bool IsTruncated() const { return m_btruncated; }
+    wxString GetPath() const { return m_file.GetName(); }
+
+private:
+    enum { MARKUP_OTHER = 0, MARKUP_OPEN, MARKUP_CLOSE, MARKUP_EMPTY };
+
+    bool Fill();
+    int ScanMarkup( size_t pos, size_t &end );
+
+    wxFFile             m_file;
+    std::string         m_buf;
+    size_t              m_pos;                  // start of the unread part of m_buf
+    bool                m_beof;
+    bool                m_bdone;
+    bool                m_btruncated;
+    std::string         m_root_tag;
+};
+
 class NavObjectCollection1 : public pugi::xml_document
 {
 public:
@@ -108,6 +151,12 @@ public:
     bool CreateAllGPXObjects();
     bool LoadAllGPXObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox = false);
     int LoadAllGPXObjectsAsLayer(int layer_id, bool b_layerviz, wxCheckBoxState b_namesviz);
+
+    //  Streaming load. OpenGPXStream() reads only the root element, so that
+    //  IsOpenCPN() may be asked before the objects are loaded. Files that
+    //  cannot be streamed are loaded into the document as before.
+    bool OpenGPXStream( const wxString &path );
+    bool LoadAllGPXStreamObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox = false );
     
     bool SaveFile( const wxString filename );
 
@@ -117,6 +166,10 @@ public:
     
     LLBBox     BBox;
     pugi::xml_node      m_gpx_root;
+    GPXStreamReader     *m_pstream;
+
+private:
+    void CommitStreamedTrack( Track *pTrack, const std::string &error );
 };
 
 
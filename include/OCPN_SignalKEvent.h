@@ -22,12 +22,19 @@ public:
 
     const std::string& GetString() { return m_string; }
 
+    // The port of the stream the delta arrived on
+    void SetStreamName(const wxString &name) { m_stream_name = name; }
+    const wxString& GetStreamName() const { return m_stream_name; }
+
     wxEvent *Clone() const {
-        return new OCPN_SignalKEvent(GetId(), GetEventType(), m_string);
+        OCPN_SignalKEvent *event = new OCPN_SignalKEvent(GetId(), GetEventType(), m_string);
+        event->m_stream_name = m_stream_name;
+        return event;
     };
 
 private:
     std::string m_string;
+    wxString m_stream_name;
 };
 
 
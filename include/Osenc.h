@@ -326,6 +326,7 @@ const char *MyCSVGetField( const char * pszFilename,
 //      Fwd Definitions
 class wxGenericProgressDialog;
 class S57Obj;
+class S57Arena;
 class VE_Element;
 class VC_Element;
 class PolyTessGeo;
@@ -466,6 +467,7 @@ public:
     void setRefLocn( double lat, double lon){ m_ref_lat = lat; m_ref_lon = lon; }
     void setOutstream(Osenc_outstream *stream){ m_pauxOutstream = stream; }
     void setInstream(Osenc_instream *stream){ m_pauxInstream = stream; }
+    void setArena( S57Arena *arena ){ m_pArena = arena; }
     
     wxString getUpdateDate(){ return m_LastUpdateDate; }
     wxString getBaseDate(){ return m_sdate000; }
@@ -597,6 +599,8 @@ private:
     Osenc_outstream       *m_pOutstream;
     Osenc_instream        *m_pInstream;
 
+    S57Arena              *m_pArena;                // ingested objects are created here, if set
+
     bool                  m_bVerbose;
     wxArrayString         *m_UpFiles;
     bool                  m_bPrivateRegistrar;
@@ -0,0 +1,129 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Own ship navigation state, readable from any thread
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef __OWNSHIPTELEMETRY_H__
+#define __OWNSHIPTELEMETRY_H__
+
+#include <wx/string.h>
+#include <wx/thread.h>
+
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+//    Fields of the own ship state, each with its own receipt time and source
+enum {
+    OWNSHIP_POSITION = 0,
+    OWNSHIP_COG,
+    OWNSHIP_SOG,
+    OWNSHIP_HDT,
+    OWNSHIP_HDM,
+    OWNSHIP_VAR,
+    OWNSHIP_SATS,
+    OWNSHIP_FIELD_COUNT
+};
+
+#define OWNSHIP_FIELD_BIT(field)        ( 1 << (field) )
+
+//    OwnShipState::Flags
+#define OWNSHIP_GPS_VALID       0x01
+#define OWNSHIP_SAT_VALID       0x02
+#define OWNSHIP_HDT_RX          0x04
+#define OWNSHIP_VAR_RX          0x08
+
+#define OWNSHIP_SOURCE_UNKNOWN  0
+
+//    A plain copy of the own ship state.
+//    Angles in degrees, speeds in knots, unavailable values are NaN.
+class OwnShipState
+{
+public:
+    double      Lat;
+    double      Lon;
+    double      Cog;
+    double      Sog;
+    double      Hdt;
+    double      Hdm;
+    double      Var;
+    int32_t     nSats;
+    int32_t     Flags;
+
+    int64_t     FieldTime[OWNSHIP_FIELD_COUNT];     // UTC milliseconds of last receipt, 0 if never
+    int32_t     FieldSource[OWNSHIP_FIELD_COUNT];   // see OwnShipTelemetry::GetSourceName()
+    uint32_t    UpdateCount;                        // incremented by every Publish()
+};
+
+//----------------------------------------------------------------------------
+// OwnShipTelemetry
+//
+//      Latest value store for the own ship state.
+//      There is a single writer, the GUI thread, which stages field updates
+//      and then publishes the complete state under a sequence lock.
+//      Readers on any thread get a consistent snapshot without locking,
+//      retrying only if they overlap a publish.
+//----------------------------------------------------------------------------
+
+class OwnShipTelemetry
+{
+public:
+    OwnShipTelemetry();
+
+    //  Writer side, GUI thread only
+    void SetPosition( double lat, double lon ) { m_staged.Lat = lat; m_staged.Lon = lon; }
+    void SetCog( double cog ) { m_staged.Cog = cog; }
+    void SetSog( double sog ) { m_staged.Sog = sog; }
+    void SetHdt( double hdt ) { m_staged.Hdt = hdt; }
+    void SetHdm( double hdm ) { m_staged.Hdm = hdm; }
+    void SetVar( double var ) { m_staged.Var = var; }
+    void SetSats( int nsats ) { m_staged.nSats = nsats; }
+    void SetFlags( int flags ) { m_staged.Flags = flags; }
+
+    //  Stamp the fields in field_mask as just received from source
+    void MarkReceived( int field_mask, int source );
+
+    //  Make the staged state visible to readers
+    void Publish();
+
+    //  Reader side, any thread
+    OwnShipState Get() const;
+
+    //  Source ids are small integers standing for a stream name
+    int GetSourceId( const wxString &name );
+    wxString GetSourceName( int source ) const;
+
+private:
+    enum { NWORDS = ( sizeof( OwnShipState ) + sizeof( uint64_t ) - 1 ) / sizeof( uint64_t ) };
+
+    OwnShipState                m_staged;
+    std::atomic<uint32_t>       m_seq;
+    std::atomic<uint64_t>       m_words[NWORDS];
+
+    mutable wxMutex             m_source_mutex;
+    std::vector<wxString>       m_source_names;
+};
+
+extern OwnShipTelemetry g_OwnShipTelemetry;
+
+#endif
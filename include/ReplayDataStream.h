@@ -0,0 +1,72 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  NMEA/SignalK capture replay DataStream
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#ifndef __REPLAYDATASTREAM_H__
+#define __REPLAYDATASTREAM_H__
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif //precompiled headers
+
+#include <chrono>
+
+#include "datastream.h"
+#include "NMEACapture.h"
+
+#define REPLAY_PORT_PREFIX      _T("Replay:")
+#define REPLAY_MAX_SPEED_BATCH  500             // records per timer tick at maximum speed
+
+//----------------------------------------------------------------------------
+// ReplayDataStream
+//
+//      Feeds the records of a capture file to the input consumer,
+//      preserving their original spacing divided by the speed factor.
+//      A speed of zero or less replays as fast as the event loop allows.
+//----------------------------------------------------------------------------
+
+class ReplayDataStream : public DataStream {
+public:
+    ReplayDataStream( wxEvtHandler *input_consumer, const wxString &path, double speed );
+    virtual ~ReplayDataStream();
+
+    void Close();
+
+private:
+    void OnTimerReplay( wxTimerEvent &event );
+    void PostRecord( const NMEACaptureRecord &record );
+    void ScheduleNext();
+
+    NMEACaptureReader   m_reader;
+    NMEACaptureRecord   m_next;
+    bool                m_bnext_valid;
+    double              m_speed;
+    uint64_t            m_first_ts;
+    std::chrono::steady_clock::time_point m_start;
+    wxTimer             m_replay_timer;
+};
+
+#endif
@@ -26,6 +26,9 @@
 
 #include "SelectItem.h"
 
+#include <vector>
+#include <unordered_map>
+
 #define SELTYPE_UNKNOWN              0x0001
 #define SELTYPE_ROUTEPOINT           0x0002
 #define SELTYPE_ROUTESEGMENT         0x0004
@@ -43,6 +46,32 @@ class Route;
 class RoutePoint;
 class ChartCanvas;
 
+//    Spatial index over the select list.
+//    Items are filed in a hashed grid of lat/lon cells, by position for points
+//    and by bounding box for segments.  Segments covering many cells, or
+//    crossing the date line, are kept apart in a short list returned by
+//    every query.
+//    The index files items by their coordinates, so these must only be
+//    changed through Select.
+
+class SelectGrid
+{
+public:
+    void Insert( SelectItem *pitem );
+    void Remove( SelectItem *pitem );
+
+    //  Collect the items which may lie within the box, possibly more than once.
+    //  Returns false if the box covers too many cells for the index to help.
+    bool Query( float lat0, float lon0, float lat1, float lon1,
+                std::vector<SelectItem *> &items ) const;
+
+private:
+    bool GetCells( SelectItem *pitem, int &ix0, int &iy0, int &ix1, int &iy1 ) const;
+
+    std::unordered_map<uint32_t, std::vector<SelectItem *> > m_cells;
+    std::vector<SelectItem *> m_large;
+};
+
 class Select
 {
 public:
@@ -79,6 +108,7 @@ public:
     bool DeleteAllPoints( void );
     bool DeleteSelectablePoint( void *data, int SeltypeToDelete );
     bool ModifySelectablePoint( float slat, float slon, void *data, int fseltype );
+    void ModifySelectItem( SelectItem *pitem, float slat, float slon );
 
     //    Delete all selectable points in list by type
     bool DeleteAllSelectableTypePoints( int SeltypeToDelete );
@@ -94,10 +124,17 @@ public:
 
 private:
     void CalcSelectRadius(ChartCanvas *cc);
+    wxSelectableItemListNode *AddItem( SelectItem *pitem, bool bappend );
+    void GetCandidates( float slat, float slon, int fseltype );
 
     SelectableItemList *pSelectList;
     int pixelRadius;
     float selectRadius;
+
+    SelectGrid m_grid;
+    int64_t m_first_order;
+    int64_t m_last_order;
+    std::vector<SelectItem *> m_candidates;     // reused by the Find methods
 };
 
 #endif
@@ -27,6 +27,8 @@
 
 #include <wx/list.h>
 
+#include <stdint.h>
+
 class SelectItem
 {
 public:
@@ -46,6 +48,7 @@ public:
       void  *m_pData2;
       void  *m_pData3;
       int   m_Data4;
+      int64_t m_order;              // position in the select list, see Select
 };
 
 WX_DECLARE_LIST(SelectItem, SelectableItemList);// establish class as list member
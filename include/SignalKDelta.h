@@ -0,0 +1,204 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  SignalK delta message parser
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#ifndef __SIGNALKDELTA_H__
+#define __SIGNALKDELTA_H__
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+//    SignalK delta parser
+//
+//    A single pass scanner for SignalK delta messages:
+//
+//      { "context": "...", "self": "...", "version": ...,
+//        "updates": [ { "timestamp": "...",
+//                       "values": [ { "path": "...", "value": ... }, ... ] }, ... ] }
+//
+//    Only the members above are kept; everything else is skipped without
+//    being stored. Known value paths are interned to SignalKPath ids, and
+//    each value is flattened into a short list of scalar leaves keyed by
+//    their dotted member path, e.g. "latitude" or "registrations.imo".
+//    All storage is reused from one message to the next.
+//----------------------------------------------------------------------------
+
+typedef enum SignalKPath
+{
+    SK_PATH_UNKNOWN = 0,
+    SK_PATH_ROOT,                               // "", vessel level objects
+    SK_PATH_NAV_POSITION,
+    SK_PATH_NAV_SOG,
+    SK_PATH_NAV_COG_TRUE,
+    SK_PATH_NAV_COG_MAGNETIC,
+    SK_PATH_NAV_HEADING_TRUE,
+    SK_PATH_NAV_HEADING_MAGNETIC,
+    SK_PATH_NAV_MAGNETIC_VARIATION,
+    SK_PATH_NAV_RATE_OF_TURN,
+    SK_PATH_NAV_GNSS_SATELLITES,
+    SK_PATH_NAV_STATE,
+    SK_PATH_NAV_DESTINATION_NAME,
+    SK_PATH_NAV_SPECIAL_MANEUVER,
+    SK_PATH_DESIGN_AIS_SHIP_TYPE,
+    SK_PATH_DESIGN_DRAFT,
+    SK_PATH_DESIGN_LENGTH,
+    SK_PATH_DESIGN_BEAM,
+    SK_PATH_ATON_TYPE,
+    SK_PATH_VIRTUAL,
+    SK_PATH_OFF_POSITION,
+    SK_PATH_AIS_CLASS,
+    SK_PATH_AIS_FROM_BOW,
+    SK_PATH_AIS_FROM_CENTER,
+    SK_PATH_AIS_DAC,
+    SK_PATH_AIS_FUNCTIONAL_ID
+}_SignalKPath;
+
+typedef enum SignalKLeafType
+{
+    SK_LEAF_NULL = 0,
+    SK_LEAF_NUMBER,
+    SK_LEAF_STRING,
+    SK_LEAF_BOOL
+}_SignalKLeafType;
+
+class SignalKLeaf
+{
+public:
+    bool IsNumber() const { return m_type == SK_LEAF_NUMBER; }
+
+    double AsDouble() const;
+    int AsInt() const { return (int) AsDouble(); }
+    //  The text of the value, as wxJSONValue::AsString() would give for scalars
+    std::string AsString() const;
+
+    std::string         m_key;
+    SignalKLeafType     m_type;
+    double              m_number;
+    std::string         m_string;           // also holds the literal text of numbers
+};
+
+class SignalKValue
+{
+public:
+    SignalKValue() : m_count( 0 ) {}
+
+    //  A scalar value is a single leaf with an empty key
+    bool IsScalar() const { return ( m_count == 1 ) && m_leaves[0].m_key.empty(); }
+    bool IsNumber() const { return IsScalar() && m_leaves[0].IsNumber(); }
+    double AsDouble() const { return m_count ? m_leaves[0].AsDouble() : 0.; }
+    int AsInt() const { return m_count ? m_leaves[0].AsInt() : 0; }
+    std::string AsString() const { return m_count ? m_leaves[0].AsString() : std::string(); }
+
+    //  True if the value has the member, or any member below it
+    bool HasMember( const char *key ) const;
+    //  The leaf of a scalar member, or NULL
+    const SignalKLeaf *Find( const char *key ) const;
+
+    size_t GetCount() const { return m_count; }
+    const SignalKLeaf &GetLeaf( size_t i ) const { return m_leaves[i]; }
+
+    void Clear() { m_count = 0; }
+    SignalKLeaf &AddLeaf();
+
+private:
+    std::vector<SignalKLeaf> m_leaves;
+    size_t              m_count;
+};
+
+class SignalKDeltaItem
+{
+public:
+    SignalKPath         m_path_id;
+    std::string         m_path;
+    bool                m_bhas_path;
+    bool                m_bhas_value;
+    SignalKValue        m_value;
+};
+
+class SignalKDeltaUpdate
+{
+public:
+    std::string         m_timestamp;
+    size_t              m_first_item;
+    size_t              m_item_count;
+};
+
+class SignalKDelta
+{
+public:
+    SignalKDelta();
+
+    //  Parse one message. Returns false if the document is not well formed.
+    bool Parse( const std::string &msg );
+
+    bool HasSelf() const { return m_bhas_self; }
+    bool HasContext() const { return m_bhas_context; }
+    bool HasVersion() const { return m_bhas_version; }
+    const std::string &GetSelf() const { return m_self; }
+    const std::string &GetContext() const { return m_context; }
+    const std::string &GetVersion() const { return m_version; }
+
+    size_t GetUpdateCount() const { return m_updates.size(); }
+    const SignalKDeltaUpdate &GetUpdate( size_t i ) const { return m_updates[i]; }
+    const SignalKDeltaItem &GetItem( size_t i ) const { return m_items[i]; }
+
+    static SignalKPath InternPath( const std::string &path );
+
+private:
+    void Clear();
+
+    bool ParseRoot();
+    bool ParseUpdates();
+    bool ParseUpdate();
+    bool ParseItems();
+    bool ParseItem();
+    bool ParseValue( SignalKValue &value, std::string &key, int depth );
+    bool ParseScalar( SignalKLeaf &leaf );
+    bool ParseString( std::string &out );
+    bool ParseNumber( double &number, std::string &text );
+    bool SkipValue( int depth );
+
+    void SkipSpace();
+    bool Expect( char c );
+    int NextMember( bool &bfirst, char close, bool bkeyed );
+
+    const char          *m_p;
+    const char          *m_end;
+
+    bool                m_bhas_self;
+    bool                m_bhas_context;
+    bool                m_bhas_version;
+    std::string         m_self;
+    std::string         m_context;
+    std::string         m_version;
+    std::string         m_key;
+    std::string         m_value_key;
+
+    std::vector<SignalKDeltaUpdate> m_updates;
+    std::vector<SignalKDeltaItem>   m_items;        // reused, only the first m_nitems are valid
+    size_t              m_nitems;
+};
+
+#endif
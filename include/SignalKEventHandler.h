@@ -32,6 +32,8 @@ static const double ms_to_knot_factor = 1.9438444924406;
 
 #include <wx/jsonval.h>
 
+#include "SignalKDelta.h"
+
 class MyFrame;
 class OCPN_SignalKEvent;
 
@@ -44,17 +46,19 @@ private:
     MyFrame* m_frame;
     wxString m_self;
 
-    void handleUpdate(wxJSONValue &update) const;
+    SignalKDelta m_delta;
+
+    void handleUpdate(const SignalKDeltaUpdate &update) const;
 
-    void updateItem(wxJSONValue &item, wxString &sfixtime) const;
+    void updateItem(const SignalKDeltaItem &item, wxString &sfixtime) const;
 
-    void updateNavigationPosition(wxJSONValue &value, const wxString &sfixtime) const;
-    void updateNavigationSpeedOverGround(wxJSONValue &value, const wxString &sfixtime) const;
-    void updateNavigationCourseOverGround(wxJSONValue &value, const wxString &sfixtime) const;
-    void updateGnssSatellites(wxJSONValue &value, const wxString &sfixtime) const;
-    void updateHeadingTrue(wxJSONValue &value, const wxString &sfixtime) const;
-    void updateHeadingMagnetic(wxJSONValue &value, const wxString &sfixtime) const;
-    void updateMagneticVariance(wxJSONValue &value, const wxString &sfixtime) const;
+    void updateNavigationPosition(const SignalKValue &value, const wxString &sfixtime) const;
+    void updateNavigationSpeedOverGround(const SignalKValue &value, const wxString &sfixtime) const;
+    void updateNavigationCourseOverGround(const SignalKValue &value, const wxString &sfixtime) const;
+    void updateGnssSatellites(const SignalKValue &value, const wxString &sfixtime) const;
+    void updateHeadingTrue(const SignalKValue &value, const wxString &sfixtime) const;
+    void updateHeadingMagnetic(const SignalKValue &value, const wxString &sfixtime) const;
+    void updateMagneticVariance(const SignalKValue &value, const wxString &sfixtime) const;
 };
 
 
@@ -45,6 +45,9 @@ public:
     TC_Error_Code LoadHarmonicData(IDX_entry *pIDX);
 
 private:
+    bool ReadStationRecord(IDX_entry *pIDX);
+
+    wxString            m_data_file_path;
     ArrayOfStationData  m_msd_array;
 
     wxString            m_last_reference_not_found;
@@ -26,6 +26,8 @@
 #ifndef __TEXFONT_H__
 #define __TEXFONT_H__
 
+#include <vector>
+
 /* support ascii plus degree symbol for now pack font in a single texture 16x8 */
 #define DEGREE_GLYPH 127
 #define MIN_GLYPH 32
@@ -42,6 +44,34 @@ struct TexGlyphInfo {
     float advance;
 };
 
+struct TexQuadVertex {
+    float x, y;
+    float u, v;
+    unsigned char color[4];
+};
+
+//  A run of textured quads drawn from a single texture by one glDrawArrays.
+//  Each quad is the rectangle x1,y1 - x2,y2, rotated by the angle whose
+//  cosine and sine are c and s (counter clockwise), then moved to x, y.
+class TexQuadBatch {
+public:
+    TexQuadBatch() : m_texture( 0 ) {}
+
+    //  A texture change draws the quads queued so far
+    void SetTexture( unsigned int texture );
+    void AddQuad( float x, float y, float c, float s,
+                  float x1, float y1, float x2, float y2,
+                  float tx1, float ty1, float tx2, float ty2, const wxColour &color );
+    void Flush();
+    //  Drop the queued quads, when their texture is about to go
+    void Clear() { m_quads.clear(); }
+    bool IsEmpty() const { return m_quads.empty(); }
+
+private:
+    unsigned int m_texture;
+    std::vector<TexQuadVertex> m_quads;
+};
+
 class TexFont {
 public:
     TexFont();
@@ -56,6 +86,12 @@ public:
     bool IsBuilt(){ return m_built; }
     void SetColor(wxColor &color){ m_color = color;}
 
+    //  Batched rendering.  The glyph quads of many strings, each placed at x, y
+    //  and rotated by angle (radians, counter clockwise) on the CPU, are drawn
+    //  from the font texture in a single call by FlushBatch()
+    void AddStringToBatch( const wxString &string, float x, float y, float angle, const wxColour &color );
+    void FlushBatch();
+
 private:
     void GetTextExtent( const char *string, int *width, int *height);
     void RenderGlyph( int c );
@@ -74,6 +110,8 @@ private:
     float m_dx;
     float m_dy;
     wxColor m_color;
+
+    TexQuadBatch m_batch;
 };
 
 TexFont *GetTexFont(wxFont *key);
@@ -31,6 +31,7 @@
 
 #include "vector2D.h"
 
+#include <stdint.h>
 #include <vector>
 #include <list>
 #include <deque>
@@ -47,6 +48,10 @@ struct SubTrack
     double            m_scale;
 };
 
+//    TrackPoint::m_time values that are not a time
+#define TRACKPOINT_NO_TIME      0xFFFFFFFF
+#define TRACKPOINT_TIME_STRING  0xFFFFFFFE      // kept as text, see SetCreateTime()
+
 class TrackPoint
 {
 public:
@@ -55,16 +60,27 @@ public:
       TrackPoint( TrackPoint* orig );
       ~TrackPoint();
 
+      //  Track points come from a shared pool of fixed size blocks,
+      //  there can be millions of them.
+      static void *operator new( size_t size );
+      static void operator delete( void *p, size_t size );
+
       wxDateTime GetCreateTime(void);
       void SetCreateTime( wxDateTime dt );
       void Draw(ChartCanvas *cc, ocpnDC& dc );
-      const char *GetTimeString() { return m_timestring; }
+      bool HasTime() const { return m_time != TRACKPOINT_NO_TIME; }
+      wxString GetTimeString() const;
       
       double            m_lat, m_lon;
       int               m_GPXTrkSegNo;
 private:
       void SetCreateTime( wxString ts );
-      char             *m_timestring;
+      void ClearTimeString();
+
+      //  The GPX time "YYYY-MM-DDThh:mm:ssZ" as seconds since 1970-01-01,
+      //  counting the fields as given. Any other form of time string is
+      //  kept verbatim on the side, so that GPX round trips are lossless.
+      uint32_t          m_time;
 };
 
 //----------------------------------------------------------------------------
@@ -75,6 +91,8 @@ class Track
 {
 public:
     Track();
+    //  b_create_guid false leaves m_GUID empty, for tracks built off the main thread
+    Track( bool b_create_guid );
     virtual ~Track();
 
     void Draw( ChartCanvas *cc, ocpnDC& dc, ViewPort &VP, const LLBBox &box);
@@ -145,29 +163,40 @@ public:
     void Clone( Track *psourcetrack, int start_nPoint, int end_nPoint, const wxString & suffix);
 
 protected:
-    void Segments( ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists, const LLBBox &box, double scale);
+    void Segments( ChartCanvas *cc, const LLBBox &box, double scale);
     void DouglasPeuckerReducer( std::vector<TrackPoint*>& list,
                                 std::vector<bool> & keeplist,
                                 int from, int to, double delta );
     double GetXTE(TrackPoint *fm1, TrackPoint *fm2, TrackPoint *to);
     double GetXTE( double fm1Lat, double fm1Lon, double fm2Lat, double fm2Lon, double toLat, double toLon  );
+    void InvalidateLOD() { m_blod_valid = false; }
             
     std::vector<TrackPoint*>     TrackPoints;
     std::vector<std::vector <SubTrack> > SubTracks;
 
 private:
-    void GetPointLists(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists,
-                       ViewPort &VP, const LLBBox &box );
+    void GetPointLists(ChartCanvas *cc, ViewPort &VP, const LLBBox &box );
     void Finalize();
     double ComputeScale(int left, int right);
     void InsertSubTracks(LLBBox &box, int level, int pos);
 
-    void AddPointToList(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists, int n);
-    void AddPointToLists(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists, int &last, int n);
+    void AddPointToList(ChartCanvas *cc, int n);
+    void BreakStrip();
 
-    void Assemble( ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists, const LLBBox &box, double scale, int &last, int level, int pos);
+    void Assemble( std::vector<int> &indices, const LLBBox &box, double scale, int &last, int level, int pos);
     
     wxString    m_TrackNameString;
+
+    //  Track point indices assembled from the SubTracks for one view,
+    //  -1 marks a break between line strips
+    std::vector<int>        m_lod_indices;
+    LLBBox                  m_lod_box;
+    double                  m_lod_scale;
+    bool                    m_blod_valid;
+
+    //  Projected line strips, reused from frame to frame
+    std::vector<wxPoint>    m_draw_points;
+    std::vector<size_t>     m_draw_strips;      // first point of each strip
 };
 
 WX_DECLARE_LIST(Track, TrackList); // establish class Route as list member
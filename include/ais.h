@@ -41,6 +41,7 @@
 #include <wx/wxhtml.h>
 
 #include <vector>
+#include <stdint.h>
 
 #include "wx/sound.h"
 
@@ -152,8 +153,54 @@ class AISTargetTrackPoint
             time_t      m_time;
 };
 
+//    Compact storage for one packed track sample.
+//    Position is quantised to 1e-7 degree (about 1 cm),
+//    and time is kept as seconds relative to the owning track's base time.
+struct AISTargetTrackSample
+{
+      int32_t     lat;
+      int32_t     lon;
+      int32_t     dt;
+};
 
-WX_DECLARE_LIST(AISTargetTrackPoint, AISTargetTrackList);
+//    A ring buffer of AIS target track samples.
+//    The buffer grows on demand up to a maximum point count,
+//    after which the oldest sample is overwritten.
+//    Points are indexed oldest first.
+class AISTargetTrack
+{
+public:
+      AISTargetTrack();
+
+      size_t GetCount() const { return m_count; }
+      bool IsEmpty() const { return m_count == 0; }
+      void Clear();
+
+      void SetMaxCount( size_t max_count );
+      size_t GetMaxCount() const { return m_max_count; }
+
+      void Append( double lat, double lon, time_t time );
+      void PopBack();
+      void PopFront();
+      //    Remove all points older than the given time
+      void TrimBefore( time_t time );
+
+      AISTargetTrackPoint GetPoint( size_t index ) const;
+      AISTargetTrackPoint GetFirst() const { return GetPoint( 0 ); }
+      AISTargetTrackPoint GetLast() const { return GetPoint( m_count - 1 ); }
+      time_t GetTime( size_t index ) const { return m_base_time + Sample( index ).dt; }
+
+private:
+      const AISTargetTrackSample &Sample( size_t index ) const
+            { return m_samples[( m_head + index ) % m_samples.size()]; }
+      void Grow();
+
+      std::vector<AISTargetTrackSample> m_samples;
+      size_t      m_head;
+      size_t      m_count;
+      size_t      m_max_count;
+      time_t      m_base_time;
+};
 
 
 
@@ -581,6 +581,7 @@ class MyFrame: public wxFrame
 
     void ApplyGlobalColorSchemetoStatusBar(void);
     void PostProcessNMEA(bool pos_valid, bool cog_sog_valid, const wxString &sfixtime);
+    void PublishOwnShipTelemetry(void);
 
     bool ScrubGroupArray();
     wxString GetGroupName(int igroup);
@@ -626,6 +627,8 @@ class MyFrame: public wxFrame
     wxString            m_VDO_accumulator;
     
     time_t              m_fixtime;
+    int                 m_telemetry_fields;     // OWNSHIP_FIELD_BIT()s received since the last publish
+    int                 m_telemetry_source;
     wxMenu              *piano_ctx_menu;
     bool                b_autofind;
     
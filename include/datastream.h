@@ -194,6 +194,8 @@ public:
     bool GetChecksumCheck() const { return m_bchecksumCheck; }
     ConnectionType GetConnectionType() const { return m_connection_type; }
     const ConnectionParams* GetConnectionParams() const { return &m_params; }
+    //  Own ship telemetry source id of this stream, looked up on first use
+    int GetTelemetrySource();
     int                 m_Thread_run_flag;
 
 protected:
@@ -244,6 +246,7 @@ private:
     GarminProtocolHandler *m_GarminHandler;
     wxDateTime          m_connect_time;
     ConnectionParams    m_params;
+    int                 m_telemetry_source;
 
 };
 
@@ -39,6 +39,9 @@
 #include <math.h>
 #include <assert.h>
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <wx/geometry.h>
 
@@ -95,10 +98,36 @@ typedef std::vector<contour> contour_list;
 //==========================================================================
 
 
+//    Read only view of a poly-*.dat file.  The file is memory mapped where the
+//    platform allows it, otherwise read into memory in one piece.
+class GshhsMappedFile {
+public:
+    GshhsMappedFile();
+    ~GshhsMappedFile();
+
+    bool Open( const wxString &fname );
+    void Close();
+    bool IsOk() const { return m_data != NULL; }
+    const unsigned char *GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    GshhsMappedFile( const GshhsMappedFile & );
+    GshhsMappedFile &operator=( const GshhsMappedFile & );
+
+    const unsigned char *m_data;
+    size_t m_size;
+    bool m_mapped;
+#ifdef __WXMSW__
+    void *m_hfile;
+    void *m_hmap;
+#endif
+};
+
 class GshhsPolyCell {
 public:
 
-    GshhsPolyCell( FILE *fpoly, int x0, int y0, PolygonFileHeader *header );
+    GshhsPolyCell( const GshhsMappedFile *file, int x0, int y0, const PolygonFileHeader *header );
     ~GshhsPolyCell();
 
     void ClearPolyV();
@@ -110,18 +139,23 @@ public:
     std::vector<wxLineF> * getCoasts() { return &coasts; }
     contour_list &getPoly1() { return poly1; }
 
+    //  Approximate heap use of the decoded contours and the GL vertex cache
+    size_t GetMemorySize() const;
+
     /* we remap the segments into a high resolution map to
        greatly reduce intersection testing time */
     std::vector<wxLineF> *high_res_map[GSSH_SUBM*GSSH_SUBM];
 
+    unsigned int m_last_used;   // reader frame stamp, for LRU eviction
+
 private:
     int nbpoints;
     int x0cell, y0cell;
 
-    FILE *fpoly;
+    const GshhsMappedFile *m_file;
 
     std::vector<wxLineF> coasts;
-    PolygonFileHeader *header;
+    const PolygonFileHeader *header;
     contour_list poly1, poly2, poly3, poly4, poly5;
 
     // used for opengl vertex cache
@@ -135,10 +169,20 @@ private:
 #endif
     void DrawPolygonContour( ocpnDC &pnt, contour_list * poly, double dx, ViewPort &vp );
 
-    void ReadPoly( contour_list &poly );
+    bool ReadPoly( const unsigned char *&p, const unsigned char *end, contour_list &poly );
     void ReadPolygonFile( );
 };
 
+//    One quality level: its mapped file and the cells decoded from it so far
+struct GshhsPolyLevel {
+    GshhsPolyLevel() : header(), nbytes( 0 ) {}
+
+    GshhsMappedFile file;
+    PolygonFileHeader header;
+    std::vector<GshhsPolyCell *> cells;     // 360 x 180, NULL until loaded
+    size_t nbytes;                          // sum of cell memory sizes
+};
+
 class GshhsPolyReader {
 public:
     GshhsPolyReader( int quality );
@@ -150,20 +194,39 @@ public:
     void drawGshhsPolyMapSeaBorders( ocpnDC &pnt, ViewPort &vp );
 
     void InitializeLoadQuality( int quality ); // 5 levels: 0=low ... 4=full
+    void PrefetchQuality( int quality, const LLBBox &box );
     bool crossing1( wxLineF trajectWorld );
     int currentQuality;
     int ReadPolyVersion();
     int GetPolyVersion() { return polyHeader.version; }
 
 private:
-    FILE *fpoly;
-    GshhsPolyCell * allCells[360][180];
+    bool OpenLevel( int quality );
+    GshhsPolyCell *GetCell( GshhsPolyLevel &level, int clonx, int clat );
+    void TrimCells( GshhsPolyLevel &level );
+    void ClearLevel( GshhsPolyLevel &level );
+
+    void AdoptPrefetched();
+    void StopPrefetch();
+    void PrefetchWorker();
+
+    GshhsPolyLevel m_levels[5];
+    GshhsPolyLevel *m_level;                // level of currentQuality, or NULL
+    unsigned int m_frame;
 
     PolygonFileHeader polyHeader;
-    void readPolygonFileHeader( FILE *polyfile, PolygonFileHeader *header );
 
     wxMutex mutex1, mutex2;
 
+    //  Background decoding of the cells of another quality level
+    std::thread m_prefetch_thread;
+    std::mutex m_prefetch_mutex;
+    std::condition_variable m_prefetch_cond;
+    bool m_prefetch_stop;
+    int m_prefetch_quality;
+    std::vector<int> m_prefetch_todo;       // clonx * 180 + clat + 90
+    std::vector<std::pair<int, GshhsPolyCell *> > m_prefetch_done;  // keyed with quality
+
     ViewPort last_rendered_vp;
 };
 
@@ -261,6 +324,7 @@ private:
 
     int maxQualityAvailable;
     int minQualityAvailable;
+    double m_last_scale;
 
     std::string fpath;     // directory containing gshhs files
 
@@ -310,5 +374,6 @@ private:
 void gshhsCrossesLandInit();
 void gshhsCrossesLandReset();
 bool gshhsCrossesLand(double lat1, double lon1, double lat2, double lon2);
+int gshhsCrossesLandBatch(int count, const double *legs, bool *crosses);
 
 #endif
@@ -37,6 +37,7 @@
 
 class RoutePoint;
 class Route;
+class NMEACaptureWriter;
 
 WX_DEFINE_ARRAY(DataStream *, wxArrayOfDataStreams);
 
@@ -59,6 +60,12 @@ class Multiplexer : public wxEvtHandler
         void SaveStreamProperties( DataStream *stream );
         bool CreateAndRestoreSavedStreamProperties();
 
+        //  Record all input to a capture file, and replay a capture as an input stream
+        bool StartCapture( const wxString &path );
+        void StopCapture();
+        bool IsCapturing() const { return m_capture != NULL; }
+        DataStream *StartReplay( const wxString &path, double speed );
+
         void SendNMEAMessage(const wxString &msg);
         void SetAISHandler(wxEvtHandler *handler);
         void SetGPSHandler(wxEvtHandler *handler);
@@ -68,6 +75,8 @@ class Multiplexer : public wxEvtHandler
 
         void OnEvtStream(OCPN_DataStreamEvent& event);
         void OnEvtSignalK(OCPN_SignalKEvent& event);
+
+        static bool IsAISSentence( const wxString &message );
         
         void LogOutputMessage(const wxString &msg, wxString stream_name, bool b_filter);
         void LogOutputMessageColor(const wxString &msg, const wxString & stream_name, const wxString & color);
@@ -79,6 +88,8 @@ class Multiplexer : public wxEvtHandler
         wxEvtHandler        *m_aisconsumer;
         wxEvtHandler        *m_gpsconsumer;
 
+        NMEACaptureWriter   *m_capture;
+
         //      A set of temporarily saved parameters for a DataStream
         const ConnectionParams* params_save;
 
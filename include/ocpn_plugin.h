@@ -66,7 +66,7 @@ class wxGLContext;
 //    PlugIns conforming to API Version less then the most modern will also
 //    be correctly supported.
 #define API_VERSION_MAJOR           1
-#define API_VERSION_MINOR           17
+#define API_VERSION_MINOR           18
 
 //    Fwd Definitions
 class       wxFileConfig;
@@ -1393,4 +1393,10 @@ extern DECL_EXP int GetLatLonFormat(void);
 // API 1.17
 extern "C"  DECL_EXP void ZeroXTE();
 
+// API 1.18
+//
+/* legs holds count tuples of lat1, lon1, lat2, lon2.  crosses[i] is set
+   for each leg, the number of legs crossing land is returned. */
+extern "C" DECL_EXP int PlugIn_GSHHS_CrossesLandBatch(int count, const double *legs, bool *crosses);
+
 #endif //_PLUGIN_H_
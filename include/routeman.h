@@ -33,6 +33,8 @@
 #include "Select.h"
 #include "nmea0183.h"
 
+#include <unordered_map>
+
 //----------------------------------------------------------------------------
 //   constants
 //----------------------------------------------------------------------------
@@ -50,6 +52,12 @@ class Route;
 class RoutePoint;
 class RoutePointList;
 
+//    GUID indexes for the Route, Track and RoutePoint lists
+WX_DECLARE_STRING_HASH_MAP( Route*, RouteGUIDHash );
+WX_DECLARE_STRING_HASH_MAP( Track*, TrackGUIDHash );
+WX_DECLARE_STRING_HASH_MAP( RoutePoint*, RoutePointGUIDHash );
+WX_DECLARE_STRING_HASH_MAP( int, RoutePointGUIDCount );
+
 //    List definitions for Waypoint Manager Icons
 
 class markicon_bitmap_list_type;
@@ -79,6 +87,7 @@ public:
 
       Route *FindRouteByGUID(const wxString &guid);
       Track *FindTrackByGUID(const wxString &guid);
+      void InvalidateGUIDIndex(void);
       Route *FindRouteContainingWaypoint(RoutePoint *pWP);
       wxArrayPtrVoid *GetRouteArrayContaining(RoutePoint *pWP);
       bool DoesRouteContainSharedPoints( Route *pRoute );
@@ -123,6 +132,8 @@ public:
 
 private:
       void DoAdvance(void);
+      void IndexNewRoutes(void);
+      void IndexNewTracks(void);
     
       MyApp       *m_pparent_app;
       Route       *pActiveRoute;
@@ -156,6 +167,14 @@ private:
       
       double      m_arrival_min;
       int         m_arrival_test;
+
+      //    Routes and tracks are only ever appended to their lists, so the
+      //    index covers the first m_nindexed_* entries and catches up lazily.
+      //    Removing from either list invalidates the index.
+      RouteGUIDHash m_route_guid_index;
+      size_t      m_nindexed_routes;
+      TrackGUIDHash m_track_guid_index;
+      size_t      m_nindexed_tracks;
       
 
 };
@@ -184,6 +203,9 @@ public:
       bool SharedWptsExist();
       void DeleteAllWaypoints(bool b_delete_used);
       RoutePoint *FindRoutePointByGUID(const wxString &guid);
+      RoutePoint *FindRoutePointByNamePosition(const wxString &name, double lat, double lon);
+      void UpdateRoutePointIndex(RoutePoint *prp);
+      void SyncRoutePointIndex(void);
       void DestroyWaypoint(RoutePoint *pRp, bool b_update_changeset = true);
       void ClearRoutePointFonts(void);
       void ProcessIcons( ocpnStyle::Style* style );
@@ -210,7 +232,19 @@ private:
       wxImage CreateDimImage( wxImage &image, double factor );
       
       void ProcessUserIcons( ocpnStyle::Style* style );
+      void IndexRoutePoint(RoutePoint *prp);
+      void UnindexRoutePoint(RoutePoint *prp);
       RoutePointList    *m_pWayPointList;
+
+      //    Hash indexes over m_pWayPointList, by GUID and by (name, lat, lon)
+      //    quantised to a grid cell. m_point_key remembers the key each point
+      //    was indexed under, so it can be found again after it moves.
+      //    m_guid_count counts the indexed points sharing each GUID, so a
+      //    duplicate can take over the GUID entry when the indexed one goes.
+      RoutePointGUIDHash  m_guid_index;
+      RoutePointGUIDCount m_guid_count;
+      std::unordered_multimap<size_t, RoutePoint*> m_position_index;
+      std::unordered_map<RoutePoint*, size_t> m_point_key;
       wxBitmap *CreateDimBitmap(wxBitmap *pBitmap, double factor);
 
       wxImageList       *pmarkicon_image_list;        // Current wxImageList, updated on colorscheme change
@@ -27,6 +27,7 @@
 #define _S52PLIB_H_
 
 #include <vector>
+#include <unordered_map>
 
 #include "s52s57.h"                 //types
 
@@ -35,6 +36,7 @@ class wxGLContext;
 #include "LLRegion.h"
 #include "ocpn_types.h"
 #include "DepthFont.h"
+#include "TexFont.h"
 
 #include <wx/dcgraph.h>         // supplemental, for Mac
 
@@ -49,6 +51,31 @@ WX_DEFINE_SORTED_ARRAY( LUPrec *, wxArrayOfLUPrec );
 
 WX_DECLARE_LIST( S52_TextC, TextObjList );
 
+//    Screen space index over the declutter text list.
+//    Each listed text is filed by its rText in a hashed grid of square pixel
+//    cells; very large rectangles are kept apart in a short list checked by
+//    every query.  After changing rText of a listed text, call Update().
+
+class S52TextGrid
+{
+public:
+    void Clear();
+    bool Contains( S52_TextC *ptext ) const { return m_rects.find( ptext ) != m_rects.end(); }
+    void Update( S52_TextC *ptext );
+    void Remove( S52_TextC *ptext );
+
+    //  True if test_rect overlaps the rText of any filed text other than ptext
+    bool Intersects( const wxRect &test_rect, S52_TextC *ptext ) const;
+
+private:
+    bool GetCells( const wxRect &rect, int &ix0, int &iy0, int &ix1, int &iy1 ) const;
+    void File( S52_TextC *ptext, const wxRect &rect, bool badd );
+
+    std::unordered_map<uint32_t, std::vector<S52_TextC *> > m_cells;
+    std::vector<S52_TextC *> m_large;
+    std::unordered_map<S52_TextC *, wxRect> m_rects;    // the rect each text is filed by
+};
+
 struct CARC_Buffer {
     unsigned char color[3][4];
     float line_width[3];
@@ -59,6 +86,7 @@ struct CARC_Buffer {
 };
 WX_DECLARE_STRING_HASH_MAP( CARC_Buffer, CARC_Hash );
 WX_DECLARE_STRING_HASH_MAP( int, CARC_DL_Hash );
+WX_DECLARE_STRING_HASH_MAP( LUPrec*, CSLUP_Hash );
 
 class ViewPort;
 class PixelCache;
@@ -82,7 +110,34 @@ typedef struct _LUPHashIndex {
     int count;
 } LUPHashIndex;
 
-WX_DECLARE_STRING_HASH_MAP( LUPHashIndex*, LUPArrayIndexHash );
+//  A LUP attribute condition, parsed once from its ATTArray string
+typedef enum _LUPAttMatch_t{
+    LUPATT_SKIP,                        // malformed, never matches
+    LUPATT_ANY,                         // " ", any value of the attribute matches
+    LUPATT_UNDEFINED,                   // "?", never counted as a match
+    LUPATT_VALUE                        // a value to compare with the object
+}LUPAttMatch_t;
+
+typedef struct _LUPAttMatch {
+    S57AttrCode         code;
+    LUPAttMatch_t       type;
+    int                 ival;
+    float               fval;
+    const char          *sval;          // points into the LUP ATTArray string
+} LUPAttMatch;
+
+//  Perfect hash slot, keyed by the packed object class acronym
+typedef struct _LUPClassSlot {
+    S57AttrCode         code;           // 0 for an empty slot
+    LUPHashIndex        index;
+} LUPClassSlot;
+
+typedef struct _LUPClassBucket {
+    uint64_t            mul;            // multiplier placing the bucket keys without collision
+    int                 shift;
+    int                 first_slot;
+    int                 n_slots;
+} LUPClassBucket;
 
 class LUPArrayContainer {
 public:
@@ -91,10 +146,21 @@ public:
     
     wxArrayOfLUPrec     *GetLUPArray(void){ return LUPArray; }
     LUPHashIndex        *GetArrayIndexHelper( const char *objectName );
+
+    //  Compile the class index and attribute conditions, once the LUP array is complete
+    void                BuildIndex( void );
+    LUPAttMatch         *GetAttMatches( int index ){ return &m_attMatches[m_attMatchStart[index]]; }
     
 private:
     wxArrayOfLUPrec             *LUPArray;          // Sorted Array
-    LUPArrayIndexHash           IndexHash;
+
+    std::vector<LUPClassBucket> m_classBuckets;
+    std::vector<LUPClassSlot>   m_classSlots;
+    int                         m_bucketShift;
+    LUPHashIndex                m_noClass;
+
+    std::vector<LUPAttMatch>    m_attMatches;       // per LUP, in ATTArray order
+    std::vector<int>            m_attMatchStart;
 };
 
     
@@ -126,6 +192,10 @@ public:
     void GenerateStateHash();
     long GetStateHash() { return m_state_hash;  }
 
+    //  State hash extended by the filter settings that change without a new state hash.
+    //  While unchanged, ObjectRenderCheckState() gives the same answer for a given scale
+    long GetRenderStateHash( void );
+
     void SetPLIBColorScheme( wxString scheme );
     void SetPLIBColorScheme( ColorScheme cs );
     wxString GetPLIBColorScheme( void ) { return m_ColorScheme; }
@@ -144,6 +214,10 @@ public:
     bool ObjectRenderCheckCat( ObjRazRules *rzRules, ViewPort *vp );
     bool ObjectRenderCheckCS( ObjRazRules *rzRules, ViewPort *vp );
 
+    //  ObjectRenderCheckRules() without the position test, and without running CS procedures.
+    //  False only if the object is hidden at vp->chart_scale and at every smaller scale
+    bool ObjectRenderCheckState( ObjRazRules *rzRules, ViewPort *vp );
+
     static void DestroyLUP( LUPrec *pLUP );
     static void ClearRulesCache( Rule *pR );
     DisCat findLUPDisCat(const char *objectName, LUPname TNAM);
@@ -158,6 +232,16 @@ public:
     void PrepareForRender( void );
     void AdjustTextList( int dx, int dy, int screenw, int screenh );
     void ClearTextList( void );
+
+    //  Collect the glyph texture text drawn until FlushTextBatch() into one
+    //  vertex array per font (OpenGL only)
+    void BeginTextBatch( void );
+    void FlushTextBatch( void );
+
+    //  Collect the atlas textured point symbols and soundings drawn until
+    //  FlushSymbolBatch() into one vertex array per atlas run (OpenGL only)
+    void BeginSymbolBatch( void );
+    void FlushSymbolBatch( void );
     int SetLineFeaturePriority( ObjRazRules *rzRules, int npriority );
     void FlushSymbolCaches();
 
@@ -310,6 +394,11 @@ private:
     
     int RenderCARC_VBO( ObjRazRules *rzRules, Rules *rules, ViewPort *vp );
     int RenderCARC_GLSL( ObjRazRules *rzRules, Rules *rules, ViewPort *vp );
+
+    //  Queue a w x h quad of texture coordinates tx1..ty2, with its pivot at r
+    void AddSymbolToBatch( unsigned int texture, float tx1, float ty1, float tx2, float ty2,
+                           const wxPoint &r, float pivot_x, float pivot_y, float w, float h,
+                           float rotation, const wxColour &color );
     
     void UpdateOBJLArray( S57Obj *obj );
 
@@ -358,7 +447,7 @@ private:
     int dda_trap( wxPoint *segs, int lseg, int rseg, int ytop, int ybot,
         S52color *c, render_canvas_parms *pb_spec, render_canvas_parms *pPatt_spec );
 
-    LUPrec *FindBestLUP( wxArrayOfLUPrec *LUPArray, unsigned int startIndex, unsigned int count,
+    LUPrec *FindBestLUP( LUPArrayContainer *plac, unsigned int startIndex, unsigned int count,
                               S57Obj *pObj, bool bStrict );
     
     void SetGLClipRect(const ViewPort &vp, const wxRect &rect);
@@ -371,6 +460,7 @@ private:
     
     Rules *StringToRules( const wxString& str_in );
     void GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules );
+    unsigned int GetCSInputHash( S57Obj *obj, unsigned int mariner_reads );
 
     void DestroyPattRules( RuleHash *rh );
     void DestroyRules( RuleHash *rh );
@@ -409,6 +499,11 @@ private:
     int m_colortable_index_save;
 
     TextObjList m_textObjList;
+    S52TextGrid m_textGrid;
+    bool m_bTextBatch;
+
+    bool m_bSymbolBatch;
+    TexQuadBatch m_symbolBatch;
 
     wxString m_ColorScheme;
 
@@ -423,6 +518,8 @@ private:
     int m_txf_avg_char_height;
     CARC_Hash m_CARC_hashmap;
     CARC_DL_Hash m_CARC_DL_hashmap;
+    CSLUP_Hash m_CSLUPhash;             // condSymbolLUPArray, keyed by OBCL, DISC and CS string
+    unsigned int m_CSgeneration;        // bumped whenever the dynamic CS LUPs are destroyed
     RenderFromHPGL* HPGL;
 
     TexFont *m_txf;
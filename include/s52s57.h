@@ -33,6 +33,8 @@
 #include "ocpn_types.h"
 
 #include <vector>
+#include <new>
+#include <stdint.h>
 
 #define CURRENT_SENC_FORMAT_VERSION  201
 
@@ -265,6 +267,17 @@ typedef struct _S57attVal {
 
 WX_DEFINE_ARRAY( S57attVal *, wxArrayOfS57attVal );
 
+//  Attribute acronyms packed into an integer, so lookups compare one word instead of a string
+typedef uint64_t S57AttrCode;
+
+inline S57AttrCode S57AttrCodeFromAcronym( const char *acronym )
+{
+    S57AttrCode code = 0;
+    for( int i = 0; i < 6 && acronym[i]; i++ )
+        code |= (S57AttrCode) (unsigned char) acronym[i] << ( 8 * i );
+    return code;
+}
+
 typedef struct _OBJLElement {
     char OBJLName[OBJL_NAME_LEN];
     int nViz;
@@ -330,6 +343,31 @@ typedef struct _MultipointGeometryDescriptor{
 }MultipointGeometryDescriptor;
 
 
+//----------------------------------------------------------------------------------
+//      S57Arena
+//      Bump allocator owning the per-chart object records built at SENC load.
+//      Individual allocations are never freed, Release() drops all the chunks at once.
+//----------------------------------------------------------------------------------
+class S57Arena
+{
+public:
+      S57Arena();
+      ~S57Arena();
+
+      void *Alloc( size_t size );
+      void Release();
+      size_t GetChunkCount(){ return m_chunks.size(); }
+
+private:
+      S57Arena( const S57Arena & );
+      S57Arena &operator=( const S57Arena & );
+
+      std::vector<char *>     m_chunks;
+      char                    *m_pfree;               // next free byte in the current chunk
+      size_t                  m_nfree;                // bytes left in the current chunk
+};
+
+
 class S57Obj
 {
 public:
@@ -342,6 +380,12 @@ public:
       
       wxString GetAttrValueAsString ( const char *attr );
       int GetAttributeIndex( const char *AttrSeek );
+      int GetAttributeIndex( S57AttrCode code );
+
+      //  Typed attribute values, without conversion or allocation
+      bool GetAttrInt( const char *acronym, int &val );
+      bool GetAttrDouble( const char *acronym, double &val );
+      const char *GetAttrString( const char *acronym );
       
       bool AddIntegerAttribute( const char *acronym, int val );
       bool AddIntegerListAttribute( const char *acronym, int *pval, int nValue );
@@ -354,7 +398,12 @@ public:
       bool SetAreaGeometry( PolyTessGeo *ppg, double ref_lat, double ref_lon);
       bool SetMultipointGeometry( MultipointGeometryDescriptor *pGeo, double ref_lat, double ref_lon);
       
-      
+      //  Create an object in a chart arena, or on the heap if arena is NULL,
+      //  and destroy it as appropriate
+      static S57Obj *New( const char *featureName, S57Arena *arena );
+      static void Destroy( S57Obj *obj );
+
+      void AddAttributeRecord( const char *acronym, S57attVal *pattVal );
           
       // Private Methods
 private:
@@ -366,6 +415,7 @@ public:
       GeoPrim_t               Primitive_type;
 
       char                    *att_array;
+      S57AttrCode             *att_codes;             // att_array acronyms as integer codes, may be NULL
       wxArrayOfS57attVal      *attVal;
       int                     n_attr;
 
@@ -391,6 +441,15 @@ public:
       Rules                   *CSrules;               // per object conditional symbology
       int                     bCS_Added;
 
+                                                      // Memo of the last CS evaluation, reused while
+                                                      // the inputs it read are unchanged
+      LUPrec                  *CSLUP;                 // the resulting dynamic LUP
+      Rules                   *CSsource;              // the CS rule evaluated
+      unsigned int            CSgeneration;           // PLIB CS LUP table generation
+      unsigned int            CSMarinerReads;         // mariner parameters read, as S52_getMarinerParamReads()
+      unsigned int            CSInputHash;            // hash of those parameters and the other CS inputs
+      DisCat                  CSDisplayCat;           // display category after the evaluation
+
       S52_TextC               *FText;
       int                     bFText_Added;
       wxRect                  rText;
@@ -427,8 +486,28 @@ public:
       int auxParm3;
       
       bool                    bBBObj_valid;
+
+      S57Arena                *m_arena;               // owning chart arena, NULL if heap allocated
 };
 
+inline S57Obj *S57Obj::New( const char *featureName, S57Arena *arena )
+{
+    if( !arena )
+        return new S57Obj( featureName );
+
+    S57Obj *obj = new( arena->Alloc( sizeof(S57Obj) ) ) S57Obj( featureName );
+    obj->m_arena = arena;
+    return obj;
+}
+
+inline void S57Obj::Destroy( S57Obj *obj )
+{
+    if( obj && obj->m_arena )
+        obj->~S57Obj();                               // storage is released with the arena
+    else
+        delete obj;
+}
+
 typedef std::vector<S57Obj *> S57ObjVector;
 
 typedef struct _sm_parms{
@@ -540,6 +619,14 @@ public:
     line_segment_element *next;
 };
 
+//  Allocate a line segment element from the arena of its owning object, if any
+inline line_segment_element *NewLineSegmentElement( S57Obj *obj )
+{
+    if( obj->m_arena )
+        return new( obj->m_arena->Alloc( sizeof(line_segment_element) ) ) line_segment_element;
+    return new line_segment_element;
+}
+
 #if 0 //TODO
 class line_segment_element_legacy
 {
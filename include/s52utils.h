@@ -67,4 +67,9 @@ typedef enum _S52_MAR_param_t {
 
 extern double S52_getMarinerParam(S52_MAR_param_t param);
 extern int    S52_setMarinerParam(S52_MAR_param_t param, double val);
+
+// parameters read by S52_getMarinerParam() since the last clear, one bit per S52_MAR_param_t
+// (used by the PLIB to track what conditional symbology depends on)
+extern unsigned int S52_getMarinerParamReads(void);
+extern void         S52_clearMarinerParamReads(void);
 #endif
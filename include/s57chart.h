@@ -50,6 +50,7 @@
 #include "viewport.h"
 #include "SencManager.h"
 #include <memory>
+#include <vector>
 
 class ChartCanvas;
 // ----------------------------------------------------------------------------
@@ -105,6 +106,32 @@ WX_DECLARE_LIST(S57Obj, ListOfS57Obj);
 
 WX_DECLARE_LIST(ObjRazRules, ListOfObjRazRules);
 
+//----------------------------------------------------------------------------
+// One razRules list, culled by display state, with the bounding box of each
+// object packed alongside so the per-frame viewport test does not touch the objects.
+// The boxes mirror S57Obj::BBObj; call UpdateBox() after anything may have changed it.
+//----------------------------------------------------------------------------
+class S57RenderList
+{
+public:
+      void Clear();
+      void Add( ObjRazRules *rzRules );
+      size_t GetCount() const { return m_objs.size(); }
+      ObjRazRules *Item( size_t i ) const { return m_objs[i]; }
+
+      void UpdateBox( size_t i );
+      void UpdateBoxes();
+
+      //  Mark the objects whose box meets vpBox, exactly as s52plib::ObjectRenderCheckPos()
+      void Cull( const LLBBox &vpBox );
+      bool IsVisible( size_t i ) const { return m_visible[i] != 0; }
+
+private:
+      std::vector<ObjRazRules *> m_objs;
+      std::vector<double> m_minlat, m_maxlat, m_minlon, m_maxlon;
+      std::vector<unsigned char> m_visible;
+};
+
 //----------------------------------------------------------------------------
 // s57 Chart object class
 //----------------------------------------------------------------------------
@@ -246,6 +273,9 @@ protected:
       void AssembleLineGeometry( void );
 
       ObjRazRules *razRules[PRIO_NUM][LUPNAME_NUM];
+
+      //  Owns the S57Objs, attributes and top level razRules nodes loaded from the SENC
+      S57Arena    m_arena;
     
 private:
       int GetLineFeaturePointArray(S57Obj *obj, void **ret_array);
@@ -287,6 +317,7 @@ private:
                                   const OCPNRegion &RectRegion, const LLRegion &Region, bool b_overlay);
 
       void BuildLineVBO( void );
+      void UpdateRenderList( const ViewPort &VPoint );
       
       void ChangeThumbColor(ColorScheme cs);
       void LoadThumb();
@@ -334,6 +365,13 @@ private:
       wxString    m_lastColorScheme;
       wxRect      m_last_vprect;
       long        m_plib_state_hash;
+
+      //  razRules objects that the display state does not hide within the current scale band,
+      //  walked by the OpenGL renderers in razRules order
+      S57RenderList m_renderList[PRIO_NUM][LUPNAME_NUM];
+      bool        m_bRenderListValid;
+      long        m_render_list_hash;
+      int         m_render_list_band;
       bool        m_btex_mem;
       char        m_usage_char;
       
@@ -29,12 +29,48 @@
 
 #include <wx/arrstr.h>
 #include <map>
+#include <vector>
 
 #include "Station_Data.h"
 #include "IDX_entry.h"
 #include "TC_Error_Code.h"
 #include "TCDataSource.h"
 
+class LLBBox;
+
+//    Tide and current events
+typedef enum {
+    TC_EVENT_LOW_TIDE = 0,
+    TC_EVENT_HIGH_TIDE,
+    TC_EVENT_SLACK,
+    TC_EVENT_MAX_FLOOD,
+    TC_EVENT_MAX_EBB
+} TC_Event_Type;
+
+#define TC_EVENT_BIT(type)      ( 1 << (type) )
+#define TC_EVENT_HIGHS          ( TC_EVENT_BIT(TC_EVENT_HIGH_TIDE) | TC_EVENT_BIT(TC_EVENT_MAX_FLOOD) )
+#define TC_EVENT_LOWS           ( TC_EVENT_BIT(TC_EVENT_LOW_TIDE) | TC_EVENT_BIT(TC_EVENT_MAX_EBB) )
+
+class TC_Event
+{
+public:
+    time_t      t;
+    float       value;
+    int         type;                   // TC_Event_Type
+};
+
+//    The events of one station over a span of whole UTC days
+class TC_Event_Timeline
+{
+public:
+    TC_Event_Timeline() : m_start( 0 ), m_end( 0 ), m_last_use( 0 ) {}
+
+    time_t                  m_start;
+    time_t                  m_end;
+    std::vector<TC_Event>   m_events;   // sorted by time
+    unsigned long           m_last_use; // TCMgr::m_event_clock at the last lookup
+};
+
 // ----------------------------------------------------------------------------
 // external C linkages
 // ----------------------------------------------------------------------------
@@ -101,12 +137,21 @@ public:
     }
 
     bool GetTideOrCurrent(time_t t, int idx, float &value, float& dir);
+    bool GetTideOrCurrentSeries(time_t t0, int step, int count, int idx,
+                                std::vector<float> &values, std::vector<float> &dirs);
     bool GetTideOrCurrent15(time_t t, int idx, float &tcvalue, float& dir, bool &bnew_val);
     bool GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now, float &tcvalue_prev, bool &w_t);
     void GetHightOrLowTide(time_t t, int sch_step_1, int sch_step_2, float tide_val ,bool w_t , int idx, float &tcvalue, time_t &tctime);
 
     int GetStationTimeOffset(IDX_entry *pIDX);
     int GetNextBigEvent(time_t *tm, int idx);
+
+    //  Events with t0 <= time < t1.  The events are computed a day at a time
+    //  and kept per station, so repeated queries are a binary search.
+    bool GetTideEvents(int idx, time_t t0, time_t t1, std::vector<TC_Event> &events);
+    //  The first event at or after t, or the last one before t, whose
+    //  type is in type_mask (TC_EVENT_BIT of each wanted type)
+    bool GetNextTideEvent(int idx, time_t t, bool bforward, int type_mask, TC_Event &event);
     double GetStationLat(IDX_entry *pIDX);
     double GetStationLon(IDX_entry *pIDX);
     
@@ -122,9 +167,19 @@ public:
     int GetStationIDXbyName(const wxString & prefix, double xlat, double xlon) const;
     int GetStationIDXbyNameType(const wxString & prefix, double xlat, double xlon, char type) const;
 
+    //  Indices of the stations within marge degrees of a box, in index order.
+    //  Stations just outside may be included, callers still test each position.
+    void GetStationsInBBox(const LLBBox &box, double marge, std::vector<int> &stations) const;
+    //  Nearest station of one of the given types ("TCtc"), or 0 if none
+    int GetNearestStationIDX(double xlat, double xlon, const char *types) const;
+
 private:
     void PurgeData();
 
+    void BuildStationIndex(void);
+    TC_Event_Timeline *GetEventTimeline(int idx, time_t t0, time_t t1);
+    int FindStationByName(const wxString & prefix, double xlat, double xlon, const char *types) const;
+
     void LoadMRU(void);
     void SaveMRU(void);
     void AddMRU(Station_Data *psd);
@@ -138,6 +193,16 @@ private:
 
     ArrayOfIDXEntry     m_Combined_IDX_array;
 
+    //  Station index, rebuilt by LoadDataSources()
+    //  Stations are bucketed in one degree cells, m_cell_start[cell] is the
+    //  offset of the cell's first station in m_cell_stations
+    std::vector<int>    m_cell_start;
+    std::vector<int>    m_cell_stations;
+    std::vector<int>    m_name_index;           // station indices sorted by name
+
+    std::map<int, TC_Event_Timeline> m_event_cache;     // by station index
+    unsigned long       m_event_clock;          // counts event cache lookups, for LRU eviction
+
 };
 
 /* $Id: tcd.h.in 3744 2010-08-17 22:34:46Z flaterco $ */
@@ -163,19 +163,17 @@ void AISTargetQueryDialog::OnIdTrkCreateClick( wxCommandEvent& event )
                 Track *t = new Track();
 
                 t->SetName( wxString::Format( _T("AIS %s (%u) %s %s"), td->GetFullName().c_str(), td->MMSI, wxDateTime::Now().FormatISODate().c_str(), wxDateTime::Now().FormatISOTime().c_str() ) );
-                wxAISTargetTrackListNode *node = td->m_ptrack->GetFirst();
-                while( node )
+                for( size_t i = 0; i < td->m_track.GetCount(); i++ )
                 {
-                    AISTargetTrackPoint *ptrack_point = node->GetData();
-                    vector2D point( ptrack_point->m_lon, ptrack_point->m_lat );
-                    tp1 = t->AddNewPoint( point, wxDateTime(ptrack_point->m_time).ToUTC() );
+                    AISTargetTrackPoint track_point = td->m_track.GetPoint( i );
+                    vector2D point( track_point.m_lon, track_point.m_lat );
+                    tp1 = t->AddNewPoint( point, wxDateTime(track_point.m_time).ToUTC() );
                     if( tp )
                     {
                         pSelect->AddSelectableTrackSegment( tp->m_lat, tp->m_lon, tp1->m_lat,
                             tp1->m_lon, tp, tp1, t );
                     }
                     tp = tp1;
-                    node = node->GetNext();
                 }
                 
                 pTrackList->Append( t );
@@ -34,6 +34,8 @@
 #include "AIS_Decoder.h"
 #include "AIS_Target_Data.h"
 #include "AISTargetAlertDialog.h"
+#include "AISTargetQueryDialog.h"
+#include "AISTargetListDialog.h"
 #include "Select.h"
 #include "georef.h"
 #include "geodesic.h"
@@ -52,6 +54,9 @@
 #endif
 
 extern AISTargetAlertDialog *g_pais_alert_dialog_active;
+extern AISTargetQueryDialog *g_pais_query_dialog_active;
+extern AISTargetListDialog *g_pAISTargetList;
+extern int g_AisTargetList_range;
 extern Select *pSelectAIS;
 extern Select *pSelect;
 extern MyFrame *gFrame;
@@ -203,6 +208,8 @@ AIS_Decoder::AIS_Decoder( wxFrame *parent )
 
 AIS_Decoder::~AIS_Decoder( void )
 {
+    m_target_grid.Clear();
+
     AIS_Target_Hash::iterator it;
     AIS_Target_Hash *current_targets = GetTargetList();
 
@@ -363,27 +370,20 @@ void AIS_Decoder::OnEvtAIS( OCPN_DataStreamEvent& event )
 //----------------------------------------------------------------------------------
 void AIS_Decoder::OnEvtSignalK(OCPN_SignalKEvent &event)
 {
-    wxJSONReader jsonReader;
-    wxJSONValue root;
-
-    std::string msgTerminated = event.GetString();
-    msgTerminated.append("\r\n");
-
-    int errors = jsonReader.Parse(msgTerminated, &root);
-    if(errors > 0)
+    SignalKDelta &delta = m_signalk_delta;
+    if( !delta.Parse( event.GetString() ) )
         return;
     
-    if(root.HasMember(_T("self"))) {
+    if(delta.HasSelf()) {
         //m_signalk_selfid = _T("vessels.") + (root["self"].AsString());
-        m_signalk_selfid = (root["self"].AsString());           // Verified for OpenPlotter node.js server 1.20
+        m_signalk_selfid = wxString::FromUTF8(delta.GetSelf().c_str());           // Verified for OpenPlotter node.js server 1.20
     }
     if(m_signalk_selfid.IsEmpty()) {
         return; // Don't handle any messages (with out self) until we know how we are
     }
     long mmsi = 0;
-    if(root.HasMember(_T("context"))
-       && root[_T("context")].IsString()) {
-        auto context = root[_T("context")].AsString();
+    if(delta.HasContext()) {
+        wxString context = wxString::FromUTF8(delta.GetContext().c_str());
         if (context == m_signalk_selfid) {
 #if 0
             wxLogMessage(_T("** Ignore context own ship.."));
@@ -406,12 +406,8 @@ void AIS_Decoder::OnEvtSignalK(OCPN_SignalKEvent &event)
         return; // Only handle ships with MMSI for now
     }
 #if 0
-    wxString dbg;
-    wxJSONWriter writer;
-    writer.Write(root, dbg);
-
     wxString msg( _T("AIS_Decoder::OnEvtSignalK: ") );
-    msg.append(dbg);
+    msg.append(wxString::FromUTF8(event.GetString().c_str()));
     wxLogMessage(msg);
 #endif
     AIS_Target_Data *pTargetData = 0;
@@ -421,37 +417,27 @@ void AIS_Decoder::OnEvtSignalK(OCPN_SignalKEvent &event)
     wxDateTime now;
     getAISTarget(mmsi, pTargetData, pStaleTarget, bnewtarget, last_report_ticks, now);
     if(pTargetData) {
-        if (root.HasMember(_T("updates"))
-            && root[_T("updates")].IsArray()) {
-            wxJSONValue &updates = root[_T("updates")];
-            for (int i = 0; i < updates.Size(); ++i) {
-                handleUpdate(pTargetData, bnewtarget, updates[i]);
-            }
+        for (size_t i = 0; i < delta.GetUpdateCount(); ++i) {
+            handleUpdate(pTargetData, bnewtarget, delta.GetUpdate(i));
         }
         pTargetData->MMSI = mmsi;
         // A SART can send wo any values first transmits. Detect class already here.
         if ( 97 == mmsi / 10000000 ) { pTargetData->Class = AIS_SART; }
         pTargetData->b_OwnShip = false;
         ( *AISTargetList )[pTargetData->MMSI] = pTargetData;
+        m_target_grid.Update( pTargetData );
     }
 }
 
 void AIS_Decoder::handleUpdate(AIS_Target_Data *pTargetData,
         bool bnewtarget,
-        wxJSONValue &update)
+        const SignalKDeltaUpdate &update)
 {
-    wxString sfixtime = "";
+    wxString sfixtime = wxString::FromUTF8(update.m_timestamp.c_str());
 
-    if(update.HasMember(_T("timestamp"))) {
-        sfixtime = update[_T("timestamp")].AsString();
-    }
-    if(update.HasMember(_T("values"))
-       && update[_T("values")].IsArray())
-    {
-        for (int j = 0; j < update[_T("values")].Size(); ++j) {
-            wxJSONValue &item = update[_T("values")][j];
-            updateItem(pTargetData, bnewtarget, item, sfixtime);
-        }
+    for (size_t j = 0; j < update.m_item_count; ++j) {
+        const SignalKDeltaItem &item = m_signalk_delta.GetItem(update.m_first_item + j);
+        updateItem(pTargetData, bnewtarget, item, sfixtime);
     }
     wxDateTime now = wxDateTime::Now();
     pTargetData->m_utc_hour = now.ToUTC().GetHour();
@@ -475,23 +461,33 @@ void AIS_Decoder::handleUpdate(AIS_Target_Data *pTargetData,
 
 }
 
+static double SKMemberDouble(const SignalKValue &value, const char *key)
+{
+    const SignalKLeaf *leaf = value.Find(key);
+    return leaf ? leaf->AsDouble() : 0.;
+}
+
+static std::string SKMemberString(const SignalKValue &value, const char *key)
+{
+    const SignalKLeaf *leaf = value.Find(key);
+    return leaf ? leaf->AsString() : std::string();
+}
+
 void AIS_Decoder::updateItem(AIS_Target_Data *pTargetData,
                              bool bnewtarget,
-                             wxJSONValue &item,
+                             const SignalKDeltaItem &item,
                              wxString &sfixtime) const
 {
-    if (item.HasMember(_T("path"))
-        && item.HasMember(_T("value"))) {
-
-        const wxString &update_path = item[_T("path")].AsString();
-        wxJSONValue &value = item[_T("value")];
-        if (update_path == _T("navigation.position")) {
-            if (value.HasMember(_T("latitude"))
-                && value.HasMember(_T("longitude"))) {
+    const SignalKValue &value = item.m_value;
+
+    switch (item.m_path_id) {
+        case SK_PATH_NAV_POSITION:
+            if (value.HasMember("latitude")
+                && value.HasMember("longitude")) {
                 wxDateTime now = wxDateTime::Now();
                 now.MakeUTC();
-                double lat = value[_T("latitude")].AsDouble();
-                double lon = value[_T("longitude")].AsDouble();
+                double lat = SKMemberDouble(value, "latitude");
+                double lon = SKMemberDouble(value, "longitude");
                 pTargetData->PositionReportTicks = now.GetTicks();
                 pTargetData->StaticReportTicks = now.GetTicks();
                 pTargetData->Lat = lat;
@@ -500,30 +496,34 @@ void AIS_Decoder::updateItem(AIS_Target_Data *pTargetData,
                 pTargetData->b_positionDoubtful = false;
             }
 
-            if ( value.HasMember(_T("altitude")) ) { 
-                pTargetData->altitude = value[_T("altitude ")].AsInt(); }
-        } else if (update_path == _T("navigation.speedOverGround")) {
+            if ( value.HasMember("altitude") ) { 
+                pTargetData->altitude = (int) SKMemberDouble(value, "altitude"); }
+            break;
+        case SK_PATH_NAV_SOG:
             pTargetData->SOG = value.AsDouble() * ms_to_knot_factor;
-        } else if (update_path == _T("navigation.courseOverGroundTrue")) {
+            break;
+        case SK_PATH_NAV_COG_TRUE:
             pTargetData->COG = GEODESIC_RAD2DEG(value.AsDouble());
-        } else if (update_path == _T("navigation.headingTrue")) {
+            break;
+        case SK_PATH_NAV_HEADING_TRUE:
             pTargetData->HDG = GEODESIC_RAD2DEG(value.AsDouble());
-        } else if (update_path == _T("navigation.rateOfTurn")) {
+            break;
+        case SK_PATH_NAV_RATE_OF_TURN:
             pTargetData->ROTAIS = 4.733*sqrt(value.AsDouble());
-        } else if (update_path == _T("design.aisShipType")) {
-            if (value.HasMember(_T("id"))) {
-                pTargetData->ShipType = value[_T("id")].AsUInt();
+            break;
+        case SK_PATH_DESIGN_AIS_SHIP_TYPE:
+        case SK_PATH_ATON_TYPE:
+            if (value.HasMember("id")) {
+                pTargetData->ShipType = (unsigned char) SKMemberDouble(value, "id");
             }
-        } else if (update_path == _T("atonType")) {
-            if (value.HasMember(_T("id"))) {
-                pTargetData->ShipType = value[_T("id")].AsUInt();
-            }        
-        } else if (update_path == _T("virtual")) {
-            if (_T("true") == value.AsString()) { 
+            break;
+        case SK_PATH_VIRTUAL:
+            if (value.AsString() == "true") { 
                 pTargetData->NavStatus = ATON_VIRTUAL; }
             else { pTargetData->NavStatus = ATON_REAL; }
-        } else if (update_path == _T("offPosition")) {
-            if (_T("true") == value.AsString()) {
+            break;
+        case SK_PATH_OFF_POSITION:
+            if (value.AsString() == "true") {
                 if (ATON_REAL == pTargetData->NavStatus) {
                     pTargetData->NavStatus = ATON_REAL_OFFPOSITION;
                 }
@@ -531,107 +531,124 @@ void AIS_Decoder::updateItem(AIS_Target_Data *pTargetData,
                     pTargetData->NavStatus = ATON_VIRTUAL_OFFPOSITION;
                 }
             }
-        } else if (update_path == _T("design.draft")) {
-            if (value.HasMember(_T("maximum"))) {
-                pTargetData->Draft = value[_T("maximum")].AsDouble();
-                pTargetData->Euro_Draft = value[_T("maximum")].AsDouble();
+            break;
+        case SK_PATH_DESIGN_DRAFT:
+            if (value.HasMember("maximum")) {
+                pTargetData->Draft = SKMemberDouble(value, "maximum");
+                pTargetData->Euro_Draft = SKMemberDouble(value, "maximum");
             }
-            if (value.HasMember(_T("current"))) {
-                double draft = value[_T("current")].AsDouble();
+            if (value.HasMember("current")) {
+                double draft = SKMemberDouble(value, "current");
                 if (draft > 0) {
                     pTargetData->Draft = draft;
                     pTargetData->Euro_Draft = draft;
                 }
             }
-        } else if (update_path == _T("design.length")) {
+            break;
+        case SK_PATH_DESIGN_LENGTH:
             if (pTargetData->DimB == 0) {
-                if (value.HasMember(_T("overall"))) {
-                    pTargetData->Euro_Length = value[_T("overall")].AsDouble();
-                    pTargetData->DimA = value[_T("overall")].AsInt();
+                if (value.HasMember("overall")) {
+                    pTargetData->Euro_Length = SKMemberDouble(value, "overall");
+                    pTargetData->DimA = (int) SKMemberDouble(value, "overall");
                     pTargetData->DimB = 0;
                 }
             }
-        } else if (update_path == _T("sensors.ais.class")) {
-            auto aisclass = value.AsString();
-            if (aisclass == _T("A") ) { pTargetData->Class = AIS_CLASS_A; }
-            else if (aisclass == _T("B")) {
+            break;
+        case SK_PATH_AIS_CLASS: {
+            std::string aisclass = value.AsString();
+            if (aisclass == "A" ) { pTargetData->Class = AIS_CLASS_A; }
+            else if (aisclass == "B") {
                 pTargetData->Class = AIS_CLASS_B;
                 pTargetData->NavStatus = UNDEFINED; // Class B targets have no status.  Enforce this... 
             } 
-            else if (aisclass == _T("BASE")) { pTargetData->Class = AIS_BASE; }
-            else if (aisclass == _T("ATON")) { pTargetData->Class = AIS_ATON; }
-        } else if (update_path == _T("sensors.ais.fromBow")) {
+            else if (aisclass == "BASE") { pTargetData->Class = AIS_BASE; }
+            else if (aisclass == "ATON") { pTargetData->Class = AIS_ATON; }
+            break;
+        }
+        case SK_PATH_AIS_FROM_BOW:
             if(pTargetData->DimB == 0 && pTargetData->DimA != 0) {
                 int length = pTargetData->DimA;
                 pTargetData->DimA = value.AsInt();
                 pTargetData->DimB = length - value.AsInt();
             }
-        } else if (update_path == _T("design.beam")) {
+            break;
+        case SK_PATH_DESIGN_BEAM:
             if (pTargetData->DimD == 0) {
                 pTargetData->Euro_Beam = value.AsDouble();
                 pTargetData->DimC = value.AsInt();
                 pTargetData->DimD = 0;
             }
-        } else if (update_path == _T("sensors.ais.fromCenter")) {
+            break;
+        case SK_PATH_AIS_FROM_CENTER:
             if(pTargetData->DimD == 0 && pTargetData->DimC != 0) {
                 int beam = pTargetData->DimC;
                 int center = beam / 2;
                 pTargetData->DimC = center + value.AsInt();
                 pTargetData->DimD = beam - pTargetData->DimC;
             }
-        } else if (update_path == _T("navigation.state")) {
-            auto state = value.AsString();
-            if (state == _T("motoring")) { pTargetData->NavStatus = UNDERWAY_USING_ENGINE; }
-            else if (state == _T("anchored")) { pTargetData->NavStatus = AT_ANCHOR; }
-            else if (state == _T("not under command")) { pTargetData->NavStatus = NOT_UNDER_COMMAND; }
-            else if (state == _T("restricted manouverability")) { pTargetData->NavStatus = RESTRICTED_MANOEUVRABILITY; }
-            else if (state == _T("constrained by draft")) { pTargetData->NavStatus = CONSTRAINED_BY_DRAFT; }
-            else if (state == _T("moored")) { pTargetData->NavStatus = MOORED; }
-            else if (state == _T("aground")) { pTargetData->NavStatus = AGROUND; }
-            else if (state == _T("fishing")) { pTargetData->NavStatus = FISHING; }
-            else if (state == _T("sailing")) { pTargetData->NavStatus = UNDERWAY_SAILING; }
-            else if (state == _T("hazardous material high speed")) { pTargetData->NavStatus = HSC; }
-            else if (state == _T("hazardous material wing in ground")) { pTargetData->NavStatus = WIG; }
-            else if (state == _T("ais-sart")) { pTargetData->NavStatus = RESERVED_14; }
+            break;
+        case SK_PATH_NAV_STATE: {
+            std::string state = value.AsString();
+            if (state == "motoring") { pTargetData->NavStatus = UNDERWAY_USING_ENGINE; }
+            else if (state == "anchored") { pTargetData->NavStatus = AT_ANCHOR; }
+            else if (state == "not under command") { pTargetData->NavStatus = NOT_UNDER_COMMAND; }
+            else if (state == "restricted manouverability") { pTargetData->NavStatus = RESTRICTED_MANOEUVRABILITY; }
+            else if (state == "constrained by draft") { pTargetData->NavStatus = CONSTRAINED_BY_DRAFT; }
+            else if (state == "moored") { pTargetData->NavStatus = MOORED; }
+            else if (state == "aground") { pTargetData->NavStatus = AGROUND; }
+            else if (state == "fishing") { pTargetData->NavStatus = FISHING; }
+            else if (state == "sailing") { pTargetData->NavStatus = UNDERWAY_SAILING; }
+            else if (state == "hazardous material high speed") { pTargetData->NavStatus = HSC; }
+            else if (state == "hazardous material wing in ground") { pTargetData->NavStatus = WIG; }
+            else if (state == "ais-sart") { pTargetData->NavStatus = RESERVED_14; }
             else { pTargetData->NavStatus = UNDEFINED; }
-        } else if (update_path == _T("navigation.destination.commonName")) {
-            const wxString &destination = value.AsString();
+            break;
+        }
+        case SK_PATH_NAV_DESTINATION_NAME: {
+            std::string destination = value.AsString();
             strncpy(pTargetData->Destination,
                 destination.c_str(), 20);
-        } else if (update_path == _T("navigation.specialManeuver")) {
-            if (_T("not available") != value.AsString() && pTargetData->IMO < 1) {
-                const wxString &bluesign = value.AsString();
-                if ( _T("not engaged")== bluesign){
+            break;
+        }
+        case SK_PATH_NAV_SPECIAL_MANEUVER: {
+            std::string bluesign = value.AsString();
+            if (bluesign != "not available" && pTargetData->IMO < 1) {
+                if (bluesign == "not engaged"){
                     pTargetData->blue_paddle = 1;
                 }
-                if (_T("engaged") == bluesign) {
+                if (bluesign == "engaged") {
                     pTargetData->blue_paddle = 2;
                 }
                 pTargetData->b_blue_paddle = pTargetData->blue_paddle == 2 ? true: false;                
             } 
-        } else if (update_path == _T("sensors.ais.designatedAreaCode")) {
+            break;
+        }
+        case SK_PATH_AIS_DAC:
             if (value.AsInt() == 200) { pTargetData->b_hasInlandDac = true; } // European inland
-        } else if (update_path == _T("sensors.ais.functionalId")) {
+            break;
+        case SK_PATH_AIS_FUNCTIONAL_ID:
             if (value.AsInt() == 10 &&  // "Inland ship static and voyage related data"
                 pTargetData->b_hasInlandDac) {
                 pTargetData->b_isEuroInland = true;
             }
-        } else if (update_path == _T("")) {
-            if(value.HasMember(_T("name"))) {
-                const wxString &name = value[_T("name")].AsString();
+            break;
+        case SK_PATH_ROOT:
+            if(value.HasMember("name")) {
+                std::string name = SKMemberString(value, "name");
                 strncpy(pTargetData->ShipName, name.c_str(), 20 );
                 pTargetData->b_nameValid = true;
                 pTargetData->MID = 123; // Indicates a name from SignalK
-            } else if (value.HasMember(_T("registrations"))) {
-                const wxString &imo = value[_T("registrations")][_T("imo")].AsString();
+            } else if (value.HasMember("registrations")) {
+                wxString imo = wxString::FromUTF8(SKMemberString(value, "registrations.imo").c_str());
                 pTargetData->IMO = wxAtoi(imo.Right(7));
-            } else if (value.HasMember(_T("communication"))) {
-                const wxString &callsign = value[_T("communication")][_T("callsignVhf")].AsString();
+            } else if (value.HasMember("communication")) {
+                std::string callsign = SKMemberString(value, "communication.callsignVhf");
                 strncpy(pTargetData->CallSign, callsign.c_str(), 7);
             }
             if(value.HasMember("mmsi")) {
                 long mmsi;
-                if (value[_T("mmsi")].AsString().ToLong(&mmsi)) {
+                wxString mmsi_string = wxString::FromUTF8(SKMemberString(value, "mmsi").c_str());
+                if (mmsi_string.ToLong(&mmsi)) {
                     pTargetData->MMSI = mmsi;
                     
                     if (97 == mmsi / 10000000) {
@@ -644,18 +661,11 @@ void AIS_Decoder::updateItem(AIS_Target_Data *pTargetData,
                     AISshipNameCache(pTargetData, AISTargetNamesC, AISTargetNamesNC, mmsi);
                 }
             }
-        } else {
-            wxLogMessage(wxString::Format(_T("** AIS_Decoder::updateItem: unhandled path %s"), update_path));
-#if 1
-            wxString dbg;
-            wxJSONWriter writer;
-            writer.Write(item, dbg);
-            wxString msg( _T("update: ") );
-            msg.append(dbg);
-            wxLogMessage(msg);
-#endif
-
-        }
+            break;
+        default:
+            wxLogMessage(wxString::Format(_T("** AIS_Decoder::updateItem: unhandled path %s"),
+                                          wxString::FromUTF8(item.m_path.c_str())));
+            break;
     }
 }
 
@@ -1359,6 +1369,7 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
             if( bdecode_result ) { 
                 AISshipNameCache(pTargetData, AISTargetNamesC, AISTargetNamesNC, mmsi);
                 ( *AISTargetList )[pTargetData->MMSI] = pTargetData;  // update the hash table entry
+                m_target_grid.Update( pTargetData );
 
                 if( !pTargetData->area_notices.empty() ) {
                     AIS_Target_Hash::iterator it = AIS_AreaNotice_Sources->find( pTargetData->MMSI );
@@ -1392,6 +1403,8 @@ AIS_Error AIS_Decoder::Decode( const wxString& str )
                     delete pTargetData;                           // this target is not going to be used
                     m_n_targets--;
                 } else {
+                    m_target_grid.Update( pTargetData );
+
                     //  If this is not an ownship message, update the AIS Target in the Selectable list
                     //  even if the message type was not recognized
                     if( !pTargetData->b_OwnShip ) {
@@ -1609,11 +1622,11 @@ AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
                 pTargetData = m_ptentative_dsctarget;
             } else {
                 pTargetData = it->second;          // find current entry
-                AISTargetTrackList *ptrack = pTargetData->m_ptrack;
-                pTargetData->CloneFrom( m_ptentative_dsctarget);  // this will make an empty track list
+                AISTargetTrack track;
+                std::swap( track, pTargetData->m_track );
+                pTargetData->CloneFrom( m_ptentative_dsctarget);  // this will copy an empty track
                 
-                delete pTargetData->m_ptrack;           // get rid of the new empty one
-                pTargetData->m_ptrack = ptrack;         // and substitute the old track list
+                std::swap( track, pTargetData->m_track );    // and substitute the old track
                 
                 delete m_ptentative_dsctarget;
             }
@@ -1624,6 +1637,7 @@ AIS_Target_Data *AIS_Decoder::ProcessDSx( const wxString& str, bool b_take_dsc )
             m_pLatestTargetData = pTargetData;
             
             ( *AISTargetList )[pTargetData->MMSI] = pTargetData;            // update the hash table entry
+            m_target_grid.Update( pTargetData );
                 
             long mmsi_long = pTargetData->MMSI;
 
@@ -2312,17 +2326,84 @@ bool AIS_Decoder::NMEACheckSumOK( const wxString& str_in )
     return false;
 }
 
+//    Return the range (NMi) beyond which no target can raise a CPA alarm,
+//    or -1 if the alarm is off or its settings do not bound it.
+double AIS_Decoder::GetCPAHorizon( void )
+{
+    double horizon = -1.;
+
+    if( !g_bCPAWarn )
+        return horizon;
+
+    if( g_bCPAMax )
+        horizon = g_CPAMax_NM;
+
+    //    A target can only come within g_CPAWarn_NM before g_TCPA_Max minutes
+    //    if the two vessels can close the distance at their best speeds.
+    if( g_bTCPA_Max && !std::isnan( gSog ) && ( gSog <= 102.2 ) ) {
+        double closing_kts = gSog + m_target_grid.GetMaxSOG();
+        double tcpa_horizon = g_CPAWarn_NM + ( closing_kts * g_TCPA_Max / 60. );
+        if( ( horizon < 0 ) || ( tcpa_horizon < horizon ) )
+            horizon = tcpa_horizon;
+    }
+
+    return horizon;
+}
+
 void AIS_Decoder::UpdateAllCPA( void )
 {
     //    Iterate thru all the targets
     AIS_Target_Hash::iterator it;
     AIS_Target_Hash *current_targets = GetTargetList();
 
+    double horizon = GetCPAHorizon();
+    double max_sog = 0.;
+
+    //    Without an alarm horizon, every target gets the full CPA solution
+    if( horizon < 0 ) {
+        for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
+            AIS_Target_Data *td = it->second;
+
+            if( NULL != td ) {
+                UpdateOneCPA( td );
+                if( ( ( td->SOG <= 102.2 ) || td->b_SarAircraftPosnReport ) && ( td->SOG > max_sog ) )
+                    max_sog = td->SOG;
+            }
+        }
+        m_target_grid.SetMaxSOG( max_sog );
+        return;
+    }
+
+    //    The rows of an open target list show CPA/TCPA, so reach out to its range too
+    if( g_pAISTargetList && g_pAISTargetList->IsShown() )
+        horizon = wxMax( horizon, (double) g_AisTargetList_range );
+
+    int query_mmsi = g_pais_query_dialog_active ? g_pais_query_dialog_active->GetMMSI() : 0;
+
+    //    Otherwise, refresh range and bearing everywhere, which is cheap,
+    //    and solve CPA/TCPA only for the targets the grid finds inside the horizon,
+    //    plus those whose CPA the user has asked to see.
     for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
         AIS_Target_Data *td = it->second;
 
-        if( NULL != td ) UpdateOneCPA( td );
+        if( NULL != td ) {
+            if( td->b_show_AIS_CPA || ( td->MMSI == query_mmsi ) )
+                UpdateOneCPA( td );
+            else {
+                UpdateOneRangeBrg( td );
+                td->bCPA_Valid = false;
+                td->TCPA = -1.;                 // so that stale values cannot raise an alarm
+            }
+            if( ( ( td->SOG <= 102.2 ) || td->b_SarAircraftPosnReport ) && ( td->SOG > max_sog ) )
+                max_sog = td->SOG;
+        }
     }
+    m_target_grid.SetMaxSOG( max_sog );
+
+    std::vector<AIS_Target_Data *> candidates;
+    m_target_grid.GetTargetsInRange( gLat, gLon, horizon, candidates );
+    for( size_t i = 0; i < candidates.size(); i++ )
+        UpdateOneCPA( candidates[i] );
 }
 
 void AIS_Decoder::UpdateAllTracks( void )
@@ -2342,26 +2423,25 @@ void AIS_Decoder::UpdateOneTrack( AIS_Target_Data *ptarget )
 {
    if( !ptarget->b_positionOnceValid ) return;
     // Reject for unbelievable jumps (corrupted/bad data)
-    if ( ptarget->m_ptrack->GetCount() > 0 )
+    if ( !ptarget->m_track.IsEmpty() )
     {
-        AISTargetTrackPoint *LastTrackpoint =  ptarget->m_ptrack->GetLast()->GetData();
-        if ( fabs( LastTrackpoint->m_lat - ptarget->Lat ) > .1  || fabs( LastTrackpoint->m_lon - ptarget->Lon ) > .1 )
+        AISTargetTrackPoint LastTrackpoint =  ptarget->m_track.GetLast();
+        if ( fabs( LastTrackpoint.m_lat - ptarget->Lat ) > .1  || fabs( LastTrackpoint.m_lon - ptarget->Lon ) > .1 )
         {
             // after an unlikely jump in pos, the last trackpoint might also be wrong
             // just to be sure we do delete this one as well.
-            ptarget->m_ptrack->pop_back();
+            ptarget->m_track.PopBack();
             ptarget->b_positionDoubtful = true;            
             return;
         }        
     }
 
-    //    Add the newest point
-    AISTargetTrackPoint *ptrackpoint = new AISTargetTrackPoint;
-    ptrackpoint->m_lat = ptarget->Lat;
-    ptrackpoint->m_lon = ptarget->Lon;
-    ptrackpoint->m_time = wxDateTime::Now().GetTicks();
+    //    Size the buffer for the configured track length, assuming at most one report per second
+    time_t now_ticks = wxDateTime::Now().GetTicks();
+    ptarget->m_track.SetMaxCount( (size_t) ( g_AISShowTracks_Mins * 60 ) + 1 );
 
-    ptarget->m_ptrack->Append( ptrackpoint );
+    //    Add the newest point
+    ptarget->m_track.Append( ptarget->Lat, ptarget->Lon, now_ticks );
     
     if( ptarget->b_PersistTrack )
     {
@@ -2379,8 +2459,8 @@ void AIS_Decoder::UpdateOneTrack( AIS_Target_Data *ptarget )
             t = m_persistent_tracks[ptarget->MMSI];
         }
         TrackPoint *tp = t->GetLastPoint();
-        vector2D point( ptrackpoint->m_lon, ptrackpoint->m_lat );
-        TrackPoint *tp1 = t->AddNewPoint( point, wxDateTime(ptrackpoint->m_time).ToUTC() );        
+        vector2D point( ptarget->Lon, ptarget->Lat );
+        TrackPoint *tp1 = t->AddNewPoint( point, wxDateTime(now_ticks).ToUTC() );        
         if( tp )
         {
             pSelect->AddSelectableTrackSegment( tp->m_lat, tp->m_lon, tp1->m_lat,
@@ -2392,21 +2472,11 @@ void AIS_Decoder::UpdateOneTrack( AIS_Target_Data *ptarget )
 //                pRouteManagerDialog->UpdateTrkListCtrl();
     }
 
-    //    Walk the list, removing any track points that are older than the stipulated time
+    //    Remove any track points that are older than the stipulated time
 
-    time_t test_time = wxDateTime::Now().GetTicks() - (time_t) ( g_AISShowTracks_Mins * 60 );
+    time_t test_time = now_ticks - (time_t) ( g_AISShowTracks_Mins * 60 );
 
-    wxAISTargetTrackListNode *node = ptarget->m_ptrack->GetFirst();
-    while( node ) {
-        AISTargetTrackPoint *ptrack_point = node->GetData();
-
-        if( ptrack_point->m_time < test_time ) {
-            if( ptarget->m_ptrack->DeleteObject( ptrack_point ) ) {
-                node = ptarget->m_ptrack->GetFirst();                // restart the list
-            }
-        } else
-            node = node->GetNext();
-    }
+    ptarget->m_track.TrimBefore( test_time );
 }
 
 void AIS_Decoder::DeletePersistentTrack( Track *track )
@@ -2424,6 +2494,7 @@ void AIS_Decoder::DeletePersistentTrack( Track *track )
 void AIS_Decoder::UpdateAllAlarms( void )
 {
     m_bGeneralAlert = false;                // no alerts yet
+    m_alert_mmsi.clear();
 
     //    Iterate thru all the targets
     AIS_Target_Hash::iterator it;
@@ -2484,6 +2555,14 @@ void AIS_Decoder::UpdateAllAlarms( void )
                     continue;
                 }
 
+                //    Skip distant targets if requested
+                if( g_bCPAMax ) {
+                    if( td->Range_NM > g_CPAMax_NM ) {
+                        td->n_alert_state = AIS_NO_ALERT;
+                        continue;
+                    }
+                }
+
                 //    No alert for my Follower
                 bool hit = false;
                 for(unsigned int i=0 ; i < g_MMSI_Props_Array.GetCount() ; i++){
@@ -2498,14 +2577,6 @@ void AIS_Decoder::UpdateAllAlarms( void )
                 }
                 if (hit) continue;
 
-                //    Skip distant targets if requested
-                if( g_bCPAMax ) {
-                    if( td->Range_NM > g_CPAMax_NM ) {
-                        td->n_alert_state = AIS_NO_ALERT;
-                        continue;
-                    }
-                }
-
                 if( ( td->CPA < g_CPAWarn_NM ) && ( td->TCPA > 0 ) && ( td->Class != AIS_ATON ) && ( td->Class != AIS_BASE )) {
                     if( g_bTCPA_Max ) {
                         if( td->TCPA < g_TCPA_Max ) this_alarm = AIS_ALERT_SET;
@@ -2534,11 +2605,13 @@ void AIS_Decoder::UpdateAllAlarms( void )
 
             td->n_alert_state = this_alarm;
 
+            if( this_alarm == AIS_ALERT_SET )
+                m_alert_mmsi.push_back( td->MMSI );
         }
     }
 }
 
-void AIS_Decoder::UpdateOneCPA( AIS_Target_Data *ptarget )
+void AIS_Decoder::UpdateOneRangeBrg( AIS_Target_Data *ptarget )
 {
     ptarget->Range_NM = -1.;            // Defaults
     ptarget->Brg = -1.;
@@ -2553,6 +2626,11 @@ void AIS_Decoder::UpdateOneCPA( AIS_Target_Data *ptarget )
     ptarget->Brg = brg;
 
     if( dist <= 1e-5 ) ptarget->Brg = -1.0;             // Brg is undefined if Range == 0.
+}
+
+void AIS_Decoder::UpdateOneCPA( AIS_Target_Data *ptarget )
+{
+    UpdateOneRangeBrg( ptarget );
 
     if( !ptarget->b_positionOnceValid || !bGPSValid ) {
         ptarget->bCPA_Valid = false;
@@ -2765,6 +2843,7 @@ void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
                 td->SOG = 103.0;
                 td->HDG = 511.0;
                 td->ROTAIS = -128;
+                m_target_grid.Remove( td->MMSI );
                 
                 SendJSONMsg(td);
 
@@ -2804,6 +2883,7 @@ void AIS_Decoder::OnTimerAIS( wxTimerEvent& event )
         AIS_Target_Hash::iterator itd = current_targets->find( remove_array[i] );
         if(itd != current_targets->end() ){
             AIS_Target_Data *td = itd->second;
+            m_target_grid.Remove( td->MMSI );
             current_targets->erase(itd);
             delete td;
         }
@@ -154,9 +154,6 @@ AIS_Target_Data::AIS_Target_Data()
     b_PersistTrack = false;
     b_in_ack_timeout = false;
 
-    m_ptrack = new AISTargetTrackList;
-    m_ptrack->DeleteContents(true);
-    
     b_active = false;
     blue_paddle = 0;
     bCPA_Valid = false;
@@ -241,16 +238,7 @@ void AIS_Target_Data::CloneFrom( AIS_Target_Data* q )
     b_OwnShip = q->b_OwnShip;
     b_in_ack_timeout = q->b_in_ack_timeout;
     
-    m_ptrack = new AISTargetTrackList;
-    m_ptrack->DeleteContents(true);
-    
-    wxAISTargetTrackListNode *node = q->m_ptrack->GetFirst();
-    while( node ) {
-        AISTargetTrackPoint *ptrack_point = node->GetData();
-        m_ptrack->Append( ptrack_point );
-        node = node->GetNext();
-    }
-    
+    m_track = q->m_track;
     
     b_active = q->b_active;
     blue_paddle = q->blue_paddle;
@@ -264,8 +252,6 @@ void AIS_Target_Data::CloneFrom( AIS_Target_Data* q )
 
 AIS_Target_Data::~AIS_Target_Data()
 {
-    m_ptrack->Clear();
-    delete m_ptrack;
 }
 
 wxString AIS_Target_Data::GetFullName( void )
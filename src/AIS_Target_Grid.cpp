@@ -0,0 +1,232 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "AIS_Target_Grid.h"
+#include "AIS_Target_Data.h"
+#include "bbox.h"
+
+AIS_Target_Grid::AIS_Target_Grid( double cell_deg )
+{
+    m_cell_deg = cell_deg;
+    m_nrows = (int) ceil( 180. / m_cell_deg );
+    m_ncols = (int) ceil( 360. / m_cell_deg );
+    m_max_sog = 0.;
+}
+
+AIS_Target_Grid::~AIS_Target_Grid()
+{
+}
+
+int AIS_Target_Grid::GetRow( double lat ) const
+{
+    int row = (int) floor( ( lat + 90. ) / m_cell_deg );
+    return wxMax( 0, wxMin( row, m_nrows - 1 ) );
+}
+
+int AIS_Target_Grid::GetCol( double lon ) const
+{
+    while( lon < -180. ) lon += 360.;
+    while( lon >= 180. ) lon -= 360.;
+    int col = (int) floor( ( lon + 180. ) / m_cell_deg );
+    return wxMax( 0, wxMin( col, m_ncols - 1 ) );
+}
+
+void AIS_Target_Grid::Update( AIS_Target_Data *td )
+{
+    if( !td )
+        return;
+
+    if( !td->b_positionOnceValid || std::isnan( td->Lat ) || std::isnan( td->Lon ) ) {
+        Remove( td->MMSI );
+        return;
+    }
+
+    if( ( ( td->SOG <= 102.2 ) || td->b_SarAircraftPosnReport ) && ( td->SOG > m_max_sog ) )
+        m_max_sog = td->SOG;
+
+    long key = GetKey( GetRow( td->Lat ), GetCol( td->Lon ) );
+
+    std::unordered_map<int, long>::iterator it = m_cell_of_target.find( td->MMSI );
+    if( it != m_cell_of_target.end() ) {
+        if( it->second == key )
+            return;                                     // still in the same cell
+
+        TargetCell &old_cell = m_cells[it->second];
+        TargetCell::iterator pos = std::find( old_cell.begin(), old_cell.end(), td );
+        if( pos != old_cell.end() ) {
+            *pos = old_cell.back();
+            old_cell.pop_back();
+        }
+        if( old_cell.empty() )
+            m_cells.erase( it->second );
+
+        it->second = key;
+    } else
+        m_cell_of_target[td->MMSI] = key;
+
+    m_cells[key].push_back( td );
+}
+
+void AIS_Target_Grid::Remove( int mmsi )
+{
+    std::unordered_map<int, long>::iterator it = m_cell_of_target.find( mmsi );
+    if( it == m_cell_of_target.end() )
+        return;
+
+    std::unordered_map<long, TargetCell>::iterator itc = m_cells.find( it->second );
+    if( itc != m_cells.end() ) {
+        TargetCell &cell = itc->second;
+        for( size_t i = 0; i < cell.size(); i++ ) {
+            if( cell[i]->MMSI == mmsi ) {
+                cell[i] = cell.back();
+                cell.pop_back();
+                break;
+            }
+        }
+        if( cell.empty() )
+            m_cells.erase( itc );
+    }
+
+    m_cell_of_target.erase( it );
+}
+
+void AIS_Target_Grid::Clear( void )
+{
+    m_cells.clear();
+    m_cell_of_target.clear();
+    m_max_sog = 0.;
+}
+
+//  Walk the occupied cells touching the box, calling visit() for each.
+//  The walk stops early if visit() returns true.
+//  If the box spans more cells than are occupied, the occupied cells are scanned instead,
+//  so that a world view costs no more than a linear pass.
+template <typename Visitor>
+bool AIS_Target_Grid::VisitBox( const LLBBox &box, Visitor &visit ) const
+{
+    if( !box.GetValid() || m_cells.empty() )
+        return false;
+
+    int row0 = GetRow( wxMax( box.GetMinLat(), -90. ) );
+    int row1 = GetRow( wxMin( box.GetMaxLat(), 90. ) );
+    if( row1 < row0 )
+        return false;
+
+    int col0, ncols_span;
+    double lon_range = box.GetMaxLon() - box.GetMinLon();
+    if( lon_range >= 360. ) {
+        col0 = 0;
+        ncols_span = m_ncols;
+    } else {
+        double lon0 = box.GetMinLon();
+        while( lon0 < -180. ) lon0 += 360.;
+        while( lon0 >= 180. ) lon0 -= 360.;
+        col0 = GetCol( lon0 );
+        int col1 = (int) floor( ( lon0 + lon_range + 180. ) / m_cell_deg );
+        ncols_span = wxMin( col1 - col0 + 1, m_ncols );
+    }
+
+    size_t nspan = (size_t) ( row1 - row0 + 1 ) * ncols_span;
+
+    if( nspan > m_cells.size() ) {
+        for( std::unordered_map<long, TargetCell>::const_iterator it = m_cells.begin();
+                it != m_cells.end(); ++it ) {
+            int row = it->first / m_ncols;
+            int col = it->first % m_ncols;
+            if( ( row < row0 ) || ( row > row1 ) )
+                continue;
+            if( ( ( col - col0 + m_ncols ) % m_ncols ) >= ncols_span )
+                continue;
+            if( visit( it->second ) )
+                return true;
+        }
+    } else {
+        for( int row = row0; row <= row1; row++ ) {
+            for( int i = 0; i < ncols_span; i++ ) {
+                int col = ( col0 + i ) % m_ncols;
+                std::unordered_map<long, TargetCell>::const_iterator it = m_cells.find( GetKey( row, col ) );
+                if( it == m_cells.end() )
+                    continue;
+                if( visit( it->second ) )
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+namespace {
+
+struct CollectVisitor {
+    std::vector<AIS_Target_Data *> &result;
+    CollectVisitor( std::vector<AIS_Target_Data *> &r ) : result( r ) {}
+    bool operator()( const std::vector<AIS_Target_Data *> &cell ) {
+        result.insert( result.end(), cell.begin(), cell.end() );
+        return false;
+    }
+};
+
+struct ContainsVisitor {
+    const LLBBox &box;
+    ContainsVisitor( const LLBBox &b ) : box( b ) {}
+    bool operator()( const std::vector<AIS_Target_Data *> &cell ) {
+        for( size_t i = 0; i < cell.size(); i++ ) {
+            if( box.Contains( cell[i]->Lat, cell[i]->Lon ) )
+                return true;
+        }
+        return false;
+    }
+};
+
+}
+
+void AIS_Target_Grid::GetTargetsInBox( const LLBBox &box, std::vector<AIS_Target_Data *> &result ) const
+{
+    CollectVisitor visit( result );
+    VisitBox( box, visit );
+}
+
+void AIS_Target_Grid::GetTargetsInRange( double lat, double lon, double range_nm,
+                                         std::vector<AIS_Target_Data *> &result ) const
+{
+    double dlat = range_nm / 60.;
+    double coslat = cos( wxMin( fabs( lat ) + dlat, 90. ) * PI / 180. );
+    double dlon = ( coslat > 1e-3 ) ? dlat / coslat : 360.;
+    if( dlon > 180. )
+        dlon = 180.;
+
+    LLBBox box;
+    box.Set( lat - dlat, lon - dlon, lat + dlat, lon + dlon );
+    GetTargetsInBox( box, result );
+}
+
+bool AIS_Target_Grid::AnyTargetInBox( const LLBBox &box ) const
+{
+    ContainsVisitor visit( box );
+    return VisitBox( box, visit );
+}
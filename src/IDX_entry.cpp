@@ -37,5 +37,7 @@ IDX_entry::IDX_entry()
 IDX_entry::~IDX_entry()
 {
     free(IDX_tzname);
+    free(m_year_mult);
+    free(m_year_phase);
 }
 
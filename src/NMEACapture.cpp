@@ -0,0 +1,334 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  NMEA/SignalK input capture and replay
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif //precompiled headers
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+#include "NMEACapture.h"
+#include "chart1.h"
+#include "multiplexer.h"
+#include "AIS_Decoder.h"
+#include "OCPN_DataStreamEvent.h"
+#include "OCPN_SignalKEvent.h"
+
+extern MyFrame          *gFrame;
+extern AIS_Decoder      *g_pAIS;
+extern  const wxEventType wxEVT_OCPN_DATASTREAM;
+
+static void PutLE( std::vector<unsigned char> &buf, uint64_t value, int nbytes )
+{
+    for( int i = 0; i < nbytes; i++ )
+        buf.push_back( (unsigned char) ( ( value >> ( 8 * i ) ) & 0xff ) );
+}
+
+static uint64_t GetLE( const unsigned char *p, int nbytes )
+{
+    uint64_t value = 0;
+    for( int i = nbytes - 1; i >= 0; i-- )
+        value = ( value << 8 ) | p[i];
+    return value;
+}
+
+//------------------------------------------------------------------------------
+//    NMEACaptureWriter Implementation
+//------------------------------------------------------------------------------
+
+NMEACaptureWriter::NMEACaptureWriter()
+{
+}
+
+NMEACaptureWriter::~NMEACaptureWriter()
+{
+    Close();
+}
+
+bool NMEACaptureWriter::Open( const wxString &path )
+{
+    Close();
+
+    if( !m_file.Open( path, _T("wb") ) ) {
+        wxLogMessage( _T("NMEA capture: cannot open ") + path );
+        return false;
+    }
+
+    m_file.Write( NMEA_CAPTURE_MAGIC, NMEA_CAPTURE_MAGIC_LEN );
+    m_buffer.reserve( NMEA_CAPTURE_FLUSH_SIZE + 1024 );
+    m_stream_ids.clear();
+    m_start = std::chrono::steady_clock::now();
+
+    wxLogMessage( _T("NMEA capture: recording to ") + path );
+    return true;
+}
+
+void NMEACaptureWriter::Close()
+{
+    if( !m_file.IsOpened() )
+        return;
+
+    Flush();
+    m_file.Close();
+}
+
+void NMEACaptureWriter::Flush()
+{
+    if( m_buffer.size() && m_file.IsOpened() )
+        m_file.Write( &m_buffer[0], m_buffer.size() );
+    m_buffer.clear();
+}
+
+uint16_t NMEACaptureWriter::GetStreamId( const wxString &port )
+{
+    std::map<wxString, uint16_t>::iterator it = m_stream_ids.find( port );
+    if( it != m_stream_ids.end() )
+        return it->second;
+
+    uint16_t id = (uint16_t) m_stream_ids.size();
+    m_stream_ids[port] = id;
+
+    wxCharBuffer name = port.ToUTF8();
+    AppendRecord( 0, id, CAPTURE_RECORD_STREAM, name.data(), strlen( name.data() ) );
+    return id;
+}
+
+void NMEACaptureWriter::AppendRecord( uint64_t timestamp_us, uint16_t stream_id, uint8_t type,
+                                      const char *payload, size_t len )
+{
+    PutLE( m_buffer, timestamp_us, 8 );
+    PutLE( m_buffer, stream_id, 2 );
+    PutLE( m_buffer, type, 1 );
+    PutLE( m_buffer, len, 4 );
+    m_buffer.insert( m_buffer.end(), payload, payload + len );
+}
+
+void NMEACaptureWriter::Write( int type, const wxString &port, const std::string &payload )
+{
+    if( !m_file.IsOpened() || ( payload.size() > NMEA_CAPTURE_MAX_PAYLOAD ) )
+        return;
+
+    uint64_t timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_start ).count();
+
+    uint16_t id = GetStreamId( port );
+    AppendRecord( timestamp_us, id, (uint8_t) type, payload.data(), payload.size() );
+
+    if( m_buffer.size() >= NMEA_CAPTURE_FLUSH_SIZE )
+        Flush();
+}
+
+//------------------------------------------------------------------------------
+//    NMEACaptureReader Implementation
+//------------------------------------------------------------------------------
+
+NMEACaptureReader::NMEACaptureReader()
+{
+}
+
+NMEACaptureReader::~NMEACaptureReader()
+{
+    Close();
+}
+
+bool NMEACaptureReader::Open( const wxString &path )
+{
+    Close();
+
+    if( !m_file.Open( path, _T("rb") ) )
+        return false;
+
+    if( !Rewind() ) {
+        wxLogMessage( _T("NMEA capture: not a capture file ") + path );
+        m_file.Close();
+        return false;
+    }
+    return true;
+}
+
+void NMEACaptureReader::Close()
+{
+    if( m_file.IsOpened() )
+        m_file.Close();
+    m_stream_names.clear();
+}
+
+bool NMEACaptureReader::Rewind()
+{
+    if( !m_file.IsOpened() || !m_file.Seek( 0 ) )
+        return false;
+
+    char magic[NMEA_CAPTURE_MAGIC_LEN];
+    if( m_file.Read( magic, NMEA_CAPTURE_MAGIC_LEN ) != NMEA_CAPTURE_MAGIC_LEN )
+        return false;
+    return !memcmp( magic, NMEA_CAPTURE_MAGIC, NMEA_CAPTURE_MAGIC_LEN );
+}
+
+bool NMEACaptureReader::ReadRecord( NMEACaptureRecord &record )
+{
+    unsigned char header[NMEA_CAPTURE_RECORD_HEADER_LEN];
+    if( m_file.Read( header, NMEA_CAPTURE_RECORD_HEADER_LEN ) != NMEA_CAPTURE_RECORD_HEADER_LEN )
+        return false;
+
+    record.m_timestamp_us = GetLE( header, 8 );
+    record.m_stream_id = (uint16_t) GetLE( header + 8, 2 );
+    record.m_type = header[10];
+    size_t len = (size_t) GetLE( header + 11, 4 );
+    if( len > NMEA_CAPTURE_MAX_PAYLOAD )
+        return false;                           // corrupt capture, treat as the end
+
+    record.m_payload.resize( len );
+    if( len && ( m_file.Read( &record.m_payload[0], len ) != len ) )
+        return false;                           // truncated capture
+
+    return true;
+}
+
+bool NMEACaptureReader::ReadNext( NMEACaptureRecord &record )
+{
+    while( ReadRecord( record ) ) {
+        if( record.m_type == CAPTURE_RECORD_STREAM ) {
+            m_stream_names[record.m_stream_id] = wxString::FromUTF8( record.m_payload.c_str() );
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+wxString NMEACaptureReader::GetStreamName( uint16_t stream_id ) const
+{
+    std::map<uint16_t, wxString>::const_iterator it = m_stream_names.find( stream_id );
+    if( it != m_stream_names.end() )
+        return it->second;
+    return wxEmptyString;
+}
+
+//------------------------------------------------------------------------------
+//    Capture benchmark
+//------------------------------------------------------------------------------
+
+static double Percentile( const std::vector<double> &sorted, double p )
+{
+    if( sorted.empty() )
+        return 0.;
+    size_t index = (size_t) ( p * ( sorted.size() - 1 ) + 0.5 );
+    return sorted[wxMin( index, sorted.size() - 1 )];
+}
+
+static void ReportLatency( const wxString &name, std::vector<double> &latency_us )
+{
+    if( latency_us.empty() )
+        return;
+
+    std::sort( latency_us.begin(), latency_us.end() );
+    wxString msg;
+    msg.Printf( _T("Capture benchmark: %s  %lu msgs  p50 %.1f us  p90 %.1f us  p99 %.1f us  p99.9 %.1f us  max %.1f us"),
+                name.c_str(), (unsigned long) latency_us.size(),
+                Percentile( latency_us, 0.5 ), Percentile( latency_us, 0.9 ),
+                Percentile( latency_us, 0.99 ), Percentile( latency_us, 0.999 ),
+                latency_us.back() );
+    wxLogMessage( msg );
+    printf( "%s\n", (const char *) msg.mb_str() );
+}
+
+bool RunCaptureBenchmark( const wxString &path )
+{
+    NMEACaptureReader reader;
+    if( !reader.Open( path ) ) {
+        wxLogMessage( _T("Capture benchmark: cannot read ") + path );
+        return false;
+    }
+
+    std::vector<double> ais_latency, gps_latency, signalk_latency;
+    NMEACaptureRecord record;
+    uint64_t first_ts = 0, last_ts = 0;
+    bool b_first = true;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    while( reader.ReadNext( record ) ) {
+        if( b_first ) {
+            first_ts = record.m_timestamp_us;
+            b_first = false;
+        }
+        last_ts = record.m_timestamp_us;
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        std::vector<double> *bucket = NULL;
+
+        if( record.m_type == CAPTURE_RECORD_NMEA ) {
+            OCPN_DataStreamEvent event( wxEVT_OCPN_DATASTREAM, 0 );
+            event.SetNMEAString( record.m_payload );
+            event.SetStream( NULL );
+
+            wxString message = event.ProcessNMEA4Tags();
+            if( Multiplexer::IsAISSentence( message ) ) {
+                if( g_pAIS ) {
+                    g_pAIS->OnEvtAIS( event );
+                    bucket = &ais_latency;
+                }
+            } else if( gFrame ) {
+                gFrame->OnEvtOCPN_NMEA( event );
+                bucket = &gps_latency;
+            }
+        } else if( record.m_type == CAPTURE_RECORD_SIGNALK ) {
+            OCPN_SignalKEvent event( 0, EVT_OCPN_SIGNALKSTREAM, record.m_payload );
+            if( g_pAIS )
+                g_pAIS->OnEvtSignalK( event );
+            if( gFrame )
+                gFrame->OnEvtOCPN_SignalK( event );
+            bucket = &signalk_latency;
+        }
+
+        if( bucket ) {
+            std::chrono::duration<double, std::micro> dt = std::chrono::steady_clock::now() - t0;
+            bucket->push_back( dt.count() );
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    size_t total = ais_latency.size() + gps_latency.size() + signalk_latency.size();
+    double captured_secs = ( last_ts - first_ts ) / 1e6;
+
+    wxString msg;
+    msg.Printf( _T("Capture benchmark: %lu msgs in %.3f s (%.0f msgs/s), capture spans %.1f s (%.1fx real time)"),
+                (unsigned long) total, elapsed.count(),
+                elapsed.count() > 0 ? total / elapsed.count() : 0.,
+                captured_secs,
+                elapsed.count() > 0 ? captured_secs / elapsed.count() : 0. );
+    wxLogMessage( msg );
+    printf( "%s\n", (const char *) msg.mb_str() );
+
+    ReportLatency( _T("AIS"), ais_latency );
+    ReportLatency( _T("GPS"), gps_latency );
+    ReportLatency( _T("SignalK"), signalk_latency );
+
+    return true;
+}
@@ -29,6 +29,14 @@
 #include "Track.h"
 #include "Route.h"
 
+#include <wx/thread.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #ifdef __OCPN__ANDROID__
 #include <QDebug>
 #endif
@@ -40,16 +48,19 @@ extern MyConfig    *pConfig;
 extern RouteList *pRouteList;
 extern TrackList *pTrackList;
 extern Select *pSelect;
+extern int g_nCPUCount;
 //extern bool g_bIsNewLayer;
 
 
 NavObjectCollection1::NavObjectCollection1()
 : pugi::xml_document()
 {
+    m_pstream = NULL;
 }
 
 NavObjectCollection1::~NavObjectCollection1()
 {
+    delete m_pstream;
 }
 
 
@@ -334,7 +345,8 @@ static TrackPoint * GPXLoadTrackPoint1( pugi::xml_node &wpt_node )
 static Track *GPXLoadTrack1( pugi::xml_node &trk_node, bool b_fullviz,
                       bool b_layer,
                       bool b_layerviz,
-                      int layer_id )
+                      int layer_id,
+                      bool b_create_guid = true )
 {
     wxString TrackName;
     wxString DescString;
@@ -346,7 +358,7 @@ static Track *GPXLoadTrack1( pugi::xml_node &trk_node, bool b_fullviz,
     
     wxString Name = wxString::FromUTF8( trk_node.name() );
     if( Name == _T ( "trk" ) ) {
-        pTentTrack = new Track();
+        pTentTrack = new Track( b_create_guid );
         GPXSeg = 0;   
         
         TrackPoint *pWp = NULL;
@@ -851,8 +863,8 @@ static bool GPXCreateTrkpt( pugi::xml_node node, TrackPoint *pt, unsigned int fl
  
     if(flags & OUT_TIME) {
         child = node.append_child("time");
-        if( pt->GetTimeString() )
-            child.append_child(pugi::node_pcdata).set_value(pt->GetTimeString());
+        if( pt->HasTime() )
+            child.append_child(pugi::node_pcdata).set_value(pt->GetTimeString().mb_str());
     }
     
     return true;
@@ -1447,49 +1459,539 @@ bool NavObjectCollection1::SaveFile( const wxString filename )
     return true;
 }
 
+static void LoadGPXObject( pugi::xml_node &object, bool b_full_viz, int &wpt_duplicates,
+                           bool b_compute_bbox, LLBBox &BBox )
+{
+    if( !strcmp(object.name(), "wpt") ) {
+        RoutePoint *pWp = ::GPXLoadWaypoint1( object, _T("circle"), _T(""), b_full_viz, false, false, 0 );
+        
+        pWp->m_bIsolatedMark = true;      // This is an isolated mark
+        RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon );
+        if( !pExisting ) {
+                if( NULL != pWayPointMan )
+                    pWayPointMan->AddRoutePoint( pWp );
+                 pSelect->AddSelectableRoutePoint( pWp->m_lat, pWp->m_lon, pWp );
+                 LLBBox wptbox;
+                 wptbox.Set(pWp->m_lat, pWp->m_lon, pWp->m_lat, pWp->m_lon);
+                 BBox.Expand(wptbox);
+        }
+        else {
+            delete pWp;
+            wpt_duplicates++;
+        }
+    }
+    else
+        if( !strcmp(object.name(), "trk") ) {
+            Track *pTrack = GPXLoadTrack1( object, b_full_viz, false, false, 0);
+            if (InsertTrack( pTrack ) && b_compute_bbox && pTrack->IsVisible()) {
+                    //BBox.Expand(pTrack->GetBBox());
+            }
+        }
+        else
+            if( !strcmp(object.name(), "rte") ) {
+                Route *pRoute = GPXLoadRoute1( object, b_full_viz, false, false, 0, false );
+                if (InsertRouteA( pRoute ) && b_compute_bbox && pRoute->IsVisible()) {
+                    BBox.Expand(pRoute->GetBBox());
+                }
+            }
+}
+
 bool NavObjectCollection1::LoadAllGPXObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox  )
 {
     wpt_duplicates = 0;
     pugi::xml_node objects = this->child("gpx");
+
+    if( pWayPointMan )
+        pWayPointMan->SyncRoutePointIndex();
     
     for (pugi::xml_node object = objects.first_child(); object; object = object.next_sibling())
+        LoadGPXObject( object, b_full_viz, wpt_duplicates, b_compute_bbox, BBox );
+    
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//    GPXTrackLoader
+//
+//    Builds Track objects from <trk> elements on a pool of worker threads.
+//    Tracks are handed back in submission order, so the calling thread can
+//    commit them to the track list in file order.
+//    The workers leave m_GUID empty. GUID generation is not thread safe, so
+//    missing GUIDs are assigned by the committing thread.
+//------------------------------------------------------------------------------
+
+class GPXTrackLoadJob
+{
+public:
+    std::string         m_element;
+    Track               *m_track;
+    std::string         m_error;                // parse failure, if any
+    bool                m_bdone;
+};
+
+class GPXTrackLoader
+{
+public:
+    GPXTrackLoader( int nthreads, bool b_fullviz );
+    ~GPXTrackLoader();
+
+    bool IsFull();
+    void Submit( std::string &element );
+    //  The oldest submitted track, if it is finished or b_wait is set.
+    //  track is NULL and error set if the element did not parse.
+    //  Returns false if there is none.
+    bool GetNext( Track *&track, std::string &error, bool b_wait );
+
+private:
+    void Worker();
+
+    bool                m_bfullviz;
+    size_t              m_max_jobs;
+    bool                m_bstop;
+
+    std::mutex          m_mutex;
+    std::condition_variable m_work_cond;
+    std::condition_variable m_done_cond;
+    std::deque<GPXTrackLoadJob *> m_todo;           // waiting for a worker
+    std::deque<GPXTrackLoadJob *> m_jobs;           // all jobs, in submission order
+    std::vector<std::thread> m_threads;
+};
+
+GPXTrackLoader::GPXTrackLoader( int nthreads, bool b_fullviz )
+{
+    m_bfullviz = b_fullviz;
+    m_bstop = false;
+
+    //  Enough to keep every worker busy while the reader catches up,
+    //  without holding more than a few elements in memory.
+    m_max_jobs = 4 * nthreads;
+
+    for( int i = 0; i < nthreads; i++ )
+        m_threads.push_back( std::thread( [this]() { Worker(); } ) );
+}
+
+GPXTrackLoader::~GPXTrackLoader()
+{
     {
-        if( !strcmp(object.name(), "wpt") ) {
-            RoutePoint *pWp = ::GPXLoadWaypoint1( object, _T("circle"), _T(""), b_full_viz, false, false, 0 );
-            
-            pWp->m_bIsolatedMark = true;      // This is an isolated mark
-            RoutePoint *pExisting = WaypointExists( pWp->GetName(), pWp->m_lat, pWp->m_lon );
-            if( !pExisting ) {
-                    if( NULL != pWayPointMan )
-                        pWayPointMan->AddRoutePoint( pWp );
-                     pSelect->AddSelectableRoutePoint( pWp->m_lat, pWp->m_lon, pWp );
-                     LLBBox wptbox;
-                     wptbox.Set(pWp->m_lat, pWp->m_lon, pWp->m_lat, pWp->m_lon);
-                     BBox.Expand(wptbox);
-            }
-            else {
-                delete pWp;
-                wpt_duplicates++;
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_bstop = true;
+    }
+    m_work_cond.notify_all();
+
+    for( size_t i = 0; i < m_threads.size(); i++ )
+        m_threads[i].join();
+
+    //  Only left over if the load was abandoned
+    for( size_t i = 0; i < m_jobs.size(); i++ ) {
+        delete m_jobs[i]->m_track;
+        delete m_jobs[i];
+    }
+}
+
+bool GPXTrackLoader::IsFull()
+{
+    std::lock_guard<std::mutex> lock( m_mutex );
+    return m_jobs.size() >= m_max_jobs;
+}
+
+void GPXTrackLoader::Submit( std::string &element )
+{
+    GPXTrackLoadJob *job = new GPXTrackLoadJob;
+    job->m_element.swap( element );
+    job->m_track = NULL;
+    job->m_bdone = false;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_todo.push_back( job );
+        m_jobs.push_back( job );
+    }
+    m_work_cond.notify_one();
+}
+
+bool GPXTrackLoader::GetNext( Track *&track, std::string &error, bool b_wait )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+    if( m_jobs.empty() )
+        return false;
+
+    GPXTrackLoadJob *job = m_jobs.front();
+    if( !job->m_bdone ) {
+        if( !b_wait )
+            return false;
+        m_done_cond.wait( lock, [job]() { return job->m_bdone; } );
+    }
+
+    m_jobs.pop_front();
+    track = job->m_track;
+    error.swap( job->m_error );
+    delete job;
+    return true;
+}
+
+void GPXTrackLoader::Worker()
+{
+    for(;;) {
+        GPXTrackLoadJob *job;
+        {
+            std::unique_lock<std::mutex> lock( m_mutex );
+            m_work_cond.wait( lock, [this]() { return m_bstop || !m_todo.empty(); } );
+            if( m_todo.empty() )
+                return;
+            job = m_todo.front();
+            m_todo.pop_front();
+        }
+
+        Track *pTrack = NULL;
+        std::string error;
+        {
+            pugi::xml_document doc;
+            pugi::xml_parse_result result = doc.load_buffer( job->m_element.data(), job->m_element.size(),
+                                                             pugi::parse_default, pugi::encoding_utf8 );
+            if( result ) {
+                pugi::xml_node object = doc.first_child();
+                pTrack = GPXLoadTrack1( object, m_bfullviz, false, false, 0, false );
             }
+            else
+                error = result.description();
         }
-        else
-            if( !strcmp(object.name(), "trk") ) {
-                Track *pTrack = GPXLoadTrack1( object, b_full_viz, false, false, 0);
-                if (InsertTrack( pTrack ) && b_compute_bbox && pTrack->IsVisible()) {
-                        //BBox.Expand(pTrack->GetBBox());
+        std::string().swap( job->m_element );
+
+        {
+            std::lock_guard<std::mutex> lock( m_mutex );
+            job->m_track = pTrack;
+            job->m_error.swap( error );
+            job->m_bdone = true;
+        }
+        m_done_cond.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------
+//    GPXStreamReader Implementation
+//------------------------------------------------------------------------------
+
+#define GPX_STREAM_CHUNK_SIZE   ( 1024 * 1024 )
+
+GPXStreamReader::GPXStreamReader()
+{
+    m_pos = 0;
+    m_beof = false;
+    m_bdone = false;
+    m_btruncated = false;
+}
+
+GPXStreamReader::~GPXStreamReader()
+{
+}
+
+bool GPXStreamReader::Fill()
+{
+    if( m_beof )
+        return false;
+
+    size_t len = m_buf.size();
+    m_buf.resize( len + GPX_STREAM_CHUNK_SIZE );
+    size_t nread = m_file.Read( &m_buf[len], GPX_STREAM_CHUNK_SIZE );
+    m_buf.resize( len + nread );
+
+    if( nread < GPX_STREAM_CHUNK_SIZE )
+        m_beof = true;
+    return true;
+}
+
+//    Scan the markup starting with the '<' at pos.
+//    Returns its MARKUP_ type and the position just past it,
+//    or -1 if the buffer ends first.
+int GPXStreamReader::ScanMarkup( size_t pos, size_t &end )
+{
+    const char *p = m_buf.c_str() + pos;
+    size_t avail = m_buf.size() - pos;
+
+    if( avail < 9 && !m_beof )
+        return -1;
+
+    const char *close = NULL;
+    size_t close_len = 1;
+    size_t start = 1;
+    int type = MARKUP_OTHER;
+
+    if( !strncmp( p, "<!--", 4 ) ) {
+        close = "-->";
+        close_len = 3;
+        start = 4;
+    }
+    else if( !strncmp( p, "<![CDATA[", 9 ) ) {
+        close = "]]>";
+        close_len = 3;
+        start = 9;
+    }
+    else if( !strncmp( p, "<?", 2 ) ) {
+        close = "?>";
+        close_len = 2;
+        start = 2;
+    }
+    else if( !strncmp( p, "<!", 2 ) )
+        close = ">";
+    else if( !strncmp( p, "</", 2 ) ) {
+        close = ">";
+        type = MARKUP_CLOSE;
+    }
+
+    if( close ) {
+        size_t found = m_buf.find( close, pos + start );
+        if( found == std::string::npos )
+            return -1;
+        end = found + close_len;
+        return type;
+    }
+
+    //  Element start tag, where attribute values may contain '>'
+    char quote = 0;
+    for( size_t i = pos + 1; i < m_buf.size(); i++ ) {
+        char c = m_buf[i];
+        if( quote ) {
+            if( c == quote )
+                quote = 0;
+        }
+        else if( c == '"' || c == '\'' )
+            quote = c;
+        else if( c == '>' ) {
+            end = i + 1;
+            return ( m_buf[i - 1] == '/' ) ? MARKUP_EMPTY : MARKUP_OPEN;
+        }
+    }
+    return -1;
+}
+
+bool GPXStreamReader::Open( const wxString &path )
+{
+    if( !m_file.Open( path, _T("rb") ) )
+        return false;
+
+    m_buf.clear();
+    m_pos = 0;
+    m_beof = false;
+    m_bdone = false;
+    m_btruncated = false;
+    if( !Fill() )
+        return false;
+
+    if( !m_buf.compare( 0, 3, "\xEF\xBB\xBF" ) )
+        m_buf.erase( 0, 3 );
+
+    size_t pos = 0;
+    for(;;) {
+        pos = m_buf.find_first_not_of( " \t\r\n", pos );
+        if( pos == std::string::npos ) {
+            if( !Fill() )
+                return false;
+            pos = 0;
+            continue;
+        }
+        if( m_buf[pos] != '<' )
+            return false;                       // UTF-16, or not XML at all
+
+        size_t end;
+        int type = ScanMarkup( pos, end );
+        if( type < 0 ) {
+            if( !Fill() )
+                return false;
+            continue;
+        }
+
+        if( type == MARKUP_OTHER ) {
+            //  The parser proper converts other encodings, we don't
+            if( !m_buf.compare( pos, 5, "<?xml" ) ) {
+                std::string decl = m_buf.substr( pos, end - pos );
+                size_t enc = decl.find( "encoding" );
+                if( enc != std::string::npos ) {
+                    size_t q = decl.find_first_of( "\"'", enc );
+                    if( q == std::string::npos )
+                        return false;
+                    wxString name( decl.substr( q + 1, 5 ).c_str(), wxConvUTF8 );
+                    if( !name.Lower().StartsWith( _T("utf-8") ) )
+                        return false;
                 }
             }
+            pos = end;
+            continue;
+        }
+        if( type == MARKUP_CLOSE )
+            return false;
+
+        m_root_tag = m_buf.substr( pos, end - pos );
+        m_bdone = ( type == MARKUP_EMPTY );
+        m_buf.erase( 0, end );
+        return true;
+    }
+}
+
+bool GPXStreamReader::ReadNext( std::string &element )
+{
+    //  Drop what has been consumed, once there is enough of it
+    //  to make moving the rest of the buffer worthwhile
+    if( m_pos >= GPX_STREAM_CHUNK_SIZE ) {
+        m_buf.erase( 0, m_pos );
+        m_pos = 0;
+    }
+
+    size_t start = std::string::npos;
+    size_t pos = m_pos;
+    int depth = 0;
+
+    while( !m_bdone ) {
+        size_t lt = m_buf.find( '<', pos );
+        if( lt == std::string::npos ) {
+            pos = m_buf.size();
+            if( !Fill() ) {
+                m_btruncated = true;
+                return false;
+            }
+            continue;
+        }
+
+        size_t end;
+        int type = ScanMarkup( lt, end );
+        if( type < 0 ) {
+            pos = lt;
+            if( !Fill() ) {
+                m_btruncated = true;
+                return false;
+            }
+            continue;
+        }
+        pos = end;
+
+        if( start == std::string::npos ) {
+            if( type == MARKUP_OPEN )
+                depth = 1;
+            else if( type == MARKUP_CLOSE ) {
+                m_bdone = true;                 // end of the root element
+                return false;
+            }
+            else if( type == MARKUP_OTHER )
+                continue;                       // comment or PI between elements
+            start = lt;
+        }
+        else if( type == MARKUP_OPEN )
+            depth++;
+        else if( type == MARKUP_CLOSE )
+            depth--;
+
+        if( depth == 0 ) {
+            element.assign( m_buf, start, end - start );
+            m_pos = end;
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+//    Streaming load
+//------------------------------------------------------------------------------
+
+void NavObjectCollection1::CommitStreamedTrack( Track *pTrack, const std::string &error )
+{
+    if( !pTrack ) {
+        if( !error.empty() )
+            wxLogMessage( _T("GPX parse error in %s: %s"), m_pstream->GetPath().c_str(),
+                          wxString::FromUTF8( error.c_str() ).c_str() );
+        return;
+    }
+
+    if( pTrack->m_GUID.IsEmpty() )
+        pTrack->m_GUID = pWayPointMan->CreateGUID( NULL );
+    InsertTrack( pTrack );
+}
+
+bool NavObjectCollection1::OpenGPXStream( const wxString &path )
+{
+    delete m_pstream;
+    m_pstream = new GPXStreamReader;
+
+    if( m_pstream->Open( path ) ) {
+        //  Keep just the root element, for IsOpenCPN()
+        std::string root = m_pstream->GetRootTag();
+        size_t name_end = root.find_first_of( " \t\r\n/>", 1 );
+        if( root.compare( root.size() - 2, 2, "/>" ) )
+            root += "</" + root.substr( 1, name_end - 1 ) + ">";
+
+        if( load_buffer( root.data(), root.size(), pugi::parse_default, pugi::encoding_utf8 ) )
+            return true;
+    }
+
+    //  Not streamable, load the whole document instead
+    delete m_pstream;
+    m_pstream = NULL;
+    return load_file( path.fn_str() );
+}
+
+bool NavObjectCollection1::LoadAllGPXStreamObjects( bool b_full_viz, int &wpt_duplicates, bool b_compute_bbox )
+{
+    if( !m_pstream )
+        return LoadAllGPXObjects( b_full_viz, wpt_duplicates, b_compute_bbox );
+
+    wpt_duplicates = 0;
+
+    if( pWayPointMan )
+        pWayPointMan->SyncRoutePointIndex();
+
+    int nCPU = wxMax( 1, wxThread::GetCPUCount() );
+    if( g_nCPUCount > 0 )
+        nCPU = g_nCPUCount;
+
+    GPXTrackLoader *track_loader = NULL;
+    std::string element;
+    std::string error;
+    Track *pTrack;
+
+    while( m_pstream->ReadNext( element ) ) {
+        //  Tracks go to the workers, started on the first one found.
+        //  Everything else refers to the waypoint and route lists, and is
+        //  loaded here in file order.
+        if( !element.compare( 0, 4, "<trk" ) && ( element.size() > 4 ) &&
+                strchr( " \t\r\n/>", element[4] ) ) {
+            if( !track_loader )
+                track_loader = new GPXTrackLoader( wxMax( nCPU - 1, 1 ), b_full_viz );
+
+            while( track_loader->IsFull() && track_loader->GetNext( pTrack, error, true ) )
+                CommitStreamedTrack( pTrack, error );
+            track_loader->Submit( element );
+        }
+        else {
+            pugi::xml_document doc;
+            pugi::xml_parse_result result = doc.load_buffer( element.data(), element.size(),
+                                                             pugi::parse_default, pugi::encoding_utf8 );
+            if( result ) {
+                pugi::xml_node object = doc.first_child();
+                LoadGPXObject( object, b_full_viz, wpt_duplicates, b_compute_bbox, BBox );
+            }
             else
-                if( !strcmp(object.name(), "rte") ) {
-                    Route *pRoute = GPXLoadRoute1( object, b_full_viz, false, false, 0, false );
-                    if (InsertRouteA( pRoute ) && b_compute_bbox && pRoute->IsVisible()) {
-                        BBox.Expand(pRoute->GetBBox());
-                    }
-                }
-                
-                
+                wxLogMessage( _T("GPX parse error in %s: %s"), m_pstream->GetPath().c_str(),
+                              wxString::FromUTF8( result.description() ).c_str() );
+        }
+
+        if( track_loader ) {
+            while( track_loader->GetNext( pTrack, error, false ) )
+                CommitStreamedTrack( pTrack, error );
+        }
     }
-    
+
+    if( track_loader ) {
+        while( track_loader->GetNext( pTrack, error, true ) )
+            CommitStreamedTrack( pTrack, error );
+        delete track_loader;
+    }
+
+    if( m_pstream->IsTruncated() )
+        wxLogMessage( _T("GPX file %s is truncated, objects after the last complete one were not loaded"),
+                      m_pstream->GetPath().c_str() );
+
+    delete m_pstream;
+    m_pstream = NULL;
+
     return true;
 }
 
@@ -1769,6 +2271,7 @@ bool NavObjectChanges::ApplyChanges(void)
             wxTrackListNode *tnode = node1->GetNext();
             delete pTrack;
             pTrackList->DeleteNode(node1);
+            g_pRouteMan->InvalidateGUIDIndex();
             node1 = tnode;
         } else
             node1 = node1->GetNext();
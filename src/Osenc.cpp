@@ -291,6 +291,7 @@ void Osenc::init( void )
     m_pauxInstream = NULL;
     m_pOutstream = NULL;
     m_pInstream = NULL;
+    m_pArena = NULL;
     m_UpFiles = nullptr;
 
     m_bVerbose = true;
@@ -754,7 +755,7 @@ int Osenc::ingest200(const wxString &senc_file_name,
 //                     int yyp = 4;
                 
                 if(acronym.length()){
-                    obj = new S57Obj(acronym.c_str());
+                    obj = S57Obj::New( acronym.c_str(), m_pArena );
                     obj->Index = featureID;
                     
                     pObjectVector->push_back(obj);
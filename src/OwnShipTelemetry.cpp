@@ -0,0 +1,113 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Own ship navigation state, readable from any thread
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <wx/time.h>
+
+#include "OwnShipTelemetry.h"
+
+OwnShipTelemetry::OwnShipTelemetry()
+{
+    memset( &m_staged, 0, sizeof( m_staged ) );
+    m_staged.Lat = m_staged.Lon = NAN;
+    m_staged.Cog = m_staged.Sog = NAN;
+    m_staged.Hdt = m_staged.Hdm = m_staged.Var = NAN;
+
+    m_source_names.push_back( _T("Unknown") );      // OWNSHIP_SOURCE_UNKNOWN
+
+    m_seq.store( 0, std::memory_order_relaxed );
+    Publish();
+}
+
+void OwnShipTelemetry::MarkReceived( int field_mask, int source )
+{
+    int64_t now = wxGetUTCTimeMillis().GetValue();
+    for( int i = 0; i < OWNSHIP_FIELD_COUNT; i++ ) {
+        if( field_mask & OWNSHIP_FIELD_BIT( i ) ) {
+            m_staged.FieldTime[i] = now;
+            m_staged.FieldSource[i] = source;
+        }
+    }
+}
+
+void OwnShipTelemetry::Publish()
+{
+    m_staged.UpdateCount++;
+
+    uint64_t words[NWORDS];
+    memset( words, 0, sizeof( words ) );
+    memcpy( words, &m_staged, sizeof( m_staged ) );
+
+    //  An odd sequence number tells readers a publish is in progress
+    uint32_t seq = m_seq.load( std::memory_order_relaxed );
+    m_seq.store( seq + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    for( int i = 0; i < NWORDS; i++ )
+        m_words[i].store( words[i], std::memory_order_relaxed );
+
+    m_seq.store( seq + 2, std::memory_order_release );
+}
+
+OwnShipState OwnShipTelemetry::Get() const
+{
+    uint64_t words[NWORDS];
+    uint32_t seq0, seq1;
+
+    do {
+        seq0 = m_seq.load( std::memory_order_acquire );
+        for( int i = 0; i < NWORDS; i++ )
+            words[i] = m_words[i].load( std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_acquire );
+        seq1 = m_seq.load( std::memory_order_relaxed );
+    } while( ( seq0 & 1 ) || ( seq0 != seq1 ) );
+
+    OwnShipState state;
+    memcpy( &state, words, sizeof( state ) );
+    return state;
+}
+
+int OwnShipTelemetry::GetSourceId( const wxString &name )
+{
+    wxMutexLocker lock( m_source_mutex );
+
+    for( size_t i = 0; i < m_source_names.size(); i++ ) {
+        if( m_source_names[i] == name )
+            return i;
+    }
+    m_source_names.push_back( name );
+    return m_source_names.size() - 1;
+}
+
+wxString OwnShipTelemetry::GetSourceName( int source ) const
+{
+    wxMutexLocker lock( m_source_mutex );
+
+    if( ( source >= 0 ) && ( source < (int) m_source_names.size() ) )
+        return m_source_names[source];
+    return m_source_names[OWNSHIP_SOURCE_UNKNOWN];
+}
@@ -0,0 +1,131 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  NMEA/SignalK capture replay DataStream
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ ***************************************************************************
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef  WX_PRECOMP
+#include "wx/wx.h"
+#endif //precompiled headers
+
+#include "ReplayDataStream.h"
+#include "OCPN_DataStreamEvent.h"
+#include "OCPN_SignalKEvent.h"
+
+ReplayDataStream::ReplayDataStream( wxEvtHandler *input_consumer, const wxString &path, double speed )
+    : DataStream( input_consumer, NETWORK, REPLAY_PORT_PREFIX + path, _T("0"),
+                  DS_TYPE_INPUT, 0, false, 0, DS_HANDSHAKE_NONE ),
+      m_bnext_valid( false ),
+      m_speed( speed ),
+      m_first_ts( 0 )
+{
+    SetChecksumCheck( true );
+
+    m_replay_timer.SetOwner( this );
+    Connect( wxEVT_TIMER, wxTimerEventHandler( ReplayDataStream::OnTimerReplay ), NULL, this );
+
+    if( !m_reader.Open( path ) ) {
+        wxLogMessage( _T("Replay: cannot open capture ") + path );
+        return;
+    }
+
+    m_bnext_valid = m_reader.ReadNext( m_next );
+    if( !m_bnext_valid )
+        return;
+
+    m_first_ts = m_next.m_timestamp_us;
+    m_start = std::chrono::steady_clock::now();
+    SetOk( true );
+
+    m_replay_timer.Start( 1, wxTIMER_ONE_SHOT );
+}
+
+ReplayDataStream::~ReplayDataStream()
+{
+    Close();
+}
+
+void ReplayDataStream::Close()
+{
+    m_replay_timer.Stop();
+    m_reader.Close();
+    m_bnext_valid = false;
+
+    DataStream::Close();
+}
+
+void ReplayDataStream::PostRecord( const NMEACaptureRecord &record )
+{
+    wxEvtHandler *consumer = GetConsumer();
+    if( !consumer )
+        return;
+
+    if( record.m_type == CAPTURE_RECORD_NMEA ) {
+        OCPN_DataStreamEvent Nevent( wxEVT_OCPN_DATASTREAM, 0 );
+        Nevent.SetNMEAString( record.m_payload );
+        Nevent.SetStream( this );
+        consumer->AddPendingEvent( Nevent );
+    } else if( record.m_type == CAPTURE_RECORD_SIGNALK ) {
+        OCPN_SignalKEvent signalKEvent( 0, EVT_OCPN_SIGNALKSTREAM, record.m_payload );
+        signalKEvent.SetStreamName( GetPort() );
+        consumer->AddPendingEvent( signalKEvent );
+    }
+}
+
+void ReplayDataStream::OnTimerReplay( wxTimerEvent &event )
+{
+    if( m_speed <= 0. ) {
+        for( int i = 0; m_bnext_valid && ( i < REPLAY_MAX_SPEED_BATCH ); i++ ) {
+            PostRecord( m_next );
+            m_bnext_valid = m_reader.ReadNext( m_next );
+        }
+    } else {
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - m_start;
+        double replay_us = elapsed.count() * m_speed;
+
+        while( m_bnext_valid && ( m_next.m_timestamp_us - m_first_ts <= replay_us ) ) {
+            PostRecord( m_next );
+            m_bnext_valid = m_reader.ReadNext( m_next );
+        }
+    }
+
+    ScheduleNext();
+}
+
+void ReplayDataStream::ScheduleNext()
+{
+    if( !m_bnext_valid ) {
+        wxLogMessage( _T("Replay: end of capture ") + GetPort() );
+        return;
+    }
+
+    int delay_ms = 1;
+    if( m_speed > 0. ) {
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - m_start;
+        double due_us = ( m_next.m_timestamp_us - m_first_ts ) / m_speed;
+        delay_ms = wxMax( 1, (int) ( ( due_us - elapsed.count() ) / 1000. ) );
+    }
+
+    m_replay_timer.Start( delay_ms, wxTIMER_ONE_SHOT );
+}
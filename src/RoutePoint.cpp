@@ -454,6 +454,9 @@ void RoutePoint::SetName(const wxString & name)
 #endif    
     m_MarkName = name;
     CalculateNameExtents();
+
+    if( m_ManagerNode && pWayPointMan )
+        pWayPointMan->UpdateRoutePointIndex( this );
 }
 
 void RoutePoint::CalculateNameExtents( void )
@@ -1083,6 +1086,9 @@ void RoutePoint::SetPosition( double lat, double lon )
 {
     m_lat = lat;
     m_lon = lon;
+
+    if( m_ManagerNode && pWayPointMan )
+        pWayPointMan->UpdateRoutePointIndex( this );
 }
 
 void RoutePoint::CalculateDCRect( wxDC& dc, ChartCanvas *canvas, wxRect *prect )
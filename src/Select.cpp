@@ -32,13 +32,182 @@
 #include "Route.h"
 #include "OCPNPlatform.h"
 
+#include <algorithm>
+#include <cmath>
+
 extern Routeman    *g_pRouteMan;
 extern OCPNPlatform *g_Platform;
 
+//    Grid cells are 1/32 degree, about 2 nm of latitude
+#define SELECT_GRID_CELLS_PER_DEGREE    32
+#define SELECT_GRID_NLON                ( 360 * SELECT_GRID_CELLS_PER_DEGREE )
+#define SELECT_GRID_NLAT                ( 180 * SELECT_GRID_CELLS_PER_DEGREE )
+#define SELECT_GRID_MAX_ITEM_CELLS      64
+#define SELECT_GRID_MAX_QUERY_CELLS     4096
+
+static double NormalizeSelectLon( double lon )
+{
+    while( lon >= 180. ) lon -= 360.;
+    while( lon < -180. ) lon += 360.;
+    return lon;
+}
+
+static int SelectGridX( double lon )
+{
+    return (int) floor( ( lon + 180. ) * SELECT_GRID_CELLS_PER_DEGREE );
+}
+
+static int SelectGridY( double lat )
+{
+    int iy = (int) floor( ( lat + 90. ) * SELECT_GRID_CELLS_PER_DEGREE );
+    return wxMax( 0, wxMin( iy, SELECT_GRID_NLAT - 1 ) );
+}
+
+static bool IsSegmentType( int seltype )
+{
+    return ( seltype == SELTYPE_ROUTESEGMENT ) || ( seltype == SELTYPE_TRACKSEGMENT );
+}
+
+static bool RemoveSelectItem( std::vector<SelectItem *> &items, SelectItem *pitem )
+{
+    std::vector<SelectItem *>::iterator it = std::find( items.begin(), items.end(), pitem );
+    if( it == items.end() )
+        return false;
+
+    *it = items.back();
+    items.pop_back();
+    return true;
+}
+
+static bool SelectOrderLess( const SelectItem *a, const SelectItem *b )
+{
+    return a->m_order < b->m_order;
+}
+
+//------------------------------------------------------------------------------
+//    SelectGrid Implementation
+//------------------------------------------------------------------------------
+
+//  Returns false if the item belongs in the large item list
+bool SelectGrid::GetCells( SelectItem *pitem, int &ix0, int &iy0, int &ix1, int &iy1 ) const
+{
+    double lat0 = pitem->m_slat, lon0 = pitem->m_slon;
+    double lat1 = lat0, lon1 = lon0;
+    if( IsSegmentType( pitem->m_seltype ) ) {
+        lat1 = pitem->m_slat2;
+        lon1 = pitem->m_slon2;
+    }
+
+    if( !std::isfinite( lat0 ) || !std::isfinite( lon0 ) ||
+        !std::isfinite( lat1 ) || !std::isfinite( lon1 ) )
+        return false;
+
+    lon0 = NormalizeSelectLon( lon0 );
+    lon1 = NormalizeSelectLon( lon1 );
+    if( fabs( lon1 - lon0 ) > 180. )            // crosses the date line
+        return false;
+
+    ix0 = SelectGridX( wxMin( lon0, lon1 ) );
+    ix1 = SelectGridX( wxMax( lon0, lon1 ) );
+    iy0 = SelectGridY( wxMin( lat0, lat1 ) );
+    iy1 = SelectGridY( wxMax( lat0, lat1 ) );
+
+    return ( ix1 - ix0 + 1 ) * ( iy1 - iy0 + 1 ) <= SELECT_GRID_MAX_ITEM_CELLS;
+}
+
+void SelectGrid::Insert( SelectItem *pitem )
+{
+    int ix0, iy0, ix1, iy1;
+    if( !GetCells( pitem, ix0, iy0, ix1, iy1 ) ) {
+        m_large.push_back( pitem );
+        return;
+    }
+
+    for( int iy = iy0; iy <= iy1; iy++ )
+        for( int ix = ix0; ix <= ix1; ix++ )
+            m_cells[iy * SELECT_GRID_NLON + ix].push_back( pitem );
+}
+
+void SelectGrid::Remove( SelectItem *pitem )
+{
+    int ix0, iy0, ix1, iy1;
+    if( !GetCells( pitem, ix0, iy0, ix1, iy1 ) ) {
+        if( RemoveSelectItem( m_large, pitem ) )
+            return;
+        ix0 = 0; ix1 = -1;
+    }
+
+    bool bfound = false;
+    for( int iy = iy0; iy <= iy1; iy++ ) {
+        for( int ix = ix0; ix <= ix1; ix++ ) {
+            std::unordered_map<uint32_t, std::vector<SelectItem *> >::iterator it =
+                    m_cells.find( iy * SELECT_GRID_NLON + ix );
+            if( it != m_cells.end() && RemoveSelectItem( it->second, pitem ) ) {
+                bfound = true;
+                if( it->second.empty() )
+                    m_cells.erase( it );
+            }
+        }
+    }
+
+    //  The item was moved without telling us, so sweep everything
+    if( !bfound ) {
+        RemoveSelectItem( m_large, pitem );
+        std::unordered_map<uint32_t, std::vector<SelectItem *> >::iterator it = m_cells.begin();
+        while( it != m_cells.end() ) {
+            while( RemoveSelectItem( it->second, pitem ) )
+                ;
+            if( it->second.empty() )
+                it = m_cells.erase( it );
+            else
+                ++it;
+        }
+    }
+}
+
+bool SelectGrid::Query( float lat0, float lon0, float lat1, float lon1,
+                        std::vector<SelectItem *> &items ) const
+{
+    //  Shift the box so its west edge is in [-180, 180), then wrap cells past the date line
+    double west = NormalizeSelectLon( lon0 );
+    int ix0 = SelectGridX( west );
+    int ix1 = SelectGridX( west + ( lon1 - lon0 ) );
+    if( ix1 - ix0 >= SELECT_GRID_NLON ) {
+        ix0 = 0;
+        ix1 = SELECT_GRID_NLON - 1;
+    }
+    int iy0 = SelectGridY( lat0 );
+    int iy1 = SelectGridY( lat1 );
+
+    if( ( ix1 - ix0 + 1 ) * ( iy1 - iy0 + 1 ) > SELECT_GRID_MAX_QUERY_CELLS )
+        return false;
+
+    items.insert( items.end(), m_large.begin(), m_large.end() );
+
+    if( m_cells.empty() )
+        return true;
+
+    for( int iy = iy0; iy <= iy1; iy++ ) {
+        for( int ix = ix0; ix <= ix1; ix++ ) {
+            std::unordered_map<uint32_t, std::vector<SelectItem *> >::const_iterator it =
+                    m_cells.find( iy * SELECT_GRID_NLON + ( ix % SELECT_GRID_NLON ) );
+            if( it != m_cells.end() )
+                items.insert( items.end(), it->second.begin(), it->second.end() );
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+//    Select Implementation
+//------------------------------------------------------------------------------
+
 Select::Select()
 {
     pSelectList = new SelectableItemList;
     pixelRadius = g_Platform->GetSelectRadiusPix();
+    m_first_order = 0;
+    m_last_order = 0;
 }
 
 Select::~Select()
@@ -49,6 +218,62 @@ Select::~Select()
 
 }
 
+//  The select list is searched front to back, so the items keep an order key
+//  that lets index queries return them in list order
+wxSelectableItemListNode *Select::AddItem( SelectItem *pitem, bool bappend )
+{
+    wxSelectableItemListNode *node;
+    if( bappend ) {
+        pitem->m_order = ++m_last_order;
+        node = pSelectList->Append( pitem );
+    } else {
+        pitem->m_order = --m_first_order;
+        node = pSelectList->Insert( pitem );
+    }
+
+    m_grid.Insert( pitem );
+    return node;
+}
+
+//  Fill m_candidates, in list order, with the items of type fseltype (any type if 0)
+//  that may be within selectRadius of the given position
+void Select::GetCandidates( float slat, float slon, int fseltype )
+{
+    m_candidates.clear();
+
+    if( m_grid.Query( slat - selectRadius, slon - selectRadius,
+                      slat + selectRadius, slon + selectRadius, m_candidates ) ) {
+        size_t n = 0;
+        for( size_t i = 0; i < m_candidates.size(); i++ ) {
+            if( !fseltype || m_candidates[i]->m_seltype == fseltype )
+                m_candidates[n++] = m_candidates[i];
+        }
+        m_candidates.resize( n );
+
+        std::sort( m_candidates.begin(), m_candidates.end(), SelectOrderLess );
+        m_candidates.erase( std::unique( m_candidates.begin(), m_candidates.end() ),
+                            m_candidates.end() );
+        return;
+    }
+
+    //  Zoomed too far out for the index, walk the whole list
+    wxSelectableItemListNode *node = pSelectList->GetFirst();
+    while( node ) {
+        SelectItem *pitem = node->GetData();
+        if( !fseltype || pitem->m_seltype == fseltype )
+            m_candidates.push_back( pitem );
+        node = node->GetNext();
+    }
+}
+
+void Select::ModifySelectItem( SelectItem *pitem, float slat, float slon )
+{
+    m_grid.Remove( pitem );
+    pitem->m_slat = slat;
+    pitem->m_slon = slon;
+    m_grid.Insert( pitem );
+}
+
 bool Select::IsSelectableRoutePointValid(RoutePoint *pRoutePoint )
 {
     SelectItem *pFindSel;
@@ -74,12 +299,7 @@ bool Select::AddSelectableRoutePoint( float slat, float slon, RoutePoint *pRoute
     pSelItem->m_bIsSelected = false;
     pSelItem->m_pData1 = pRoutePointAdd;
 
-    wxSelectableItemListNode *node;
-    
-    if( pRoutePointAdd->m_bIsInLayer )
-        node = pSelectList->Append( pSelItem );
-    else
-        node = pSelectList->Insert( pSelItem );
+    wxSelectableItemListNode *node = AddItem( pSelItem, pRoutePointAdd->m_bIsInLayer );
 
     pRoutePointAdd->SetSelectNode(node);
     
@@ -100,9 +320,7 @@ bool Select::AddSelectableRouteSegment( float slat1, float slon1, float slat2, f
     pSelItem->m_pData2 = pRoutePointAdd2;
     pSelItem->m_pData3 = pRoute;
 
-    if( pRoute->m_bIsInLayer ) pSelectList->Append( pSelItem );
-    else
-        pSelectList->Insert( pSelItem );
+    AddItem( pSelItem, pRoute->m_bIsInLayer );
 
     return true;
 }
@@ -119,6 +337,7 @@ bool Select::DeleteAllSelectableRouteSegments( Route *pr )
         if( pFindSel->m_seltype == SELTYPE_ROUTESEGMENT && 
             (Route *) pFindSel->m_pData3 == pr ) 
         {
+                m_grid.Remove( pFindSel );
                 delete pFindSel;
                 wxSelectableItemListNode *d = node;
                 node = node->GetNext();
@@ -149,6 +368,7 @@ bool Select::DeleteAllSelectableRoutePoints( Route *pr )
                 RoutePoint *prp = pnode->GetData();
 
                 if( prp == ps ) {
+                    m_grid.Remove( pFindSel );
                     delete pFindSel;
                     pSelectList->DeleteNode( node );   //delete node;
                     prp->SetSelectNode( NULL );
@@ -252,16 +472,20 @@ bool Select::UpdateSelectableRouteSegments( RoutePoint *prp )
         pFindSel = node->GetData();
         if( pFindSel->m_seltype == SELTYPE_ROUTESEGMENT ) {
             if( pFindSel->m_pData1 == prp ) {
+                m_grid.Remove( pFindSel );
                 pFindSel->m_slat = prp->m_lat;
                 pFindSel->m_slon = prp->m_lon;
+                m_grid.Insert( pFindSel );
                 ret = true;
                 ;
             }
 
             else
                 if( pFindSel->m_pData2 == prp ) {
+                    m_grid.Remove( pFindSel );
                     pFindSel->m_slat2 = prp->m_lat;
                     pFindSel->m_slon2 = prp->m_lon;
+                    m_grid.Insert( pFindSel );
                     ret = true;
                 }
         }
@@ -281,7 +505,7 @@ SelectItem *Select::AddSelectablePoint( float slat, float slon, const void *pdat
         pSelItem->m_bIsSelected = false;
         pSelItem->m_pData1 = pdata;
 
-        pSelectList->Append( pSelItem );
+        AddItem( pSelItem, true );
     }
 
     return pSelItem;
@@ -308,6 +532,7 @@ bool Select::DeleteSelectablePoint( void *pdata, int SeltypeToDelete )
             pFindSel = node->GetData();
             if( pFindSel->m_seltype == SeltypeToDelete ) {
                 if( pdata == pFindSel->m_pData1 ) {
+                    m_grid.Remove( pFindSel );
                     delete pFindSel;
                     delete node;
                     
@@ -335,6 +560,7 @@ bool Select::DeleteAllSelectableTypePoints( int SeltypeToDelete )
     while( node ) {
         pFindSel = node->GetData();
         if( pFindSel->m_seltype == SeltypeToDelete ) {
+            m_grid.Remove( pFindSel );
             delete node;
             
             if( SELTYPE_ROUTEPOINT == SeltypeToDelete ){
@@ -361,6 +587,7 @@ bool Select::DeleteSelectableRoutePoint( RoutePoint *prp )
         if(node){
             SelectItem *pFindSel = node->GetData();
             if(pFindSel){
+                m_grid.Remove( pFindSel );
                 delete pFindSel;
                 delete node;            // automatically removes from list
                 prp->SetSelectNode( NULL );
@@ -386,8 +613,7 @@ bool Select::ModifySelectablePoint( float lat, float lon, void *data, int Seltyp
         pFindSel = node->GetData();
         if( pFindSel->m_seltype == SeltypeToModify ) {
             if( data == pFindSel->m_pData1 ) {
-                pFindSel->m_slat = lat;
-                pFindSel->m_slon = lon;
+                ModifySelectItem( pFindSel, lat, lon );
                 return true;
             }
         }
@@ -411,9 +637,7 @@ bool Select::AddSelectableTrackSegment( float slat1, float slon1, float slat2, f
     pSelItem->m_pData2 = pTrackPointAdd2;
     pSelItem->m_pData3 = pTrack;
 
-    if( pTrack->m_bIsInLayer ) pSelectList->Append( pSelItem );
-    else
-        pSelectList->Insert( pSelItem );
+    AddItem( pSelItem, pTrack->m_bIsInLayer );
 
     return true;
 }
@@ -430,6 +654,7 @@ bool Select::DeleteAllSelectableTrackSegments( Track *pt )
         if( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT && 
           (Track *) pFindSel->m_pData3 == pt  ) 
         {
+            m_grid.Remove( pFindSel );
             delete pFindSel;
             wxSelectableItemListNode *d = node;
             node = node->GetNext();
@@ -453,6 +678,7 @@ bool Select::DeletePointSelectableTrackSegments( TrackPoint *pt )
         if( pFindSel->m_seltype == SELTYPE_TRACKSEGMENT &&
             ( (TrackPoint *) pFindSel->m_pData1 == pt ||
               (TrackPoint *) pFindSel->m_pData2 == pt ) ) {
+                m_grid.Remove( pFindSel );
                 delete pFindSel;
                 wxSelectableItemListNode *d = node;
                 node = node->GetNext();
@@ -534,40 +760,35 @@ SelectItem *Select::FindSelection( ChartCanvas *cc, float slat, float slon, int
     SelectItem *pFindSel;
 
     CalcSelectRadius(cc);
-
-//    Iterate on the list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == fseltype ) {
-            switch( fseltype ){
-                case SELTYPE_ROUTEPOINT:
-                case SELTYPE_TIDEPOINT:
-                case SELTYPE_CURRENTPOINT:
-                case SELTYPE_AISTARGET:
-                    a = fabs( slat - pFindSel->m_slat );
-                    b = fabs( slon - pFindSel->m_slon );
-
-                    if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
-                            && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) goto find_ok;
-                    break;
-                case SELTYPE_ROUTESEGMENT:
-                case SELTYPE_TRACKSEGMENT: {
-                    a = pFindSel->m_slat;
-                    b = pFindSel->m_slat2;
-                    c = pFindSel->m_slon;
-                    d = pFindSel->m_slon2;
-
-                    if( IsSegmentSelected( a, b, c, d, slat, slon ) ) goto find_ok;
-                    break;
-                }
-                default:
-                    break;
+    GetCandidates( slat, slon, fseltype );
+
+//    Iterate on the candidates, in list order
+    for( size_t i = 0; i < m_candidates.size(); i++ ) {
+        pFindSel = m_candidates[i];
+        switch( fseltype ){
+            case SELTYPE_ROUTEPOINT:
+            case SELTYPE_TIDEPOINT:
+            case SELTYPE_CURRENTPOINT:
+            case SELTYPE_AISTARGET:
+                a = fabs( slat - pFindSel->m_slat );
+                b = fabs( slon - pFindSel->m_slon );
+
+                if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
+                        && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) goto find_ok;
+                break;
+            case SELTYPE_ROUTESEGMENT:
+            case SELTYPE_TRACKSEGMENT: {
+                a = pFindSel->m_slat;
+                b = pFindSel->m_slat2;
+                c = pFindSel->m_slon;
+                d = pFindSel->m_slon2;
+
+                if( IsSegmentSelected( a, b, c, d, slat, slon ) ) goto find_ok;
+                break;
             }
+            default:
+                break;
         }
-
-        node = node->GetNext();
     }
 
     return NULL;
@@ -576,22 +797,12 @@ SelectItem *Select::FindSelection( ChartCanvas *cc, float slat, float slon, int
 
 bool Select::IsSelectableSegmentSelected( ChartCanvas *cc, float slat, float slon, SelectItem *pFindSel )
 {
-    bool valid = false;
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        if( pFindSel == node->GetData() ) {
-            valid = true;
-            break;
-        }
-        node = node->GetNext();
-    }
+    //  An item near enough to be selected is among the candidates, if still in the list
+    CalcSelectRadius(cc);
+    GetCandidates( slat, slon, 0 );
 
-    if (valid == false) {
-        // not in the list anymore
+    if( std::find( m_candidates.begin(), m_candidates.end(), pFindSel ) == m_candidates.end() )
         return false;
-    }
-    CalcSelectRadius(cc);
 
     float a = pFindSel->m_slat;
     float b = pFindSel->m_slat2;
@@ -624,55 +835,50 @@ SelectableItemList Select::FindSelectionList( ChartCanvas *cc, float slat, float
     SelectableItemList ret_list;
 
     CalcSelectRadius(cc);
-
-//    Iterate on the list
-    wxSelectableItemListNode *node = pSelectList->GetFirst();
-
-    while( node ) {
-        pFindSel = node->GetData();
-        if( pFindSel->m_seltype == fseltype ) {
-            switch( fseltype ){
-                case SELTYPE_ROUTEPOINT:
-                    if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
-                            && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) )
-                        if (is_selectable_wp(cc, (RoutePoint *)pFindSel->m_pData1))
-                            if( ( (RoutePoint *)pFindSel->m_pData1 )->IsVisibleSelectable(cc) )
-                                ret_list.Append( pFindSel );
-                    break;
-                case SELTYPE_TIDEPOINT:
-                case SELTYPE_CURRENTPOINT:
-                case SELTYPE_AISTARGET:
-                case SELTYPE_DRAGHANDLE:    
-                    if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
-                            && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) {
-                        if (is_selectable_wp(cc, (RoutePoint *)pFindSel->m_pData1))
+    GetCandidates( slat, slon, fseltype );
+
+//    Iterate on the candidates, in list order
+    for( size_t i = 0; i < m_candidates.size(); i++ ) {
+        pFindSel = m_candidates[i];
+        switch( fseltype ){
+            case SELTYPE_ROUTEPOINT:
+                if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
+                        && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) )
+                    if (is_selectable_wp(cc, (RoutePoint *)pFindSel->m_pData1))
+                        if( ( (RoutePoint *)pFindSel->m_pData1 )->IsVisibleSelectable(cc) )
                             ret_list.Append( pFindSel );
-                    }
-                    break;
-                case SELTYPE_ROUTESEGMENT:
-                case SELTYPE_TRACKSEGMENT: {
-                    a = pFindSel->m_slat;
-                    b = pFindSel->m_slat2;
-                    c = pFindSel->m_slon;
-                    d = pFindSel->m_slon2;
-
-                    if( IsSegmentSelected( a, b, c, d, slat, slon ) )
+                break;
+            case SELTYPE_TIDEPOINT:
+            case SELTYPE_CURRENTPOINT:
+            case SELTYPE_AISTARGET:
+            case SELTYPE_DRAGHANDLE:    
+                if( ( fabs( slat - pFindSel->m_slat ) < selectRadius )
+                        && ( fabs( slon - pFindSel->m_slon ) < selectRadius ) ) {
+                    if (is_selectable_wp(cc, (RoutePoint *)pFindSel->m_pData1))
+                        ret_list.Append( pFindSel );
+                }
+                break;
+            case SELTYPE_ROUTESEGMENT:
+            case SELTYPE_TRACKSEGMENT: {
+                a = pFindSel->m_slat;
+                b = pFindSel->m_slat2;
+                c = pFindSel->m_slon;
+                d = pFindSel->m_slon2;
+
+                if( IsSegmentSelected( a, b, c, d, slat, slon ) )
+                {
+                    if (cc->m_bShowNavobjects ||
+                        (fseltype == SELTYPE_ROUTESEGMENT && ((Route *)pFindSel->m_pData3)->m_bRtIsActive ))
                     {
-                        if (cc->m_bShowNavobjects ||
-                            (fseltype == SELTYPE_ROUTESEGMENT && ((Route *)pFindSel->m_pData3)->m_bRtIsActive ))
-                        {
-                            ret_list.Append( pFindSel );
-                        }
+                        ret_list.Append( pFindSel );
                     }
-
-                    break;
                 }
-                default:
-                    break;
+
+                break;
             }
+            default:
+                break;
         }
-
-        node = node->GetNext();
     }
 
     return ret_list;
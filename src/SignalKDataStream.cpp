@@ -72,6 +72,7 @@
 #include "NetworkDataStream.h"
 #include "OCPN_SignalKEvent.h"
 #include "OCPN_DataStreamEvent.h"
+#include "SignalKDelta.h"
 
 
 #if !defined(NAN)
@@ -114,6 +115,7 @@ void OCPN_WebSocketMessageHandler::OnWebSocketMessage( OCPN_SignalKEvent &event
 {
     if(m_upstream_consumer){
             OCPN_SignalKEvent signalKEvent(0, EVT_OCPN_SIGNALKSTREAM, event.GetString());
+            signalKEvent.SetStreamName(m_parent->GetPort());
             m_upstream_consumer->AddPendingEvent(signalKEvent);
     }
     
@@ -415,8 +417,7 @@ void SignalKDataStream::OnSocketEvent(wxSocketEvent& event)
         case wxSOCKET_INPUT:
         {
             #define RD_BUF_SIZE    4096 // Allows handling of high volume data streams.
-            wxJSONReader jsonReader;
-            wxJSONValue root;
+            SignalKDelta delta;
 
             std::vector<char> data(RD_BUF_SIZE+1);
             event.GetSocket()->Read(&data.front(),RD_BUF_SIZE);
@@ -456,26 +457,21 @@ void SignalKDataStream::OnSocketEvent(wxSocketEvent& event)
                         sk_line = sk_line.substr(sk_start);
                         if(sk_line.size()){
                             
-                            int errors = jsonReader.Parse(sk_line, &root);
-                            if (errors > 0) {
+                            if (!delta.Parse(sk_line)) {
                                 wxLogMessage(
-                                            wxString::Format(_T("SignalKDataStream ERROR: the JSON document is not well-formed:%d: %s"),
-                                                errors,
+                                            wxString::Format(_T("SignalKDataStream ERROR: the JSON document is not well-formed: %s"),
                                                 GetPort().c_str()));
 
                             } else {
                                 if( GetConsumer() ) {
 
 #if 0                                    
-                                    wxString dbg;
-                                    wxJSONWriter writer;
-                                    writer.Write(root, dbg);
-
                                     wxString msg( _T("SignalK TCP Socket Event sent to consumer:\n") );
-                                    msg.append(dbg);
+                                    msg.append(wxString::FromUTF8(sk_line.c_str()));
                                     wxLogMessage(msg);
 #endif
                                     OCPN_SignalKEvent signalKEvent(0, EVT_OCPN_SIGNALKSTREAM, sk_line);
+                                    signalKEvent.SetStreamName(GetPort());
                                     GetConsumer()->AddPendingEvent(signalKEvent);
                                 }
                             }
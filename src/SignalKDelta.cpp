@@ -0,0 +1,610 @@
+/***************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  SignalK delta message parser
+ *
+ ***************************************************************************
+ *   Copyright (C) 2010 by David S. Register                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
+ **************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unordered_map>
+
+#include "SignalKDelta.h"
+
+#define SK_MAX_DEPTH    32
+
+//------------------------------------------------------------------------------
+//    SignalKLeaf / SignalKValue
+//------------------------------------------------------------------------------
+
+double SignalKLeaf::AsDouble() const
+{
+    return ( m_type == SK_LEAF_NUMBER ) ? m_number : 0.;
+}
+
+std::string SignalKLeaf::AsString() const
+{
+    switch( m_type ) {
+        case SK_LEAF_NUMBER:
+        case SK_LEAF_STRING:
+            return m_string;
+        case SK_LEAF_BOOL:
+            return m_number ? "true" : "false";
+        default:
+            return "null";
+    }
+}
+
+bool SignalKValue::HasMember( const char *key ) const
+{
+    size_t len = strlen( key );
+    for( size_t i = 0; i < m_count; i++ ) {
+        const std::string &k = m_leaves[i].m_key;
+        if( !k.compare( 0, len, key ) && ( ( k.size() == len ) || ( k[len] == '.' ) ) )
+            return true;
+    }
+    return false;
+}
+
+const SignalKLeaf *SignalKValue::Find( const char *key ) const
+{
+    for( size_t i = 0; i < m_count; i++ ) {
+        if( m_leaves[i].m_key == key )
+            return &m_leaves[i];
+    }
+    return NULL;
+}
+
+SignalKLeaf &SignalKValue::AddLeaf()
+{
+    if( m_count == m_leaves.size() )
+        m_leaves.push_back( SignalKLeaf() );
+    SignalKLeaf &leaf = m_leaves[m_count++];
+    leaf.m_key.clear();
+    leaf.m_type = SK_LEAF_NULL;
+    leaf.m_number = 0.;
+    leaf.m_string.clear();
+    return leaf;
+}
+
+//------------------------------------------------------------------------------
+//    SignalKDelta
+//------------------------------------------------------------------------------
+
+SignalKDelta::SignalKDelta()
+{
+    m_p = m_end = NULL;
+    m_nitems = 0;
+    Clear();
+}
+
+void SignalKDelta::Clear()
+{
+    m_bhas_self = m_bhas_context = m_bhas_version = false;
+    m_self.clear();
+    m_context.clear();
+    m_version.clear();
+    m_updates.clear();
+    m_nitems = 0;
+}
+
+SignalKPath SignalKDelta::InternPath( const std::string &path )
+{
+    static const struct { const char *path; SignalKPath id; } known_paths[] = {
+        { "",                                   SK_PATH_ROOT },
+        { "navigation.position",                SK_PATH_NAV_POSITION },
+        { "navigation.speedOverGround",         SK_PATH_NAV_SOG },
+        { "navigation.courseOverGroundTrue",    SK_PATH_NAV_COG_TRUE },
+        { "navigation.courseOverGroundMagnetic", SK_PATH_NAV_COG_MAGNETIC },
+        { "navigation.headingTrue",             SK_PATH_NAV_HEADING_TRUE },
+        { "navigation.headingMagnetic",         SK_PATH_NAV_HEADING_MAGNETIC },
+        { "navigation.magneticVariation",       SK_PATH_NAV_MAGNETIC_VARIATION },
+        { "navigation.rateOfTurn",              SK_PATH_NAV_RATE_OF_TURN },
+        { "navigation.gnss.satellites",         SK_PATH_NAV_GNSS_SATELLITES },
+        { "navigation.state",                   SK_PATH_NAV_STATE },
+        { "navigation.destination.commonName",  SK_PATH_NAV_DESTINATION_NAME },
+        { "navigation.specialManeuver",         SK_PATH_NAV_SPECIAL_MANEUVER },
+        { "design.aisShipType",                 SK_PATH_DESIGN_AIS_SHIP_TYPE },
+        { "design.draft",                       SK_PATH_DESIGN_DRAFT },
+        { "design.length",                      SK_PATH_DESIGN_LENGTH },
+        { "design.beam",                        SK_PATH_DESIGN_BEAM },
+        { "atonType",                           SK_PATH_ATON_TYPE },
+        { "virtual",                            SK_PATH_VIRTUAL },
+        { "offPosition",                        SK_PATH_OFF_POSITION },
+        { "sensors.ais.class",                  SK_PATH_AIS_CLASS },
+        { "sensors.ais.fromBow",                SK_PATH_AIS_FROM_BOW },
+        { "sensors.ais.fromCenter",             SK_PATH_AIS_FROM_CENTER },
+        { "sensors.ais.designatedAreaCode",     SK_PATH_AIS_DAC },
+        { "sensors.ais.functionalId",           SK_PATH_AIS_FUNCTIONAL_ID }
+    };
+
+    typedef std::unordered_map<std::string, SignalKPath> PathMap;
+    struct PathMapBuilder {
+        static PathMap Build() {
+            PathMap map;
+            for( size_t i = 0; i < sizeof( known_paths ) / sizeof( known_paths[0] ); i++ )
+                map[known_paths[i].path] = known_paths[i].id;
+            return map;
+        }
+    };
+    static const PathMap path_map = PathMapBuilder::Build();
+
+    PathMap::const_iterator it = path_map.find( path );
+    return ( it != path_map.end() ) ? it->second : SK_PATH_UNKNOWN;
+}
+
+bool SignalKDelta::Parse( const std::string &msg )
+{
+    Clear();
+    m_p = msg.data();
+    m_end = m_p + msg.size();
+
+    return ParseRoot();
+}
+
+void SignalKDelta::SkipSpace()
+{
+    while( ( m_p < m_end ) && ( ( *m_p == ' ' ) || ( *m_p == '\t' ) || ( *m_p == '\r' ) || ( *m_p == '\n' ) ) )
+        m_p++;
+}
+
+bool SignalKDelta::Expect( char c )
+{
+    SkipSpace();
+    if( ( m_p < m_end ) && ( *m_p == c ) ) {
+        m_p++;
+        return true;
+    }
+    return false;
+}
+
+//    Step to the next member of an object or element of an array.
+//    The member key, if any, is left in m_key.
+//    Returns 1 if there is a member to parse, 0 at the closing bracket, -1 on error.
+int SignalKDelta::NextMember( bool &bfirst, char close, bool bkeyed )
+{
+    if( Expect( close ) )
+        return 0;
+    if( !bfirst && !Expect( ',' ) )
+        return -1;
+    bfirst = false;
+    if( bkeyed && ( !ParseString( m_key ) || !Expect( ':' ) ) )
+        return -1;
+    return 1;
+}
+
+bool SignalKDelta::ParseRoot()
+{
+    if( !Expect( '{' ) )
+        return false;
+
+    bool bfirst = true;
+    int next;
+    while( ( next = NextMember( bfirst, '}', true ) ) > 0 ) {
+        SkipSpace();
+        if( m_p >= m_end )
+            return false;
+
+        if( ( m_key == "self" ) || ( m_key == "version" ) ) {
+            std::string &target = ( m_key == "self" ) ? m_self : m_version;
+            ( ( m_key == "self" ) ? m_bhas_self : m_bhas_version ) = true;
+            if( *m_p == '"' ) {
+                if( !ParseString( target ) )
+                    return false;
+            } else {
+                SignalKLeaf leaf;
+                if( !ParseScalar( leaf ) )
+                    return false;
+                target = leaf.AsString();
+            }
+        } else if( ( m_key == "context" ) && ( *m_p == '"' ) ) {
+            if( !ParseString( m_context ) )
+                return false;
+            m_bhas_context = true;
+        } else if( ( m_key == "updates" ) && ( *m_p == '[' ) ) {
+            if( !ParseUpdates() )
+                return false;
+        } else if( !SkipValue( 0 ) )
+            return false;
+    }
+    return next == 0;
+}
+
+bool SignalKDelta::ParseUpdates()
+{
+    m_p++;                                  // '['
+    bool bfirst = true;
+    int next;
+    while( ( next = NextMember( bfirst, ']', false ) ) > 0 ) {
+        SkipSpace();
+        if( ( m_p < m_end ) && ( *m_p == '{' ) ) {
+            if( !ParseUpdate() )
+                return false;
+        } else if( !SkipValue( 0 ) )
+            return false;
+    }
+    return next == 0;
+}
+
+bool SignalKDelta::ParseUpdate()
+{
+    m_p++;                                  // '{'
+
+    SignalKDeltaUpdate update;
+    update.m_first_item = m_nitems;
+    update.m_item_count = 0;
+
+    bool bfirst = true;
+    int next;
+    while( ( next = NextMember( bfirst, '}', true ) ) > 0 ) {
+        SkipSpace();
+        if( m_p >= m_end )
+            return false;
+
+        if( ( m_key == "timestamp" ) && ( *m_p == '"' ) ) {
+            if( !ParseString( update.m_timestamp ) )
+                return false;
+        } else if( ( m_key == "values" ) && ( *m_p == '[' ) ) {
+            if( !ParseItems() )
+                return false;
+        } else if( !SkipValue( 0 ) )
+            return false;
+    }
+    if( next < 0 )
+        return false;
+
+    update.m_item_count = m_nitems - update.m_first_item;
+    m_updates.push_back( update );
+    return true;
+}
+
+bool SignalKDelta::ParseItems()
+{
+    m_p++;                                  // '['
+    bool bfirst = true;
+    int next;
+    while( ( next = NextMember( bfirst, ']', false ) ) > 0 ) {
+        SkipSpace();
+        if( ( m_p < m_end ) && ( *m_p == '{' ) ) {
+            if( !ParseItem() )
+                return false;
+        } else if( !SkipValue( 0 ) )
+            return false;
+    }
+    return next == 0;
+}
+
+bool SignalKDelta::ParseItem()
+{
+    m_p++;                                  // '{'
+
+    if( m_nitems == m_items.size() )
+        m_items.push_back( SignalKDeltaItem() );
+    SignalKDeltaItem &item = m_items[m_nitems];
+    item.m_path.clear();
+    item.m_bhas_path = item.m_bhas_value = false;
+    item.m_value.Clear();
+
+    bool bfirst = true;
+    int next;
+    while( ( next = NextMember( bfirst, '}', true ) ) > 0 ) {
+        SkipSpace();
+        if( m_p >= m_end )
+            return false;
+
+        if( ( m_key == "path" ) && ( *m_p == '"' ) ) {
+            if( !ParseString( item.m_path ) )
+                return false;
+            item.m_bhas_path = true;
+        } else if( m_key == "value" ) {
+            m_value_key.clear();
+            item.m_value.Clear();
+            if( !ParseValue( item.m_value, m_value_key, 0 ) )
+                return false;
+            item.m_bhas_value = true;
+        } else if( !SkipValue( 0 ) )
+            return false;
+    }
+    if( next < 0 )
+        return false;
+
+    //  Items without both a path and a value are of no use to anyone
+    if( item.m_bhas_path && item.m_bhas_value ) {
+        item.m_path_id = InternPath( item.m_path );
+        m_nitems++;
+    }
+    return true;
+}
+
+bool SignalKDelta::ParseValue( SignalKValue &value, std::string &key, int depth )
+{
+    SkipSpace();
+    if( ( m_p >= m_end ) || ( depth > SK_MAX_DEPTH ) )
+        return false;
+
+    if( ( *m_p == '{' ) || ( *m_p == '[' ) ) {
+        bool bobject = ( *m_p == '{' );
+        m_p++;
+        size_t key_len = key.size();
+        int index = 0;
+
+        for( bool bfirst = true; ; bfirst = false ) {
+            if( Expect( bobject ? '}' : ']' ) )
+                break;
+            if( !bfirst && !Expect( ',' ) )
+                return false;
+
+            if( key_len )
+                key += '.';
+            if( bobject ) {
+                if( !ParseString( m_key ) || !Expect( ':' ) )
+                    return false;
+                key += m_key;
+            } else {
+                char buf[16];
+                snprintf( buf, sizeof( buf ), "%d", index++ );
+                key += buf;
+            }
+
+            if( !ParseValue( value, key, depth + 1 ) )
+                return false;
+            key.resize( key_len );
+        }
+        return true;
+    }
+
+    SignalKLeaf &leaf = value.AddLeaf();
+    leaf.m_key = key;
+    return ParseScalar( leaf );
+}
+
+bool SignalKDelta::ParseScalar( SignalKLeaf &leaf )
+{
+    SkipSpace();
+    if( m_p >= m_end )
+        return false;
+
+    switch( *m_p ) {
+        case '"':
+            leaf.m_type = SK_LEAF_STRING;
+            return ParseString( leaf.m_string );
+        case 't':
+            if( ( m_end - m_p < 4 ) || strncmp( m_p, "true", 4 ) )
+                return false;
+            m_p += 4;
+            leaf.m_type = SK_LEAF_BOOL;
+            leaf.m_number = 1.;
+            return true;
+        case 'f':
+            if( ( m_end - m_p < 5 ) || strncmp( m_p, "false", 5 ) )
+                return false;
+            m_p += 5;
+            leaf.m_type = SK_LEAF_BOOL;
+            leaf.m_number = 0.;
+            return true;
+        case 'n':
+            if( ( m_end - m_p < 4 ) || strncmp( m_p, "null", 4 ) )
+                return false;
+            m_p += 4;
+            leaf.m_type = SK_LEAF_NULL;
+            return true;
+        default:
+            leaf.m_type = SK_LEAF_NUMBER;
+            return ParseNumber( leaf.m_number, leaf.m_string );
+    }
+}
+
+static void AppendUTF8( std::string &out, unsigned long cp )
+{
+    if( cp < 0x80 )
+        out += (char) cp;
+    else if( cp < 0x800 ) {
+        out += (char) ( 0xc0 | ( cp >> 6 ) );
+        out += (char) ( 0x80 | ( cp & 0x3f ) );
+    } else if( cp < 0x10000 ) {
+        out += (char) ( 0xe0 | ( cp >> 12 ) );
+        out += (char) ( 0x80 | ( ( cp >> 6 ) & 0x3f ) );
+        out += (char) ( 0x80 | ( cp & 0x3f ) );
+    } else {
+        out += (char) ( 0xf0 | ( cp >> 18 ) );
+        out += (char) ( 0x80 | ( ( cp >> 12 ) & 0x3f ) );
+        out += (char) ( 0x80 | ( ( cp >> 6 ) & 0x3f ) );
+        out += (char) ( 0x80 | ( cp & 0x3f ) );
+    }
+}
+
+static bool ParseHex4( const char *p, const char *end, unsigned long &value )
+{
+    if( end - p < 4 )
+        return false;
+    value = 0;
+    for( int i = 0; i < 4; i++ ) {
+        char c = p[i];
+        value <<= 4;
+        if( ( c >= '0' ) && ( c <= '9' ) ) value |= c - '0';
+        else if( ( c >= 'a' ) && ( c <= 'f' ) ) value |= c - 'a' + 10;
+        else if( ( c >= 'A' ) && ( c <= 'F' ) ) value |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+bool SignalKDelta::ParseString( std::string &out )
+{
+    if( !Expect( '"' ) )
+        return false;
+
+    out.clear();
+    while( m_p < m_end ) {
+        //  Copy unescaped runs in one go
+        const char *run = m_p;
+        while( ( m_p < m_end ) && ( *m_p != '"' ) && ( *m_p != '\\' ) )
+            m_p++;
+        out.append( run, m_p - run );
+
+        if( m_p >= m_end )
+            return false;
+        if( *m_p++ == '"' )
+            return true;
+
+        if( m_p >= m_end )
+            return false;
+        char c = *m_p++;
+        switch( c ) {
+            case '"':  out += '"';  break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/';  break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                unsigned long cp;
+                if( !ParseHex4( m_p, m_end, cp ) )
+                    return false;
+                m_p += 4;
+                if( ( cp >= 0xd800 ) && ( cp < 0xdc00 ) && ( m_end - m_p >= 6 ) &&
+                        ( m_p[0] == '\\' ) && ( m_p[1] == 'u' ) ) {
+                    unsigned long low;
+                    if( ParseHex4( m_p + 2, m_end, low ) && ( low >= 0xdc00 ) && ( low < 0xe000 ) ) {
+                        cp = 0x10000 + ( ( cp - 0xd800 ) << 10 ) + ( low - 0xdc00 );
+                        m_p += 6;
+                    }
+                }
+                AppendUTF8( out, cp );
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+//    Locale independent number conversion; strtod() would honour a comma decimal point.
+bool SignalKDelta::ParseNumber( double &number, std::string &text )
+{
+    const char *start = m_p;
+    bool bneg = false;
+    uint64_t mantissa = 0;
+    int ndigits = 0;
+    int exponent = 0;
+
+    if( ( m_p < m_end ) && ( *m_p == '-' ) ) {
+        bneg = true;
+        m_p++;
+    }
+
+    const char *digits = m_p;
+    while( ( m_p < m_end ) && ( *m_p >= '0' ) && ( *m_p <= '9' ) ) {
+        if( ndigits < 19 ) {
+            mantissa = mantissa * 10 + ( *m_p - '0' );
+            if( mantissa ) ndigits++;
+        } else
+            exponent++;
+        m_p++;
+    }
+    if( m_p == digits )
+        return false;
+
+    if( ( m_p < m_end ) && ( *m_p == '.' ) ) {
+        m_p++;
+        const char *frac = m_p;
+        while( ( m_p < m_end ) && ( *m_p >= '0' ) && ( *m_p <= '9' ) ) {
+            if( ndigits < 19 ) {
+                mantissa = mantissa * 10 + ( *m_p - '0' );
+                if( mantissa ) ndigits++;
+                exponent--;
+            }
+            m_p++;
+        }
+        if( m_p == frac )
+            return false;
+    }
+
+    if( ( m_p < m_end ) && ( ( *m_p == 'e' ) || ( *m_p == 'E' ) ) ) {
+        m_p++;
+        bool bexp_neg = false;
+        if( ( m_p < m_end ) && ( ( *m_p == '+' ) || ( *m_p == '-' ) ) )
+            bexp_neg = ( *m_p++ == '-' );
+        const char *exp_digits = m_p;
+        int e = 0;
+        while( ( m_p < m_end ) && ( *m_p >= '0' ) && ( *m_p <= '9' ) ) {
+            if( e < 10000 )
+                e = e * 10 + ( *m_p - '0' );
+            m_p++;
+        }
+        if( m_p == exp_digits )
+            return false;
+        exponent += bexp_neg ? -e : e;
+    }
+
+    //  Dividing by an exact power of ten keeps typical fixed point values correctly rounded
+    double value = (double) mantissa;
+    if( exponent < 0 )
+        value = ( exponent >= -22 ) ? value / pow( 10., -exponent ) : value * pow( 10., exponent );
+    else if( exponent > 0 )
+        value *= pow( 10., exponent );
+
+    number = bneg ? -value : value;
+    text.assign( start, m_p - start );
+    return true;
+}
+
+bool SignalKDelta::SkipValue( int depth )
+{
+    SkipSpace();
+    if( ( m_p >= m_end ) || ( depth > SK_MAX_DEPTH ) )
+        return false;
+
+    if( ( *m_p == '{' ) || ( *m_p == '[' ) ) {
+        bool bobject = ( *m_p == '{' );
+        m_p++;
+        for( bool bfirst = true; ; bfirst = false ) {
+            if( Expect( bobject ? '}' : ']' ) )
+                return true;
+            if( !bfirst && !Expect( ',' ) )
+                return false;
+            if( bobject ) {
+                if( !ParseString( m_key ) || !Expect( ':' ) )
+                    return false;
+            }
+            if( !SkipValue( depth + 1 ) )
+                return false;
+        }
+    }
+
+    if( *m_p == '"' ) {
+        m_p++;
+        while( m_p < m_end ) {
+            if( *m_p == '\\' )
+                m_p += 2;
+            else if( *m_p++ == '"' )
+                return true;
+        }
+        return false;
+    }
+
+    SignalKLeaf leaf;
+    return ParseScalar( leaf );
+}
@@ -26,10 +26,6 @@
 
 #include <cstddef>
 
-#include "wx/jsonval.h"
-#include "wx/jsonwriter.h"
-#include "wx/jsonreader.h"
-
 #include "geodesic.h"
 #include "SignalKEventHandler.h"
 #include "OCPN_SignalKEvent.h"
@@ -43,38 +39,30 @@ bool             bGPSValid_SK;
 
 void SignalKEventHandler::OnEvtOCPN_SignalK(OCPN_SignalKEvent &event)
 {
-    wxJSONReader jsonReader;
-    wxJSONValue root;
-
     LOG_DEBUG("%s\n", event.GetString().c_str());
 
-    std::string msgTerminated = event.GetString();
-    msgTerminated.append("\r\n");
-
-    int errors = jsonReader.Parse(msgTerminated, &root);
-    if (errors > 0) {
-        wxLogMessage( wxString::Format(_T("SignalKDataStream ERROR: the JSON document is not well-formed:%d"),
-                      errors));
+    if (!m_delta.Parse(event.GetString())) {
+        wxLogMessage( _T("SignalKDataStream ERROR: the JSON document is not well-formed"));
         return;
     }
 
-    if (root.HasMember(_T("version"))) {
+    if (m_delta.HasVersion()) {
         wxString msg = _T("Connected to Signal K server version: ");
-        msg << (root[_T("version")].AsString());
+        msg << wxString::FromUTF8(m_delta.GetVersion().c_str());
         wxLogMessage(msg);
     }
 
-    if(root.HasMember("self")) {
-        if(root["self"].AsString().StartsWith(_T("vessels.")))
-            m_self = (root["self"].AsString());                                 // for java server, and OpenPlotter node.js server 1.20
+    if(m_delta.HasSelf()) {
+        wxString self = wxString::FromUTF8(m_delta.GetSelf().c_str());
+        if(self.StartsWith(_T("vessels.")))
+            m_self = self;                                  // for java server, and OpenPlotter node.js server 1.20
         else
-            m_self = _T("vessels.") + (root["self"].AsString());                // for Node.js server
+            m_self = _T("vessels.") + self;                 // for Node.js server
         g_ownshipMMSI_SK = m_self;    
     }
     
-    if(root.HasMember("context")
-       && root["context"].IsString()) {
-        auto context = root["context"].AsString();
+    if(m_delta.HasContext()) {
+        wxString context = wxString::FromUTF8(m_delta.GetContext().c_str());
         if (context != m_self) {
 #if 0
             wxLogMessage(_T("** Ignore context of other ships.."));
@@ -83,79 +71,61 @@ void SignalKEventHandler::OnEvtOCPN_SignalK(OCPN_SignalKEvent &event)
         }
     }
 
-    if(root.HasMember("updates")
-       && root["updates"].IsArray()) {
-        wxJSONValue &updates = root["updates"];
-        for (int i = 0; i < updates.Size(); ++i) {
-            handleUpdate(updates[i]);
-        }
+    for (size_t i = 0; i < m_delta.GetUpdateCount(); ++i) {
+        handleUpdate(m_delta.GetUpdate(i));
     }
 }
 
-void SignalKEventHandler::handleUpdate(wxJSONValue &update) const {
-    wxString sfixtime = "";
+void SignalKEventHandler::handleUpdate(const SignalKDeltaUpdate &update) const {
+    wxString sfixtime = wxString::FromUTF8(update.m_timestamp.c_str());
 
-    if(update.HasMember("timestamp")) {
-        sfixtime = update["timestamp"].AsString();
-    }
-    if(update.HasMember("values")
-       && update["values"].IsArray())
-    {
-        for (int j = 0; j < update["values"].Size(); ++j) {
-            wxJSONValue &item = update["values"][j];
-            updateItem(item, sfixtime);
-        }
+    for (size_t j = 0; j < update.m_item_count; ++j) {
+        updateItem(m_delta.GetItem(update.m_first_item + j), sfixtime);
     }
 }
 
-void SignalKEventHandler::updateItem(wxJSONValue &item, wxString &sfixtime) const {
-    if(item.HasMember("path")
-       && item.HasMember("value")) {
-        const wxString &update_path = item["path"].AsString();
-        wxJSONValue &value = item["value"];
-        if(update_path == _T("navigation.position")) {
+void SignalKEventHandler::updateItem(const SignalKDeltaItem &item, wxString &sfixtime) const {
+    const SignalKValue &value = item.m_value;
+
+    switch (item.m_path_id) {
+        case SK_PATH_NAV_POSITION:
             updateNavigationPosition(value, sfixtime);
-        } else if(update_path == _T("navigation.speedOverGround") && bGPSValid_SK)
-        {
-            updateNavigationSpeedOverGround(value, sfixtime);
-        } else if(update_path == _T("navigation.courseOverGroundTrue") && bGPSValid_SK)
-        {
-            updateNavigationCourseOverGround(value, sfixtime);
-        } else if(update_path == _T("navigation.courseOverGroundMagnetic"))
-        {  // Ignore magnetic COG as OpenCPN don't handle yet.
-        } else if(update_path == _T("navigation.gnss.satellites"))
-        {
+            break;
+        case SK_PATH_NAV_SOG:
+            if (bGPSValid_SK)
+                updateNavigationSpeedOverGround(value, sfixtime);
+            break;
+        case SK_PATH_NAV_COG_TRUE:
+            if (bGPSValid_SK)
+                updateNavigationCourseOverGround(value, sfixtime);
+            break;
+        case SK_PATH_NAV_COG_MAGNETIC:
+            // Ignore magnetic COG as OpenCPN don't handle yet.
+            break;
+        case SK_PATH_NAV_GNSS_SATELLITES:
             updateGnssSatellites(value, sfixtime);
-        } else if(update_path == _T("navigation.headingTrue"))
-        {
+            break;
+        case SK_PATH_NAV_HEADING_TRUE:
             updateHeadingTrue(value, sfixtime);
-        } else if(update_path == _T("navigation.headingMagnetic"))
-        {
+            break;
+        case SK_PATH_NAV_HEADING_MAGNETIC:
             updateHeadingMagnetic(value, sfixtime);
-        } else if(update_path == _T("navigation.magneticVariation"))
-        {
+            break;
+        case SK_PATH_NAV_MAGNETIC_VARIATION:
             updateMagneticVariance(value, sfixtime);
-        } else {
-            //wxLogMessage(wxString::Format(_T("** Signal K unhandled update: %s"), update_path));
-#if 0
-            wxString dbg;
-            wxJSONWriter writer;
-            writer.Write(item, dbg);
-            wxString msg( _T("update: ") );
-            msg.append(dbg);
-            wxLogMessage(msg);
-#endif
-        }
-
+            break;
+        default:
+            //wxLogMessage(wxString::Format(_T("** Signal K unhandled update: %s"), item.m_path));
+            break;
     }
 }
 
-void SignalKEventHandler::updateNavigationPosition(wxJSONValue &value, const wxString &sfixtime) const {
-    if ((value.HasMember("latitude" && value["latitude"].IsDouble()))
-        && (value.HasMember("longitude") && value["longitude"].IsDouble())) {
+void SignalKEventHandler::updateNavigationPosition(const SignalKValue &value, const wxString &sfixtime) const {
+    const SignalKLeaf *lat = value.Find("latitude");
+    const SignalKLeaf *lon = value.Find("longitude");
+    if (lat && lat->IsNumber() && lon && lon->IsNumber()) {
         //wxLogMessage(_T(" ***** Position Update"));
-        m_frame->setPosition(value["latitude"].AsDouble(),
-                             value["longitude"].AsDouble());
+        m_frame->setPosition(lat->AsDouble(), lon->AsDouble());
         m_frame->PostProcessNMEA(true, false, sfixtime);
         bGPSValid_SK = true;
     }
@@ -164,7 +134,7 @@ void SignalKEventHandler::updateNavigationPosition(wxJSONValue &value, const wxS
     }
 }
 
-void SignalKEventHandler::updateNavigationSpeedOverGround(wxJSONValue &value,
+void SignalKEventHandler::updateNavigationSpeedOverGround(const SignalKValue &value,
                                                           const wxString &sfixtime) const {
     double sog_ms = value.AsDouble();
     double sog_knot = sog_ms * ms_to_knot_factor;
@@ -173,7 +143,7 @@ void SignalKEventHandler::updateNavigationSpeedOverGround(wxJSONValue &value,
     m_frame->PostProcessNMEA(false, true, sfixtime);
 }
 
-void SignalKEventHandler::updateNavigationCourseOverGround(wxJSONValue &value,
+void SignalKEventHandler::updateNavigationCourseOverGround(const SignalKValue &value,
                                                            const wxString &sfixtime) const {
     double cog_rad = value.AsDouble();
     double cog_deg = GEODESIC_RAD2DEG(cog_rad);
@@ -182,25 +152,25 @@ void SignalKEventHandler::updateNavigationCourseOverGround(wxJSONValue &value,
     m_frame->PostProcessNMEA(false, true, sfixtime);
 }
 
-void SignalKEventHandler::updateGnssSatellites(wxJSONValue &value,
+void SignalKEventHandler::updateGnssSatellites(const SignalKValue &value,
                                                const wxString &sfixtime) const
 {
     m_frame->setSatelitesInView(value.AsInt());
 }
 
-void SignalKEventHandler::updateHeadingTrue(wxJSONValue &value,
+void SignalKEventHandler::updateHeadingTrue(const SignalKValue &value,
                                             const wxString &sfixtime) const
 {
     m_frame->setHeadingTrue(GEODESIC_RAD2DEG(value.AsDouble()));
 }
 
-void SignalKEventHandler::updateHeadingMagnetic(wxJSONValue &value,
+void SignalKEventHandler::updateHeadingMagnetic(const SignalKValue &value,
                                             const wxString &sfixtime) const
 {
     m_frame->setHeadingMagnetic(GEODESIC_RAD2DEG(value.AsDouble()));
 }
 
-void SignalKEventHandler::updateMagneticVariance(wxJSONValue &value,
+void SignalKEventHandler::updateMagneticVariance(const SignalKValue &value,
                                                  const wxString &sfixtime) const
 {
     m_frame->setMagneticVariation(GEODESIC_RAD2DEG(value.AsDouble()));
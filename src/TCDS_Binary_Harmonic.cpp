@@ -21,6 +21,8 @@
  *   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,  USA.         *
  **************************************************************************/
 
+#include <map>
+
 #include "TCDS_Binary_Harmonic.h"
 #include "tcmgr.h"
 
@@ -377,11 +379,16 @@ TC_Error_Code TCDS_Binary_Harmonic::LoadData(const wxString &data_file_path)
     }
 
 
-    // now load and create the index
+    // now create the index.  Only the record headers, which libtcd keeps
+    // in memory, are used here.  The rest of each record, with the offsets
+    // and constituents, is read by LoadHarmonicData() on first use.
 
-    TIDE_RECORD *ptiderec = (TIDE_RECORD *)calloc(sizeof(TIDE_RECORD), 1);
+    m_data_file_path = data_file_path;
+
+    std::map<int, long> tz_bias;                // time zone bias by tzfile index
+    TIDE_STATION_HEADER header;
     for(unsigned int i=0 ; i < hdr.number_of_records ; i++) {
-        read_tide_record (i, ptiderec);
+        get_partial_tide_record (i, &header);
 
         num_IDX++; // Keep counting entries for harmonic file stuff
         IDX_entry *pIDX = new IDX_entry;
@@ -394,129 +401,37 @@ TC_Error_Code TCDS_Binary_Harmonic::LoadData(const wxString &data_file_path)
         pIDX->IDX_Useable = 1;                          // but assume data is OK
         pIDX->IDX_tzname = NULL;
 
-        pIDX->IDX_lon = ptiderec->header.longitude;
-        pIDX->IDX_lat = ptiderec->header.latitude;
-
-        const char *tz = get_tzfile (ptiderec->header.tzfile);
-        change_time_zone ((char *)tz);
-        if(tz_info)
-            pIDX->IDX_time_zone = -tz_info->tzi.Bias;
-
-
-        strncpy(pIDX->IDX_station_name, ptiderec->header.name, MAXNAMELEN);
-//        if(strstr(ptiderec->header.name, "Beaufort") != NULL)
-//            int yyp = 4;
-
-        pIDX->IDX_flood_dir = ptiderec->max_direction;
-        pIDX->IDX_ebb_dir = ptiderec->min_direction;
-
-        if(REFERENCE_STATION == ptiderec->header.record_type) {
-            //    Establish Station Type
-            wxString caplin(pIDX->IDX_station_name, wxConvUTF8);
-            caplin.MakeUpper();
-            if(caplin.Contains(_T("CURRENT")))
-                pIDX->IDX_type = 'C';
-            else
-                pIDX->IDX_type = 'T';
-
-            int t1 = ptiderec->zone_offset;
-            double zone_offset = (double)(t1 / 100) + ((double)(t1 % 100))/60.;
-//            pIDX->IDX_time_zone = t1a;
-
-            pIDX->IDX_ht_time_off = pIDX->IDX_lt_time_off = 0;
-            pIDX->IDX_ht_mpy      = pIDX->IDX_lt_mpy = 1.0;
-            pIDX->IDX_ht_off      = pIDX->IDX_lt_off = 0.0;
-            pIDX->IDX_ref_dbIndex = ptiderec->header.reference_station;         // will be -1
-
-            //  build a Station_Data class, and add to member array
-
-            Station_Data *psd = new Station_Data;
-
-            psd->amplitude = (double *)malloc(num_csts * sizeof(double));
-            psd->epoch     = (double *)malloc(num_csts * sizeof(double));
-            psd->station_name = (char *)malloc(ONELINER_LENGTH);
-
-            strncpy(psd->station_name, ptiderec->header.name, MAXNAMELEN);
-            psd->station_type = pIDX->IDX_type;
+        pIDX->IDX_lon = header.longitude;
+        pIDX->IDX_lat = header.latitude;
+        pIDX->IDX_dbIndex = i;
 
+        std::map<int, long>::iterator it = tz_bias.find(header.tzfile);
+        if(it == tz_bias.end()) {
+            change_time_zone (get_tzfile (header.tzfile));
+            it = tz_bias.insert(std::make_pair((int)header.tzfile, (long)tz_info->tzi.Bias)).first;
+        }
+        pIDX->IDX_time_zone = -it->second;
 
-            // Get meridian, which is seconds difference from UTC, not figuring DST, so that New York is always (-300 * 60)
-            psd->meridian =  -(tz_info->tzi.Bias * 60);
-            psd->zone_offset = zone_offset;
+        strncpy(pIDX->IDX_station_name, header.name, MAXNAMELEN);
 
-            // Get units
-            strncpy (psd->unit, get_level_units (ptiderec->level_units), 40 - 1);
-            psd->unit[40 -1] = '\0';
+        //  Offsets are neutral until the full record is read
+        pIDX->IDX_ht_time_off = pIDX->IDX_lt_time_off = 0;
+        pIDX->IDX_ht_mpy      = pIDX->IDX_lt_mpy = 1.0;
+        pIDX->IDX_ht_off      = pIDX->IDX_lt_off = 0.0;
+        pIDX->have_offsets = 0;
 
-            psd->have_BOGUS = (findunit(psd->unit) != -1) && (known_units[findunit(psd->unit)].type == BOGUS);
+        //    Establish Station Type
+        wxString caplin(pIDX->IDX_station_name, wxConvUTF8);
+        caplin.MakeUpper();
+        bool bcurrent = caplin.Contains(_T("CURRENT"));
 
-            int unit_c;
-            if (psd->have_BOGUS)
-                unit_c = findunit("knots");
-            else
-                unit_c = findunit(psd->unit);
-
-            if(unit_c != -1) {
-                strncpy (psd->units_conv, known_units[unit_c].name, sizeof(psd->units_conv)-1);
-                strncpy (psd->units_abbrv, known_units[unit_c].abbrv, sizeof(psd->units_abbrv)-1);
-            }
-            else {
-                strncpy (psd->units_conv, psd->unit, 40 - 1);
-                psd->units_conv[40 - 1] = '\0';
-                strncpy (psd->units_abbrv, psd->unit, 20 - 1);
-                psd->units_abbrv[20 - 1] = '\0';
-            }
-
-
-            // Get constituents
-            for (int a=0; a<num_csts; a++)
-            {
-                psd->amplitude[a] = ptiderec->amplitude[a];
-                psd->epoch[a] = ptiderec->epoch[a] * M_PI / 180.;
-            }
-
-            psd->DATUM = ptiderec->datum_offset;
-
-            m_msd_array.Add(psd);                     // add it to the member array
-            pIDX->pref_sta_data = psd;
+        if(REFERENCE_STATION == header.record_type) {
+            pIDX->IDX_type = bcurrent ? 'C' : 'T';
             pIDX->IDX_ref_dbIndex = i;
-            pIDX->have_offsets = 0;
         }
-        else if(SUBORDINATE_STATION == ptiderec->header.record_type) {
-            //    Establish Station Type
-            wxString caplin(pIDX->IDX_station_name, wxConvUTF8);
-            caplin.MakeUpper();
-            if(caplin.Contains(_T("CURRENT")))
-                pIDX->IDX_type = 'c';
-            else
-                pIDX->IDX_type = 't';
-
-            int t1 = ptiderec->max_time_add;
-            double t1a = (double)(t1 / 100) + ((double)(t1 % 100))/60.;
-            t1a *= 60;                  // Minutes
-            pIDX->IDX_ht_time_off = t1a;
-            pIDX->IDX_ht_mpy = ptiderec->max_level_multiply;
-            if(0. == pIDX->IDX_ht_mpy) pIDX->IDX_ht_mpy = 1.0;
-            pIDX->IDX_ht_off = ptiderec->max_level_add;
-
-
-            t1 = ptiderec->min_time_add;
-            t1a = (double)(t1 / 100) + ((double)(t1 % 100))/60.;
-            t1a *= 60;                  // Minutes
-            pIDX->IDX_lt_time_off = t1a;
-            pIDX->IDX_lt_mpy = ptiderec->min_level_multiply;
-            if(0. == pIDX->IDX_lt_mpy) pIDX->IDX_lt_mpy = 1.0;
-            pIDX->IDX_lt_off = ptiderec->min_level_add;
-
-            pIDX->IDX_ref_dbIndex = ptiderec->header.reference_station;
-//           strncpy(pIDX->IDX_reference_name, ptiderec->header.name, MAXNAMELEN);
-
-            if( pIDX->IDX_ht_time_off ||
-                    pIDX->IDX_ht_off != 0.0 ||
-                    pIDX->IDX_lt_off != 0.0 ||
-                    pIDX->IDX_ht_mpy != 1.0 ||
-                    pIDX->IDX_lt_mpy != 1.0)
-                pIDX->have_offsets = 1;
+        else if(SUBORDINATE_STATION == header.record_type) {
+            pIDX->IDX_type = bcurrent ? 'c' : 't';
+            pIDX->IDX_ref_dbIndex = header.reference_station;
         }
 
         m_IDX_array.Add(pIDX);
@@ -539,7 +454,6 @@ TC_Error_Code TCDS_Binary_Harmonic::LoadData(const wxString &data_file_path)
             pIDX->m_work_buffer = m_work_buffer;
         }
     }
-    free( ptiderec );
 
     return TC_NO_ERROR;
 }
@@ -555,15 +469,33 @@ TC_Error_Code TCDS_Binary_Harmonic::LoadHarmonicData(IDX_entry *pIDX)
 {
     // Find the indicated Master station
     if(!strlen(pIDX->IDX_reference_name)) {
+        if((pIDX->IDX_ref_dbIndex < 0) || (pIDX->IDX_ref_dbIndex >= num_IDX)) {
+            pIDX->IDX_Useable = 0;
+            return TC_MASTER_HARMONICS_NOT_FOUND;
+        }
+
+        //  libtcd has only one database open at a time, make sure it is ours
+        if(!open_tide_db (m_data_file_path.mb_str())) {
+            pIDX->IDX_Useable = 0;
+            return TC_TCD_FILE_CORRUPT;
+        }
+
+        IDX_entry *pIDX_Ref = &m_IDX_array.Item(pIDX->IDX_ref_dbIndex);
+        if(!pIDX_Ref->pref_sta_data && !ReadStationRecord(pIDX_Ref)) {
+            pIDX_Ref->IDX_Useable = 0;
+            pIDX->IDX_Useable = 0;
+            return TC_TCD_FILE_CORRUPT;
+        }
+
+        if((pIDX != pIDX_Ref) && !ReadStationRecord(pIDX)) {
+            pIDX->IDX_Useable = 0;
+            return TC_TCD_FILE_CORRUPT;
+        }
+
         strncpy(pIDX->IDX_reference_name, get_station (pIDX->IDX_ref_dbIndex),
                 MAXNAMELEN - 1 );
         pIDX->IDX_reference_name[MAXNAMELEN - 1] = '\0';
 
-//        TIDE_RECORD *ptiderec = (TIDE_RECORD *)calloc(sizeof(TIDE_RECORD), 1);
-//        read_tide_record (pIDX->IDX_ref_dbIndex, ptiderec);
-//        free( ptiderec );
-
-        IDX_entry *pIDX_Ref = &m_IDX_array.Item(pIDX->IDX_ref_dbIndex);
         Station_Data *pRefSta = pIDX_Ref->pref_sta_data;
         pIDX->pref_sta_data = pRefSta;
         pIDX->station_tz_offset = -pRefSta->meridian + (pRefSta->zone_offset * 3600);
@@ -571,4 +503,104 @@ TC_Error_Code TCDS_Binary_Harmonic::LoadHarmonicData(IDX_entry *pIDX)
     return TC_NO_ERROR;
 }
 
+//  Read the full tide record of a station from the open database.
+//  Reference stations get their Station_Data, subordinate stations their offsets.
+bool TCDS_Binary_Harmonic::ReadStationRecord(IDX_entry *pIDX)
+{
+    TIDE_RECORD *ptiderec = (TIDE_RECORD *)calloc(sizeof(TIDE_RECORD), 1);
+    if(read_tide_record (pIDX->IDX_dbIndex, ptiderec) < 0) {
+        free( ptiderec );
+        return false;
+    }
+
+    pIDX->IDX_flood_dir = ptiderec->max_direction;
+    pIDX->IDX_ebb_dir = ptiderec->min_direction;
+
+    if(REFERENCE_STATION == ptiderec->header.record_type) {
+        int t1 = ptiderec->zone_offset;
+        double zone_offset = (double)(t1 / 100) + ((double)(t1 % 100))/60.;
+
+        const char *tz = get_tzfile (ptiderec->header.tzfile);
+        change_time_zone ((char *)tz);
+
+        //  build a Station_Data class, and add to member array
+
+        Station_Data *psd = new Station_Data;
+
+        psd->amplitude = (double *)malloc(num_csts * sizeof(double));
+        psd->epoch     = (double *)malloc(num_csts * sizeof(double));
+        psd->station_name = (char *)malloc(ONELINER_LENGTH);
+
+        strncpy(psd->station_name, ptiderec->header.name, MAXNAMELEN);
+        psd->station_type = pIDX->IDX_type;
+
+
+        // Get meridian, which is seconds difference from UTC, not figuring DST, so that New York is always (-300 * 60)
+        psd->meridian =  -(tz_info->tzi.Bias * 60);
+        psd->zone_offset = zone_offset;
+
+        // Get units
+        strncpy (psd->unit, get_level_units (ptiderec->level_units), 40 - 1);
+        psd->unit[40 -1] = '\0';
 
+        psd->have_BOGUS = (findunit(psd->unit) != -1) && (known_units[findunit(psd->unit)].type == BOGUS);
+
+        int unit_c;
+        if (psd->have_BOGUS)
+            unit_c = findunit("knots");
+        else
+            unit_c = findunit(psd->unit);
+
+        if(unit_c != -1) {
+            strncpy (psd->units_conv, known_units[unit_c].name, sizeof(psd->units_conv)-1);
+            strncpy (psd->units_abbrv, known_units[unit_c].abbrv, sizeof(psd->units_abbrv)-1);
+        }
+        else {
+            strncpy (psd->units_conv, psd->unit, 40 - 1);
+            psd->units_conv[40 - 1] = '\0';
+            strncpy (psd->units_abbrv, psd->unit, 20 - 1);
+            psd->units_abbrv[20 - 1] = '\0';
+        }
+
+
+        // Get constituents
+        for (int a=0; a<num_csts; a++)
+        {
+            psd->amplitude[a] = ptiderec->amplitude[a];
+            psd->epoch[a] = ptiderec->epoch[a] * M_PI / 180.;
+        }
+
+        psd->DATUM = ptiderec->datum_offset;
+
+        m_msd_array.Add(psd);                     // add it to the member array
+        pIDX->pref_sta_data = psd;
+    }
+    else if(SUBORDINATE_STATION == ptiderec->header.record_type) {
+        int t1 = ptiderec->max_time_add;
+        double t1a = (double)(t1 / 100) + ((double)(t1 % 100))/60.;
+        t1a *= 60;                  // Minutes
+        pIDX->IDX_ht_time_off = t1a;
+        pIDX->IDX_ht_mpy = ptiderec->max_level_multiply;
+        if(0. == pIDX->IDX_ht_mpy) pIDX->IDX_ht_mpy = 1.0;
+        pIDX->IDX_ht_off = ptiderec->max_level_add;
+
+
+        t1 = ptiderec->min_time_add;
+        t1a = (double)(t1 / 100) + ((double)(t1 % 100))/60.;
+        t1a *= 60;                  // Minutes
+        pIDX->IDX_lt_time_off = t1a;
+        pIDX->IDX_lt_mpy = ptiderec->min_level_multiply;
+        if(0. == pIDX->IDX_lt_mpy) pIDX->IDX_lt_mpy = 1.0;
+        pIDX->IDX_lt_off = ptiderec->min_level_add;
+
+        if( pIDX->IDX_ht_time_off ||
+                pIDX->IDX_ht_off != 0.0 ||
+                pIDX->IDX_lt_off != 0.0 ||
+                pIDX->IDX_ht_mpy != 1.0 ||
+                pIDX->IDX_lt_mpy != 1.0)
+            pIDX->have_offsets = 1;
+    }
+
+    free( ptiderec );
+    return true;
+}
@@ -87,6 +87,10 @@ TCWin::TCWin( ChartCanvas *parent, int x, int y, void *pvIDX )
     pIDX = (IDX_entry *) pvIDX;
     gpIDXn++;
 
+    //  Station details such as the reference station name are loaded on first use
+    if( pIDX->pDataSource )
+        pIDX->pDataSource->LoadHarmonicData( pIDX );
+
 //    Set up plot type
     if( strchr( "Tt", pIDX->IDX_type ) ) {
         m_plot_type = TIDE_PLOT;
@@ -532,54 +536,55 @@ void TCWin::OnPaint( wxPaintEvent& event )
             float dir;
             tcmax = -10;
             tcmin = 10;
-            float val;
             m_tList->DeleteAllItems();
             int list_index = 0;
-            bool wt;
 
             wxBeginBusyCursor();
 
-            // get tide flow sens ( flood or ebb ? )
-            ptcmgr->GetTideFlowSens( m_t_graphday_00_at_station, BACKWARD_ONE_HOUR_STEP,
-                                     pIDX->IDX_rec_num, tcv[0], val, wt );
+            //  HW and LW list
+            std::vector<TC_Event> events;
+            if( TIDE_PLOT == m_plot_type )
+                ptcmgr->GetTideEvents( pIDX->IDX_rec_num, m_t_graphday_00_at_station + 1,
+                                       m_t_graphday_00_at_station + 25 * FORWARD_ONE_HOUR_STEP + 1, events );
+
+            for( size_t j = 0; j < events.size(); j++ ) {
+                bool wt = ( TC_EVENT_BIT( events[j].type ) & TC_EVENT_HIGHS ) != 0;
+                wxDateTime tcd;                                                 //write date
+                wxString s, s1;
+                tcd.Set( events[j].t + ( m_corr_mins * 60 ) );
+                s.Printf( tcd.Format( _T("%H:%M  ") ) );
+                s1.Printf( _T("%05.2f "), events[j].value );                   //write value
+                s.Append( s1 );
+                Station_Data *pmsd = pIDX->pref_sta_data;                       //write unit
+                if( pmsd ) s.Append( wxString( pmsd->units_abbrv, wxConvUTF8 ) );
+                s.Append( _T("   ") );
+                ( wt ) ? s.Append( _("HW") ) : s.Append( _("LW") );         //write HW or LT
+
+                wxListItem li;
+                li.SetId( list_index );
+                li.SetAlign(wxLIST_FORMAT_LEFT);
+                li.SetText(s);
+                li.SetColumn(0);
+                m_tList->InsertItem( li );
+                list_index++;
+            }
+
+            std::vector<float> series_val, series_dir;
+            bool b_series = ptcmgr->GetTideOrCurrentSeries( m_t_graphday_00_at_station, FORWARD_ONE_HOUR_STEP, 26,
+                                                            pIDX->IDX_rec_num, series_val, series_dir );
 
             for( i = 0; i < 26; i++ ) {
                 int tt = m_t_graphday_00_at_station + ( i * FORWARD_ONE_HOUR_STEP );
-                ptcmgr->GetTideOrCurrent( tt, pIDX->IDX_rec_num, tcv[i], dir );
+                if( b_series ) {
+                    tcv[i] = series_val[i];
+                    dir = series_dir[i];
+                }
+                else
+                    ptcmgr->GetTideOrCurrent( tt, pIDX->IDX_rec_num, tcv[i], dir );
                 tt_tcv[i] = tt;                         // store the corresponding time_t value
                 if( tcv[i] > tcmax ) tcmax = tcv[i];
 
                 if( tcv[i] < tcmin ) tcmin = tcv[i];
-                if( TIDE_PLOT == m_plot_type ) {
-                    if( !( ( tcv[i] > val ) == wt ) )                // if tide flow sens change
-                    {
-                        float tcvalue;                                  //look backward for HW or LW
-                        time_t tctime;
-                        ptcmgr->GetHightOrLowTide( tt, BACKWARD_TEN_MINUTES_STEP,
-                                                   BACKWARD_ONE_MINUTES_STEP, tcv[i], wt, pIDX->IDX_rec_num, tcvalue,
-                                                   tctime );
-                        wxDateTime tcd;                                                 //write date
-                        wxString s, s1;
-                        tcd.Set( tctime + ( m_corr_mins * 60 ) );
-                        s.Printf( tcd.Format( _T("%H:%M  ") ) );
-                        s1.Printf( _T("%05.2f "), tcvalue );                           //write value
-                        s.Append( s1 );
-                        Station_Data *pmsd = pIDX->pref_sta_data;                       //write unit
-                        if( pmsd ) s.Append( wxString( pmsd->units_abbrv, wxConvUTF8 ) );
-                        s.Append( _T("   ") );
-                        ( wt ) ? s.Append( _("HW") ) : s.Append( _("LW") );         //write HW or LT
-
-                        wxListItem li;
-                        li.SetId( list_index );
-                        li.SetAlign(wxLIST_FORMAT_LEFT);
-                        li.SetText(s);
-                        li.SetColumn(0);
-                        m_tList->InsertItem( li );
-                        list_index++;
-                        wt = !wt;                                            //change tide flow sens
-                    }
-                    val = tcv[i];
-                }
                 if( CURRENT_PLOT == m_plot_type ) {
                     wxDateTime thx;                                                     //write date
                     wxString s, s1;
@@ -24,6 +24,7 @@
  **************************************************************************/
 
 #include <wx/wx.h>
+#include <math.h>
 
 #include "TexFont.h"
 
@@ -208,6 +209,8 @@ void TexFont::Build( wxFont &font, bool blur )
 
 void TexFont::Delete( )
 {
+    m_batch.Clear();
+
     if (texobj) {
         glDeleteTextures(1, &texobj);
         texobj = 0;
@@ -438,4 +441,110 @@ void TexFont::RenderString( const wxString &string, int x, int y )
     RenderString((const char*)string.ToUTF8(), x, y);
 }
 
+void TexFont::AddStringToBatch( const wxString &string, float x, float y, float angle, const wxColour &color )
+{
+    wxCharBuffer buf = string.ToUTF8();
+    const char *str = buf.data();
+
+    float c = cosf( angle ), s = sinf( angle );
+    float w = m_maxglyphw, h = m_maxglyphh;
+    float gx = 0, gy = 0;               // glyph origin within the string
+
+    m_batch.SetTexture( texobj );
+
+    for( int i = 0; str[i]; i++ ) {
+        int ch = (unsigned char)str[i];
+        if( ch == '\n' ) {
+            gx = 0;
+            gy += tgi[(int)'A'].height;
+            continue;
+        }
+        /* degree symbol */
+        if( ch == 0xc2 && (unsigned char)str[i+1] == 0xb0 ) {
+            ch = DEGREE_GLYPH;
+            i++;
+        }
+        if( ch < MIN_GLYPH || ch >= MAX_GLYPH )
+            continue;
+
+        TexGlyphInfo &tgic = tgi[ch];
+
+        float tx1 = (float)tgic.x / (float)tex_w;
+        float tx2 = (float)(tgic.x + w) / (float)tex_w;
+        float ty1 = (float)tgic.y / (float)tex_h;
+        float ty2 = (float)(tgic.y + h) / (float)tex_h;
+
+        m_batch.AddQuad( x, y, c, s, gx, gy, gx + w, gy + h, tx1, ty1, tx2, ty2, color );
+
+        gx += tgic.advance;
+    }
+}
+
+void TexFont::FlushBatch()
+{
+    m_batch.Flush();
+}
+
+void TexQuadBatch::SetTexture( unsigned int texture )
+{
+    if( texture != m_texture ) {
+        Flush();
+        m_texture = texture;
+    }
+}
+
+void TexQuadBatch::AddQuad( float x, float y, float c, float s,
+                            float x1, float y1, float x2, float y2,
+                            float tx1, float ty1, float tx2, float ty2, const wxColour &color )
+{
+    TexQuadVertex vtx;
+    vtx.color[0] = color.Red();
+    vtx.color[1] = color.Green();
+    vtx.color[2] = color.Blue();
+    vtx.color[3] = 255;
+
+    const float qx[4] = { x1, x2, x2, x1 };
+    const float qy[4] = { y1, y1, y2, y2 };
+    const float qu[4] = { tx1, tx2, tx2, tx1 };
+    const float qv[4] = { ty1, ty1, ty2, ty2 };
+    for( int j = 0; j < 4; j++ ) {
+        vtx.x = x + qx[j] * c - qy[j] * s;
+        vtx.y = y + qx[j] * s + qy[j] * c;
+        vtx.u = qu[j];
+        vtx.v = qv[j];
+        m_quads.push_back( vtx );
+    }
+}
+
+void TexQuadBatch::Flush()
+{
+    if( m_quads.empty() )
+        return;
+
+#ifndef USE_ANDROID_GLES2
+    glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+
+    glEnable( GL_BLEND );
+    glEnable( GL_TEXTURE_2D );
+    glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+    glBindTexture( GL_TEXTURE_2D, m_texture );
+
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+    glEnableClientState( GL_COLOR_ARRAY );
+    glVertexPointer( 2, GL_FLOAT, sizeof(TexQuadVertex), &m_quads[0].x );
+    glTexCoordPointer( 2, GL_FLOAT, sizeof(TexQuadVertex), &m_quads[0].u );
+    glColorPointer( 4, GL_UNSIGNED_BYTE, sizeof(TexQuadVertex), m_quads[0].color );
+
+    glDrawArrays( GL_QUADS, 0, m_quads.size() );
+
+    glDisable( GL_TEXTURE_2D );
+    glDisable( GL_BLEND );
+
+    glPopClientAttrib();
+#endif
+
+    m_quads.clear();
+}
+
 //#endif     //#ifdef ocpnUSE_GL
@@ -87,6 +87,10 @@ millions of points.
 
 #include "pluginmanager.h"
 
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
 #ifdef ocpnUSE_GL
 #include "glChartCanvas.h"
 extern ocpnGLOptions g_GLOptions;
@@ -128,58 +132,235 @@ private:
 #include <wx/listimpl.cpp>
 WX_DEFINE_LIST ( TrackList );
 
+//------------------------------------------------------------------------------
+//    TrackPoint allocation pool
+//
+//    Blocks are carved from large chunks and recycled through a free list.
+//    Chunks are never returned, the same points are typically reallocated
+//    by the next track loaded or logged. Tracks may be built on loader
+//    threads, hence the lock.
+//------------------------------------------------------------------------------
+
+#define TRACKPOINT_POOL_CHUNK   4096
+
+class TrackPointPool
+{
+public:
+    TrackPointPool() : m_free( NULL ) {}
+
+    void *Alloc()
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        if( !m_free ) {
+            char *chunk = (char *) malloc( TRACKPOINT_POOL_CHUNK * sizeof( TrackPoint ) );
+            if( !chunk )
+                throw std::bad_alloc();
+            for( int i = TRACKPOINT_POOL_CHUNK - 1; i >= 0; i-- ) {
+                void **block = (void **) ( chunk + i * sizeof( TrackPoint ) );
+                *block = m_free;
+                m_free = block;
+            }
+        }
+        void **block = (void **) m_free;
+        m_free = *block;
+        return block;
+    }
+
+    void Free( void *p )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        *(void **) p = m_free;
+        m_free = p;
+    }
+
+private:
+    std::mutex          m_mutex;
+    void                *m_free;
+};
+
+static TrackPointPool s_TrackPointPool;
+
+//    Time strings that don't fit TrackPoint::m_time
+static std::mutex s_TimeStringMutex;
+static std::unordered_map<const TrackPoint *, wxString> s_TimeStrings;
+
+void *TrackPoint::operator new( size_t size )
+{
+    if( size != sizeof( TrackPoint ) )
+        return ::operator new( size );
+    return s_TrackPointPool.Alloc();
+}
+
+void TrackPoint::operator delete( void *p, size_t size )
+{
+    if( !p )
+        return;
+    if( size != sizeof( TrackPoint ) )
+        ::operator delete( p );
+    else
+        s_TrackPointPool.Free( p );
+}
+
+//    Day number of a civil date, days since 1970-01-01
+static int64_t DaysFromCivil( int y, int m, int d )
+{
+    y -= m <= 2;
+    const int64_t era = ( y >= 0 ? y : y - 399 ) / 400;
+    const int yoe = y - era * 400;
+    const int doy = ( 153 * ( m + ( m > 2 ? -3 : 9 ) ) + 2 ) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void CivilFromDays( int64_t z, int &y, int &m, int &d )
+{
+    z += 719468;
+    const int64_t era = ( z >= 0 ? z : z - 146096 ) / 146097;
+    const int doe = (int) ( z - era * 146097 );
+    const int yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+    const int doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+    const int mp = ( 5 * doy + 2 ) / 153;
+    d = doy - ( 153 * mp + 2 ) / 5 + 1;
+    m = mp + ( mp < 10 ? 3 : -9 );
+    y = (int) ( yoe + era * 400 ) + ( m <= 2 );
+}
+
+static bool EncodeTrackPointTime( int y, int mo, int d, int h, int mi, int s, uint32_t &t )
+{
+    static const int mdays[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+    if( y < 1970 || y > 2105 || mo < 1 || mo > 12 || d < 1 || d > mdays[mo - 1] )
+        return false;
+    if( mo == 2 && d == 29 && ( ( y % 4 ) || ( !( y % 100 ) && ( y % 400 ) ) ) )
+        return false;
+    if( h > 23 || mi > 59 || s > 59 )
+        return false;
+
+    int64_t secs = DaysFromCivil( y, mo, d ) * 86400 + h * 3600 + mi * 60 + s;
+    if( secs >= TRACKPOINT_TIME_STRING )
+        return false;
+    t = (uint32_t) secs;
+    return true;
+}
+
+//    Exactly "YYYY-MM-DDThh:mm:ssZ", the form OpenCPN writes
+static bool ParseTrackPointTime( const wxString &ts, uint32_t &t )
+{
+    if( ts.Length() != 20 )
+        return false;
+
+    static const char pattern[] = "dddd-dd-ddTdd:dd:ddZ";
+    int v[14], nv = 0;
+    for( int i = 0; i < 20; i++ ) {
+        wxChar c = ts[i];
+        if( pattern[i] == 'd' ) {
+            if( c < '0' || c > '9' )
+                return false;
+            v[nv++] = c - '0';
+        }
+        else if( c != (wxChar) pattern[i] )
+            return false;
+    }
+
+    return EncodeTrackPointTime( v[0] * 1000 + v[1] * 100 + v[2] * 10 + v[3],
+                                 v[4] * 10 + v[5], v[6] * 10 + v[7],
+                                 v[8] * 10 + v[9], v[10] * 10 + v[11], v[12] * 10 + v[13], t );
+}
+
 TrackPoint::TrackPoint(double lat, double lon, wxString ts)
-    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1), m_timestring(NULL)
+    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1), m_time(TRACKPOINT_NO_TIME)
 {
     SetCreateTime(ts);
 }
 
 TrackPoint::TrackPoint(double lat, double lon, wxDateTime dt)
-    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1), m_timestring(NULL)
+    : m_lat(lat), m_lon(lon), m_GPXTrkSegNo(1), m_time(TRACKPOINT_NO_TIME)
 {
     SetCreateTime(dt);
 }
 
 // Copy Constructor
 TrackPoint::TrackPoint( TrackPoint* orig )
-    : m_lat(orig->m_lat), m_lon(orig->m_lon), m_GPXTrkSegNo(1), m_timestring(NULL)
+    : m_lat(orig->m_lat), m_lon(orig->m_lon), m_GPXTrkSegNo(1), m_time(TRACKPOINT_NO_TIME)
 {
-    SetCreateTime(orig->GetCreateTime());
+    if( orig->m_time == TRACKPOINT_TIME_STRING )
+        SetCreateTime(orig->GetCreateTime());
+    else
+        m_time = orig->m_time;
 }
 
 TrackPoint::~TrackPoint()
 {
-    delete [] m_timestring;
+    ClearTimeString();
+}
+
+void TrackPoint::ClearTimeString()
+{
+    if( m_time == TRACKPOINT_TIME_STRING ) {
+        std::lock_guard<std::mutex> lock( s_TimeStringMutex );
+        s_TimeStrings.erase( this );
+    }
+    m_time = TRACKPOINT_NO_TIME;
 }
 
 wxDateTime TrackPoint::GetCreateTime()
 {
     wxDateTime CreateTimeX;
     
-    if(m_timestring) {
-        wxString ts = m_timestring;
+    if( m_time == TRACKPOINT_TIME_STRING ) {
+        wxString ts = GetTimeString();
         ParseGPXDateTime( CreateTimeX, ts );
     }
+    else if( m_time != TRACKPOINT_NO_TIME ) {
+        //  As ParseGPXDateTime() would build it from the string
+        int y, mo, d;
+        CivilFromDays( m_time / 86400, y, mo, d );
+        uint32_t secs = m_time % 86400;
+        CreateTimeX.Set( d, (wxDateTime::Month) ( mo - 1 ), y, secs / 3600, ( secs / 60 ) % 60, secs % 60 );
+    }
     return CreateTimeX;
 }
 
+wxString TrackPoint::GetTimeString() const
+{
+    if( m_time == TRACKPOINT_NO_TIME )
+        return wxEmptyString;
+
+    if( m_time == TRACKPOINT_TIME_STRING ) {
+        std::lock_guard<std::mutex> lock( s_TimeStringMutex );
+        return s_TimeStrings[this];
+    }
+
+    int y, mo, d;
+    CivilFromDays( m_time / 86400, y, mo, d );
+    uint32_t secs = m_time % 86400;
+    return wxString::Format( _T("%04d-%02d-%02dT%02d:%02d:%02dZ"), y, mo, d,
+                             secs / 3600, ( secs / 60 ) % 60, secs % 60 );
+}
+
 void TrackPoint::SetCreateTime( wxDateTime dt )
 {
-    wxString ts;
-    if(dt.IsValid())
-        ts = dt.FormatISODate().Append(_T("T")).Append(dt.FormatISOTime()).Append(_T("Z"));
+    ClearTimeString();
+    if( !dt.IsValid() )
+        return;
 
-    SetCreateTime(ts);
+    //  The fields FormatISODate()/FormatISOTime() would write
+    wxDateTime::Tm tm = dt.GetTm();
+    if( EncodeTrackPointTime( tm.year, tm.mon + 1, tm.mday, tm.hour, tm.min, tm.sec, m_time ) )
+        return;
+
+    SetCreateTime( dt.FormatISODate().Append(_T("T")).Append(dt.FormatISOTime()).Append(_T("Z")) );
 }
 
 void TrackPoint::SetCreateTime( wxString ts )
 {
-    delete [] m_timestring;
-    if(ts.Length()) {
-        m_timestring = new char[ts.Length()+1];
-        strcpy(m_timestring, ts.mb_str());
-    } else
-        m_timestring = NULL;
+    ClearTimeString();
+    if( !ts.Length() || ParseTrackPointTime( ts, m_time ) )
+        return;
+
+    std::lock_guard<std::mutex> lock( s_TimeStringMutex );
+    s_TimeStrings[this] = ts;
+    m_time = TRACKPOINT_TIME_STRING;
 }
 
 void TrackPoint::Draw(ChartCanvas *cc, ocpnDC& dc )
@@ -224,6 +405,11 @@ double _distance( vector2D& a, vector2D& b ) { return sqrt( _distance2( a, b ) )
 double _magnitude2( vector2D& a ) { return a.x*a.x + a.y*a.y; }
 
 Track::Track()
+    : Track( true )
+{
+}
+
+Track::Track( bool b_create_guid )
 {
     m_bVisible = true;
     m_bListed = true;
@@ -231,12 +417,16 @@ Track::Track()
     m_width = WIDTH_UNDEFINED;
     m_style = wxPENSTYLE_INVALID;
 
-    m_GUID = pWayPointMan->CreateGUID( NULL );
+    if( b_create_guid )
+        m_GUID = pWayPointMan->CreateGUID( NULL );
     m_bIsInLayer = false;
     m_btemp = false;
 
     m_HyperlinkList = new HyperlinkList;
     m_HighlightedTrackPoint = -1;
+
+    m_lod_scale = 0;
+    m_blod_valid = false;
 }
 
 Track::~Track( void )
@@ -519,6 +709,7 @@ void ActiveTrack::AddPointNow( bool do_add_point )
                         TrackPoints.pop_back();
                         TrackPoints.pop_back();
                         TrackPoints.push_back( m_lastStoredTP );
+                        InvalidateLOD();
                         pSelect->DeletePointSelectableTrackSegments( m_removeTP );
                         pSelect->AddSelectableTrackSegment( m_fixedTP->m_lat, m_fixedTP->m_lon,
                                 m_lastStoredTP->m_lat, m_lastStoredTP->m_lon,
@@ -547,34 +738,36 @@ void ActiveTrack::AddPointNow( bool do_add_point )
     m_prev_time = now;
 }
 
-void Track::AddPointToList(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists, int n)
+void Track::AddPointToList(ChartCanvas *cc, int n)
 {
     wxPoint r(INVALID_COORD, INVALID_COORD);
     if ( (size_t)n < TrackPoints.size() )
         cc->GetCanvasPointPix( TrackPoints[n]->m_lat, TrackPoints[n]->m_lon, &r );
 
-    std::list<wxPoint> &pointlist = pointlists.back();
     if(r.x == INVALID_COORD) {
-        if(pointlist.size()) {
-            std::list<wxPoint> new_list;
-            pointlists.push_back(new_list);
-        }
+        BreakStrip();
         return;
     }
 
-    if(pointlist.size() == 0)
-        pointlist.push_back(r);
-    else {
-        wxPoint l = pointlist.back();
+    if(m_draw_points.size() > m_draw_strips.back()) {
+        wxPoint &l = m_draw_points.back();
         // ensure the segment is at least 2 pixels
-        if((abs(r.x - l.x) > 1) || (abs(r.y - l.y) > 1))
-            pointlist.push_back(r);
+        if((abs(r.x - l.x) <= 1) && (abs(r.y - l.y) <= 1))
+            return;
     }
+    m_draw_points.push_back(r);
+}
+
+// start a new line strip, unless the current one is still empty
+void Track::BreakStrip()
+{
+    if(m_draw_points.size() > m_draw_strips.back())
+        m_draw_strips.push_back(m_draw_points.size());
 }
 
-/* assembles lists of line strips from the given track recursively traversing
-   the subtracks data */
-void Track::Assemble(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists, const LLBBox &box, double scale, int &last, int level, int pos)
+/* assembles the indices of line strips from the given track recursively
+   traversing the subtracks data */
+void Track::Assemble(std::vector<int> &indices, const LLBBox &box, double scale, int &last, int level, int pos)
 {
     if(pos == (int)SubTracks[level].size())
         return;
@@ -586,29 +779,50 @@ void Track::Assemble(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlist
     if(s.m_scale < scale) {
         pos <<= level;
 
-        if(last < pos - 1) {
-            std::list<wxPoint> new_list;
-            pointlists.push_back(new_list);
-        }
+        if(last < pos - 1)
+            indices.push_back(-1);
 
         if(last < pos)
-            AddPointToList(cc, pointlists, pos);
+            indices.push_back(pos);
         last = wxMin(pos + (1<<level), TrackPoints.size() - 1);
-        AddPointToList(cc, pointlists, last);
+        indices.push_back(last);
     } else {
-        Assemble(cc, pointlists, box, scale, last, level-1, pos<<1);
-        Assemble(cc, pointlists, box, scale, last, level-1, (pos<<1)+1);
+        Assemble(indices, box, scale, last, level-1, pos<<1);
+        Assemble(indices, box, scale, last, level-1, (pos<<1)+1);
     }
 }
 
+static bool SameBox(const LLBBox &a, const LLBBox &b)
+{
+    return a.GetMinLat() == b.GetMinLat() && a.GetMaxLat() == b.GetMaxLat() &&
+           a.GetMinLon() == b.GetMinLon() && a.GetMaxLon() == b.GetMaxLon();
+}
+
 // Entry to recursive Assemble at the head of the SubTracks tree
-void Track::Segments(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists, const LLBBox &box, double scale)
+// The assembled indices only depend on the view box and scale, so they are
+// kept until either changes or the track is modified.  Only the projection
+// to canvas pixels is redone every frame.
+void Track::Segments(ChartCanvas *cc, const LLBBox &box, double scale)
 {
     if(!SubTracks.size())
         return;
 
-    int level = SubTracks.size()-1, last = -2;
-    Assemble(cc, pointlists, box, 1/scale/scale, last, level, 0);
+    if(!m_blod_valid || scale != m_lod_scale || !SameBox(box, m_lod_box)) {
+        m_lod_indices.clear();
+        int level = SubTracks.size()-1, last = -2;
+        Assemble(m_lod_indices, box, 1/scale/scale, last, level, 0);
+
+        m_lod_box = box;
+        m_lod_scale = scale;
+        m_blod_valid = true;
+    }
+
+    for(size_t i = 0; i < m_lod_indices.size(); i++) {
+        if(m_lod_indices[i] < 0)
+            BreakStrip();
+        else
+            AddPointToList(cc, m_lod_indices[i]);
+    }
 }
 
 void Track::ClearHighlights()
@@ -618,11 +832,14 @@ void Track::ClearHighlights()
 
 void Track::Draw( ChartCanvas *cc, ocpnDC& dc, ViewPort &VP, const LLBBox &box )
 {
-    std::list< std::list<wxPoint> > pointlists;
-    GetPointLists(cc, pointlists, VP, box);
+    m_draw_points.clear();
+    m_draw_strips.clear();
+    m_draw_strips.push_back(0);
+    GetPointLists(cc, VP, box);
 
-    if(!pointlists.size())
+    if(!m_draw_points.size())
         return;
+    m_draw_strips.push_back(m_draw_points.size());      // end of the last strip
 
     //  Establish basic colour
     wxColour basic_colour;
@@ -665,16 +882,11 @@ void Track::Draw( ChartCanvas *cc, ocpnDC& dc, ViewPort &VP, const LLBBox &box )
     {
         dc.SetPen( *wxThePenList->FindOrCreatePen( col, width, style ) );
         dc.SetBrush( *wxTheBrushList->FindOrCreateBrush( col, wxBRUSHSTYLE_SOLID ) );
-        for(std::list< std::list<wxPoint> >::iterator lines = pointlists.begin();
-        lines != pointlists.end(); lines++) {
-            // convert from linked list to array
-            wxPoint *points = new wxPoint[lines->size()];
-            int i = 0;
-            for(std::list<wxPoint>::iterator line = lines->begin();
-                line != lines->end(); line++) {
-                points[i] = *line;
-                i++;
-            }
+        for(size_t strip = 0; strip + 1 < m_draw_strips.size(); strip++) {
+            wxPoint *points = &m_draw_points[m_draw_strips[strip]];
+            int i = m_draw_strips[strip + 1] - m_draw_strips[strip];
+            if(i < 2)
+                continue;
 
             int hilite_width = radius;
             if( hilite_width >= 1.0 ) {
@@ -693,8 +905,6 @@ void Track::Draw( ChartCanvas *cc, ocpnDC& dc, ViewPort &VP, const LLBBox &box )
                 dc.SetPen( psave );
             } else
                 dc.StrokeLines( i, points );
-
-            delete [] points;
         }
     }
 #ifdef ocpnUSE_GL    
@@ -706,33 +916,17 @@ void Track::Draw( ChartCanvas *cc, ocpnDC& dc, ViewPort &VP, const LLBBox &box )
             glEnable( GL_LINE_SMOOTH );
         glEnable( GL_BLEND );
         
-        int size = 0;
-        // convert from linked list to array, allocate array just once
-        for(std::list< std::list<wxPoint> >::iterator lines = pointlists.begin();
-            lines != pointlists.end(); lines++)
-            size = wxMax(size, lines->size());
-        int *points = new int[2*size];
-        glVertexPointer(2, GL_INT, 0, points);
+        // wxPoint is a pair of ints, so the strips are drawn straight from the buffer
+        glVertexPointer(2, GL_INT, sizeof(wxPoint), &m_draw_points[0]);
 
         glEnableClientState(GL_VERTEX_ARRAY);
-        for(std::list< std::list<wxPoint> >::iterator lines = pointlists.begin();
-            lines != pointlists.end(); lines++) {
-
-            // convert from linked list to array
-            int i = 0;
-            for(std::list<wxPoint>::iterator line = lines->begin();
-                line != lines->end(); line++) {
-                points[i+0] = line->x;
-                points[i+1] = line->y;
-                i+=2;
-            }
-
-            if(i > 2)
-                glDrawArrays(GL_LINE_STRIP, 0, i >> 1);
+        for(size_t strip = 0; strip + 1 < m_draw_strips.size(); strip++) {
+            int count = m_draw_strips[strip + 1] - m_draw_strips[strip];
+            if(count > 1)
+                glDrawArrays(GL_LINE_STRIP, m_draw_strips[strip], count);
         }
         glDisableClientState(GL_VERTEX_ARRAY);
 
-        delete [] points;
         glDisable( GL_LINE_SMOOTH );
         glDisable( GL_BLEND );
         
@@ -840,26 +1034,20 @@ void Track::AddPoint( TrackPoint *pNewPoint )
 {
     TrackPoints.push_back( pNewPoint );
     SubTracks.clear(); // invalidate subtracks
+    InvalidateLOD();
 }
 
-void Track::GetPointLists(ChartCanvas *cc, std::list< std::list<wxPoint> > &pointlists,
-                          ViewPort &VP, const LLBBox &box )
+void Track::GetPointLists(ChartCanvas *cc, ViewPort &VP, const LLBBox &box )
 {
     if( !IsVisible() || GetnPoints() == 0 ) return;
     Finalize();
 //    OCPNStopWatch sw;
-    Segments(cc, pointlists, box, VP.view_scale_ppm);
+    Segments(cc, box, VP.view_scale_ppm);
 
 #if 0
     if(GetnPoints() > 40000) {
         double t = sw.GetTime();
-        double c = 0;
-        for(std::list< std::list<wxPoint> >::iterator lines = pointlists.begin();
-        lines != pointlists.end(); lines++) {
-            if(lines->size() > 1)
-                c += lines->size();
-                continue;
-        }
+        double c = m_draw_points.size();
         printf("assemble time %f %f segments %f seg/ms\n", sw.GetTime(), c, c/t);
     }
 #endif
@@ -867,12 +1055,11 @@ void Track::GetPointLists(ChartCanvas *cc, std::list< std::list<wxPoint> > &poin
     //    Add last segment, dynamically, maybe.....
     // we should not add this segment if it is not on the screen...
     if( IsRunning() ) {
-        std::list<wxPoint> new_list;
-        pointlists.push_back(new_list);
-        AddPointToList(cc, pointlists, TrackPoints.size()-1);
+        BreakStrip();
+        AddPointToList(cc, TrackPoints.size()-1);
         wxPoint r;
         cc->GetCanvasPointPix( gLat, gLon, &r );
-        pointlists.back().push_back(r);
+        m_draw_points.push_back(r);
     }
 }
 
@@ -882,6 +1069,8 @@ void Track::Finalize()
     if(SubTracks.size()) // subtracks already computed
         return;
 
+    InvalidateLOD();
+
 //    OCPNStopWatch sw1;
 
     int n = TrackPoints.size() - 1;
@@ -959,6 +1148,7 @@ void Track::InsertSubTracks(LLBBox &box, int level, int pos)
 void Track::AddPointFinalized( TrackPoint *pNewPoint )
 {
     TrackPoints.push_back( pNewPoint );
+    InvalidateLOD();
 
     int pos = TrackPoints.size() - 1;
 
@@ -1057,6 +1247,8 @@ int Track::Simplify( double maxDelta )
 
     pSelect->DeleteAllSelectableTrackSegments( this );
     TrackPoints.clear();
+    SubTracks.clear();
+    InvalidateLOD();
 
     for( size_t i=0; i<pointlist.size(); i++ ) {
         if( keeplist[i] )
@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <math.h>
 #include <time.h>
+#include <algorithm>
 
 #include "cutil.h"
 #include "FontMgr.h"
@@ -72,6 +73,7 @@ extern double           g_ShowCOG_Mins;
 extern bool             g_bHideMoored;
 extern double           g_ShowMoored_Kts;
 extern bool             g_bAISShowTracks;
+extern double           g_AISShowTracks_Mins;
 extern bool             g_bShowAreaNotices;
 extern bool             g_bDrawAISSize;
 extern bool             g_bDrawAISRealtime;
@@ -109,8 +111,101 @@ static const long long lNaN = 0xfff8000000000000;
 #define NAN (*(double*)&lNaN)
 #endif
 
-#include <wx/listimpl.cpp>
-WX_DEFINE_LIST(AISTargetTrackList);
+//------------------------------------------------------------------------------
+//    AISTargetTrack Implementation
+//------------------------------------------------------------------------------
+#define AIS_TRACK_INITIAL_SIZE  16
+
+AISTargetTrack::AISTargetTrack()
+{
+    m_head = 0;
+    m_count = 0;
+    m_max_count = AIS_TRACK_INITIAL_SIZE;
+    m_base_time = 0;
+}
+
+void AISTargetTrack::Clear()
+{
+    m_samples.clear();
+    m_head = 0;
+    m_count = 0;
+}
+
+void AISTargetTrack::SetMaxCount( size_t max_count )
+{
+    if( max_count < 2 )
+        max_count = 2;
+
+    while( m_count > max_count )
+        PopFront();
+
+    m_max_count = max_count;
+}
+
+//    Double the buffer, up to the maximum count, unrolling the ring to start at index 0
+void AISTargetTrack::Grow()
+{
+    size_t new_size = wxMax( m_samples.size() * 2, (size_t) AIS_TRACK_INITIAL_SIZE );
+    if( new_size > m_max_count )
+        new_size = m_max_count;
+
+    std::vector<AISTargetTrackSample> samples( new_size );
+    for( size_t i = 0; i < m_count; i++ )
+        samples[i] = Sample( i );
+
+    m_samples.swap( samples );
+    m_head = 0;
+}
+
+void AISTargetTrack::Append( double lat, double lon, time_t time )
+{
+    //  At capacity, so drop the oldest sample
+    if( m_count >= m_max_count )
+        PopFront();
+
+    if( m_count == 0 )
+        m_base_time = time;
+
+    if( m_count == m_samples.size() )
+        Grow();
+
+    AISTargetTrackSample &sample = m_samples[( m_head + m_count ) % m_samples.size()];
+    sample.lat = (int32_t) wxRound( lat * 1e7 );
+    sample.lon = (int32_t) wxRound( lon * 1e7 );
+    sample.dt = (int32_t) ( time - m_base_time );
+    m_count++;
+}
+
+void AISTargetTrack::PopBack()
+{
+    if( m_count )
+        m_count--;
+}
+
+void AISTargetTrack::PopFront()
+{
+    if( m_count ) {
+        m_head = ( m_head + 1 ) % m_samples.size();
+        m_count--;
+    }
+}
+
+void AISTargetTrack::TrimBefore( time_t time )
+{
+    while( m_count && ( GetTime( 0 ) < time ) )
+        PopFront();
+}
+
+AISTargetTrackPoint AISTargetTrack::GetPoint( size_t index ) const
+{
+    const AISTargetTrackSample &sample = Sample( index );
+
+    AISTargetTrackPoint point;
+    point.m_lat = sample.lat / 1e7;
+    point.m_lon = sample.lon / 1e7;
+    point.m_time = m_base_time + sample.dt;
+    return point;
+}
 
 wxString ais_get_status(int index)
 {
@@ -926,10 +1021,9 @@ static void AISDrawTarget( AIS_Target_Data *td, ocpnDC& dc, ViewPort& vp, ChartC
     else
     //  If AIS tracks are shown, is the first point of the track on-screen?
     if( 1/*g_bAISShowTracks*/ && td->b_show_track ) {
-        wxAISTargetTrackListNode *node = td->m_ptrack->GetFirst();
-        if( node ) {
-            AISTargetTrackPoint *ptrack_point = node->GetData();
-            if( vp.GetBBox().Contains( ptrack_point->m_lat,  ptrack_point->m_lon ) )
+        if( !td->m_track.IsEmpty() ) {
+            AISTargetTrackPoint track_point = td->m_track.GetFirst();
+            if( vp.GetBBox().Contains( track_point.m_lat,  track_point.m_lon ) )
                 drawit++;
         }
     }
@@ -1744,16 +1838,14 @@ static void AISDrawTarget( AIS_Target_Data *td, ocpnDC& dc, ViewPort& vp, ChartC
     if( (!b_noshow && td->b_show_track) || b_forceshow ) {
 
         //  create vector of x-y points
-        int TrackLength = td->m_ptrack->GetCount();
+        int TrackLength = td->m_track.GetCount();
         int TrackPointCount;
         wxPoint *TrackPoints = 0;
         if (TrackLength > 1) {
             TrackPoints = new wxPoint[TrackLength];
-            wxAISTargetTrackListNode *node = td->m_ptrack->GetFirst();
-            for (TrackPointCount = 0; node && (TrackPointCount < TrackLength); TrackPointCount++) {
-                AISTargetTrackPoint *ptrack_point = node->GetData();
-                GetCanvasPointPix(vp, cp, ptrack_point->m_lat, ptrack_point->m_lon, &TrackPoints[TrackPointCount]);
-                node = node->GetNext();
+            for (TrackPointCount = 0; TrackPointCount < TrackLength; TrackPointCount++) {
+                AISTargetTrackPoint track_point = td->m_track.GetPoint(TrackPointCount);
+                GetCanvasPointPix(vp, cp, track_point.m_lat, track_point.m_lon, &TrackPoints[TrackPointCount]);
             }
         }
         
@@ -1789,6 +1881,40 @@ static void AISDrawTarget( AIS_Target_Data *td, ocpnDC& dc, ViewPort& vp, ChartC
     }           // Draw tracks
 }
 
+//    Collect the targets that might be drawn in this ViewPort.
+//    A target may be drawn while off-screen if its COG predictor or the start of its track
+//    reaches into view, so the grid query box is grown by the longest distance
+//    any target can have travelled in that time.  Alert targets are always drawn.
+static void AISGetDrawCandidates( ViewPort& vp, std::vector<AIS_Target_Data *> &targets )
+{
+    const AIS_Target_Grid &grid = g_pAIS->GetTargetGrid();
+
+    LLBBox box = vp.GetBBox();
+    double reach_nm = grid.GetMaxSOG() * wxMax( g_ShowCOG_Mins, g_AISShowTracks_Mins ) / 60.;
+    if( reach_nm > 0 ) {
+        double dlat = reach_nm / 60.;
+        double maxlat = wxMax( fabs( box.GetMinLat() ), fabs( box.GetMaxLat() ) ) + dlat;
+        double coslat = cos( wxMin( maxlat, 90. ) * PI / 180. );
+        double dlon = ( coslat > 1e-3 ) ? dlat / coslat : 360.;
+        if( dlon > 180. )
+            dlon = 180.;
+        box.Set( box.GetMinLat() - dlat, box.GetMinLon() - dlon,
+                 box.GetMaxLat() + dlat, box.GetMaxLon() + dlon );
+    }
+    grid.GetTargetsInBox( box, targets );
+
+    const std::vector<int> &alerts = g_pAIS->GetAlertTargets();
+    for( size_t i = 0; i < alerts.size(); i++ ) {
+        AIS_Target_Data *td = g_pAIS->Get_Target_Data_From_MMSI( alerts[i] );
+        if( td )
+            targets.push_back( td );
+    }
+
+    //  Cells may overlap the alert set, so remove duplicates
+    std::sort( targets.begin(), targets.end() );
+    targets.erase( std::unique( targets.begin(), targets.end() ), targets.end() );
+}
+
 void AISDraw( ocpnDC& dc, ViewPort& vp, ChartCanvas *cp )
 {
     if( !g_pAIS ) return;
@@ -1850,8 +1976,10 @@ void AISDraw( ocpnDC& dc, ViewPort& vp, ChartCanvas *cp )
     int LowestInd = 0;
     if (cp != NULL) {
          if (cp->GetAttenAIS()) {
-              for (it = (*current_targets).begin(); it != (*current_targets).end(); ++it) {
-                   AIS_Target_Data *td = it->second;
+              std::vector<AIS_Target_Data *> onscreen;
+              g_pAIS->GetTargetGrid().GetTargetsInBox( vp.GetBBox(), onscreen );
+              for (size_t j = 0; j < onscreen.size(); j++) {
+                   AIS_Target_Data *td = onscreen[j];
                    if (vp.GetBBox().Contains(td->Lat, td->Lon))
                    {
                         if (td->importance > AISImportanceSwitchPoint) {
@@ -1874,10 +2002,13 @@ void AISDraw( ocpnDC& dc, ViewPort& vp, ChartCanvas *cp )
 
     
 
+    std::vector<AIS_Target_Data *> targets;
+    AISGetDrawCandidates( vp, targets );
+
     //    Draw all targets in three pass loop, sorted on SOG, GPSGate & DSC on top
     //    This way, fast targets are not obscured by slow/stationary targets
-    for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
-        AIS_Target_Data *td = it->second;
+    for( size_t i = 0; i < targets.size(); i++ ) {
+        AIS_Target_Data *td = targets[i];
         if( ( td->SOG < g_ShowMoored_Kts )
                 && !( ( td->Class == AIS_GPSG_BUDDY ) || ( td->Class == AIS_DSC ) ) ) 
         {
@@ -1885,8 +2016,8 @@ void AISDraw( ocpnDC& dc, ViewPort& vp, ChartCanvas *cp )
         }        
     }
     
-    for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
-        AIS_Target_Data *td = it->second;
+    for( size_t i = 0; i < targets.size(); i++ ) {
+        AIS_Target_Data *td = targets[i];
         if( ( td->SOG >= g_ShowMoored_Kts )
                 && !( ( td->Class == AIS_GPSG_BUDDY ) || ( td->Class == AIS_DSC ) ) )
         {
@@ -1896,8 +2027,8 @@ void AISDraw( ocpnDC& dc, ViewPort& vp, ChartCanvas *cp )
         }           
     }
 
-    for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
-        AIS_Target_Data *td = it->second;
+    for( size_t i = 0; i < targets.size(); i++ ) {
+        AIS_Target_Data *td = targets[i];
         if( ( td->Class == AIS_GPSG_BUDDY ) || ( td->Class == AIS_DSC ) )
             AISDrawTarget( td, dc, vp, cp );
     }
@@ -1911,15 +2042,6 @@ bool AnyAISTargetsOnscreen( ChartCanvas *cc, ViewPort &vp )
     if( !cc->GetShowAIS() )
         return false;//
         
-    //      Iterate over the AIS Target Hashmap
-    AIS_Target_Hash::iterator it;
-    AIS_Target_Hash *current_targets = g_pAIS->GetTargetList();
-    
-    for( it = ( *current_targets ).begin(); it != ( *current_targets ).end(); ++it ) {
-        AIS_Target_Data *td = it->second;
-        if( vp.GetBBox().Contains( td->Lat,  td->Lon ) )
-            return true;                       // yep
-    }
-    
-    return false;
+    //      Query the AIS target grid
+    return g_pAIS->GetTargetGrid().AnyTargetInBox( vp.GetBBox() );
 }
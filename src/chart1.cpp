@@ -115,6 +115,8 @@
 #include "AISTargetListDialog.h"
 #include "AISTargetAlertDialog.h"
 #include "AIS_Decoder.h"
+#include "NMEACapture.h"
+#include "OwnShipTelemetry.h"
 #include "OCP_DataStreamInput_Thread.h"
 #include "TrackPropDlg.h"
 #include "gshhs.h"
@@ -211,6 +213,10 @@ wxString                  g_compatOsVersion;
 
 int                       g_unit_test_1;
 int                       g_unit_test_2;
+wxString                  g_capture_file;
+wxString                  g_replay_file;
+double                    g_replay_speed;
+wxString                  g_replay_benchmark_file;
 bool                      g_start_fullscreen;
 bool                      g_rebuild_gl_cache;
 bool                      g_parse_all_enc;
@@ -253,6 +259,7 @@ RouteManagerDialog        *pRouteManagerDialog;
 GoToPositionDialog        *pGoToPositionDialog;
 
 double                    gLat, gLon, gCog, gSog, gHdt, gHdm, gVar;
+OwnShipTelemetry          g_OwnShipTelemetry;
 wxString                  gRmcDate, gRmcTime;
 double                    vLat, vLon;
 double                    initial_scale_ppm, initial_rotation;
@@ -890,9 +897,9 @@ bool stConnection::OnExec(const wxString& topic, const wxString& data)
     }
     else {
         NavObjectCollection1 *pSet = new NavObjectCollection1;
-        pSet->load_file(path.fn_str());
+        pSet->OpenGPXStream( path );
         int wpt_dups;
-        pSet->LoadAllGPXObjects( !pSet->IsOpenCPN(), wpt_dups, true ); // Import with full vizibility of names and objects
+        pSet->LoadAllGPXStreamObjects( !pSet->IsOpenCPN(), wpt_dups, true ); // Import with full vizibility of names and objects
         if( pRouteManagerDialog && pRouteManagerDialog->IsShown() )
             pRouteManagerDialog->UpdateLists();
 
@@ -1117,6 +1124,10 @@ void MyApp::OnInitCmdLine( wxCmdLineParser& parser )
     parser.AddOption( _T("l"), _T("loglevel"), _("Amount of logging: error, warning, message, info, debug or trace"));
     parser.AddOption( _T("unit_test_1"), wxEmptyString, _("Display a slideshow of <num> charts and then exit. Zero or negative <num> specifies no limit."), wxCMD_LINE_VAL_NUMBER );
     parser.AddSwitch( _T("unit_test_2") );
+    parser.AddOption( _T("capture"), wxEmptyString, _T("Record all NMEA and SignalK input to a capture <file>.") );
+    parser.AddOption( _T("replay"), wxEmptyString, _T("Replay a capture <file> as an input stream.") );
+    parser.AddOption( _T("replay_speed"), wxEmptyString, _T("Replay speed factor, default 1. Zero replays at maximum speed."), wxCMD_LINE_VAL_DOUBLE );
+    parser.AddOption( _T("replay_benchmark"), wxEmptyString, _T("Feed a capture <file> directly to the AIS and GPS decoders, report throughput and latency, and then exit.") );
     parser.AddParam("import GPX files",
                         wxCMD_LINE_VAL_STRING,
                         wxCMD_LINE_PARAM_OPTIONAL | wxCMD_LINE_PARAM_MULTIPLE);
@@ -1160,6 +1171,11 @@ bool MyApp::OnCmdLineParsed( wxCmdLineParser& parser )
         if( g_unit_test_1 == 0 )
             g_unit_test_1 = -1;
     }
+    parser.Found( _T("capture"), &g_capture_file );
+    parser.Found( _T("replay"), &g_replay_file );
+    g_replay_speed = 1.0;
+    parser.Found( _T("replay_speed"), &g_replay_speed );
+    parser.Found( _T("replay_benchmark"), &g_replay_benchmark_file );
     safe_mode::set_mode(parser.Found("safe_mode"));
     ParseLoglevel(parser);
 
@@ -2863,6 +2879,8 @@ MyFrame::MyFrame( wxFrame *frame, const wxString& title, const wxPoint& pos, con
         COGTable[i] = NAN;
 
     m_fixtime = 0;
+    m_telemetry_fields = 0;
+    m_telemetry_source = OWNSHIP_SOURCE_UNKNOWN;
 
     m_bpersistent_quilt = false;
 
@@ -2875,6 +2893,12 @@ MyFrame::MyFrame( wxFrame *frame, const wxString& title, const wxPoint& pos, con
 
     g_pMUX->SetAISHandler(g_pAIS);
     g_pMUX->SetGPSHandler(this);
+
+    if( !g_capture_file.IsEmpty() )
+        g_pMUX->StartCapture( g_capture_file );
+    if( !g_replay_file.IsEmpty() )
+        g_pMUX->StartReplay( g_replay_file, g_replay_speed );
+
     //  Create/connect a dynamic event handler slot
     wxLogMessage(" **** Connect stuff");
     Connect( wxEVT_OCPN_DATASTREAM, (wxObjectEventFunction) (wxEventFunction) &MyFrame::OnEvtOCPN_NMEA );
@@ -7146,10 +7170,10 @@ void MyFrame::OnInitTimer(wxTimerEvent& event)
                     if( ::wxFileExists( path ) )
                     {
                         NavObjectCollection1 *pSet = new NavObjectCollection1;
-                        pSet->load_file(path.fn_str());
+                        pSet->OpenGPXStream( path );
                         int wpt_dups;
 
-                        pSet->LoadAllGPXObjects( !pSet->IsOpenCPN(),wpt_dups , true ); // Import with full vizibility of names and objects
+                        pSet->LoadAllGPXStreamObjects( !pSet->IsOpenCPN(),wpt_dups , true ); // Import with full vizibility of names and objects
                         LLBBox box = pSet->GetBBox();
                         if (box.GetValid()) {
                             CenterView(GetPrimaryCanvas(), box);
@@ -7311,6 +7335,12 @@ void MyFrame::CheckToolbarPosition()
 void MyFrame::OnFrameTimer1( wxTimerEvent& event )
 {
     CheckToolbarPosition();
+
+    if( !g_replay_benchmark_file.IsEmpty() ) {
+        FrameTimer1.Stop();
+        bool bok = RunCaptureBenchmark( g_replay_benchmark_file );
+        exit( bok ? 0 : 1 );
+    }
     
     if( ! g_bPauseTest && (g_unit_test_1 || g_unit_test_2) ) {
 //            if((0 == ut_index) && GetQuiltMode())
@@ -7458,18 +7488,23 @@ void MyFrame::OnFrameTimer1( wxTimerEvent& event )
                 _T("   ***SAT Watchdog timeout...") );
     }
 
-    //    Build and send a Position Fix event to PlugIns
+    //  Publish any values invalidated by the watchdogs
+    PublishOwnShipTelemetry();
+
+    //    Build and send a Position Fix event to PlugIns, from the published snapshot
     if( g_pi_manager )
     {
+        OwnShipState ownship = g_OwnShipTelemetry.Get();
+
         GenericPosDatEx GPSData;
-        GPSData.kLat = gLat;
-        GPSData.kLon = gLon;
-        GPSData.kCog = gCog;
-        GPSData.kSog = gSog;
-        GPSData.kVar = gVar;
-        GPSData.kHdm = gHdm;
-        GPSData.kHdt = gHdt;
-        GPSData.nSats = g_SatsInView;
+        GPSData.kLat = ownship.Lat;
+        GPSData.kLon = ownship.Lon;
+        GPSData.kCog = ownship.Cog;
+        GPSData.kSog = ownship.Sog;
+        GPSData.kVar = ownship.Var;
+        GPSData.kHdm = ownship.Hdm;
+        GPSData.kHdt = ownship.Hdt;
+        GPSData.nSats = ownship.nSats;
 
         GPSData.FixTime = m_fixtime;
 
@@ -8504,6 +8539,10 @@ void MyFrame::OnEvtPlugInMessage( OCPN_MsgEvent & event )
             decl.ToDouble(&decl_val);
 
             gVar = decl_val;
+
+            m_telemetry_source = g_OwnShipTelemetry.GetSourceId( _T("WMM_pi") );
+            m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_VAR );
+            PublishOwnShipTelemetry();
         }
     }
     
@@ -8862,8 +8901,10 @@ void MyFrame::setPosition(double lat, double lon)
 {
     gLat = lat;
     gLon = lon;
+    m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_POSITION );
     if( g_own_ship_sog_cog_calc ) {
         UpdatePositionCalculatedSogCog();
+        m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_COG ) | OWNSHIP_FIELD_BIT( OWNSHIP_SOG );
     }
 
     gGPS_Watchdog = gps_watchdog_timeout_ticks;
@@ -8877,6 +8918,7 @@ void MyFrame::setCourseOverGround(double cog)
     if(!g_own_ship_sog_cog_calc) {
         wxLogDebug(wxString::Format(_T("COG: %f"), cog));
         gCog = cog;
+        m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_COG );
     }
 }
 
@@ -8885,6 +8927,7 @@ void MyFrame::setSpeedOverGround(double sog)
     if(!g_own_ship_sog_cog_calc) {
         wxLogDebug(wxString::Format(_T("SOG: %f"), sog));
         gSog = sog;
+        m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_SOG );
     }
 }
 
@@ -8895,6 +8938,7 @@ void MyFrame::setMagneticVariation(double var)
         gVar = var;
         g_bVAR_Rx = true;
         gVAR_Watchdog = gps_watchdog_timeout_ticks;
+        m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_VAR );
     }
 }
 
@@ -8904,12 +8948,14 @@ void MyFrame::setSatelitesInView(int no)
     g_SatsInView = no;
     gSAT_Watchdog = sat_watchdog_timeout_ticks;
     g_bSatValid = true;
+    m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_SATS );
 }
 
 void MyFrame::setHeadingTrue(double heading)
 {
     wxLogDebug(wxString::Format(_T("setHeadingTrue: %f"), heading));
     gHdt = heading;
+    m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_HDT );
     if (!std::isnan(heading)) {
         g_bHDT_Rx = true;
         gHDT_Watchdog = gps_watchdog_timeout_ticks;
@@ -8921,6 +8967,7 @@ void MyFrame::setHeadingMagnetic(double heading)
 {
     wxLogDebug(wxString::Format(_T("setHeadingMagnetic: %f"), heading));
     gHdm = heading;
+    m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_HDM );
     if (!std::isnan(heading)) {
         gHDx_Watchdog = gps_watchdog_timeout_ticks;
     }
@@ -8969,7 +9016,10 @@ bool MyFrame::ParsePosition(const LATLONG &Position)
 }
 void MyFrame::OnEvtOCPN_SignalK(OCPN_SignalKEvent &event)
 {
+    static int signalk_source = g_OwnShipTelemetry.GetSourceId( _T("SignalK") );
+    m_telemetry_source = signalk_source;
     m_signalKHandler.OnEvtOCPN_SignalK(event);
+    PublishOwnShipTelemetry();
 }
 
 void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
@@ -9010,6 +9060,9 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
     bool b_accept = EvalPriority( str_buf, event.GetStream() );
     if( !b_accept )
         return;
+
+    static int virtual_source = g_OwnShipTelemetry.GetSourceId( _T("Virtual:") );
+    m_telemetry_source = event.GetStream() ? event.GetStream()->GetTelemetrySource() : virtual_source;
     
     m_NMEA0183 << str_buf;
 
@@ -9046,6 +9099,7 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
                         gSog = m_NMEA0183.Rmc.SpeedOverGroundKnots;
                         gCog = m_NMEA0183.Rmc.TrackMadeGoodDegreesTrue;
                         cog_sog_valid = true;
+                        m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_COG ) | OWNSHIP_FIELD_BIT( OWNSHIP_SOG );
                     }
                     
                     // Any device sending VAR=0.0 can be assumed to not really know 
@@ -9061,6 +9115,7 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
 
                         g_bVAR_Rx = true;
                         gVAR_Watchdog = gps_watchdog_timeout_ticks;
+                        m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_VAR );
                     }
                     
                     sfixtime = m_NMEA0183.Rmc.UTCTime;
@@ -9071,6 +9126,7 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
 
             case HDT:
                 gHdt = m_NMEA0183.Hdt.DegreesTrue;
+                m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_HDT );
                 if( !std::isnan(m_NMEA0183.Hdt.DegreesTrue) )
                 {
                     g_bHDT_Rx = true;
@@ -9080,6 +9136,7 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
 
             case HDG:
                 gHdm = m_NMEA0183.Hdg.MagneticSensorHeadingDegrees;
+                m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_HDM );
                 if( !std::isnan(m_NMEA0183.Hdg.MagneticSensorHeadingDegrees) )
                     gHDx_Watchdog = gps_watchdog_timeout_ticks;
 
@@ -9095,21 +9152,27 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
                     
                     g_bVAR_Rx = true;
                     gVAR_Watchdog = gps_watchdog_timeout_ticks;
+                    m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_VAR );
                 }
                 break;
 
             case HDM:
                 gHdm = m_NMEA0183.Hdm.DegreesMagnetic;
+                m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_HDM );
                 if( !std::isnan(m_NMEA0183.Hdm.DegreesMagnetic) )
                     gHDx_Watchdog = gps_watchdog_timeout_ticks;
                 break;
 
             case VTG:
                 // should we allow either Sog or Cog but not both to be valid?
-                if( !g_own_ship_sog_cog_calc && !std::isnan(m_NMEA0183.Vtg.SpeedKnots) )
+                if( !g_own_ship_sog_cog_calc && !std::isnan(m_NMEA0183.Vtg.SpeedKnots) ) {
                     gSog = m_NMEA0183.Vtg.SpeedKnots;
-                if( !g_own_ship_sog_cog_calc && !std::isnan(m_NMEA0183.Vtg.TrackDegreesTrue) )
+                    m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_SOG );
+                }
+                if( !g_own_ship_sog_cog_calc && !std::isnan(m_NMEA0183.Vtg.TrackDegreesTrue) ) {
                     gCog = m_NMEA0183.Vtg.TrackDegreesTrue;
+                    m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_COG );
+                }
                 if( !g_own_ship_sog_cog_calc && !std::isnan(m_NMEA0183.Vtg.SpeedKnots) &&
                     !std::isnan(m_NMEA0183.Vtg.TrackDegreesTrue) ) {
                     gCog = m_NMEA0183.Vtg.TrackDegreesTrue;
@@ -9226,10 +9289,12 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
                 UpdatePositionCalculatedSogCog();
             }
             cog_sog_valid = true;
+            m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_COG ) | OWNSHIP_FIELD_BIT( OWNSHIP_SOG );
 
             if( !std::isnan(gpd.kHdt) )
             {
                 gHdt = gpd.kHdt;
+                m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_HDT );
                 g_bHDT_Rx = true;
                 gHDT_Watchdog = gps_watchdog_timeout_ticks;
             }
@@ -9241,6 +9306,7 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
                 m_fixtime = now.GetTicks();
                 
                 pos_valid = true;
+                m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_POSITION );
             }
         }
         else
@@ -9270,6 +9336,8 @@ void MyFrame::OnEvtOCPN_NMEA( OCPN_DataStreamEvent & event )
         cog_sog_valid = true;
 
     if( bis_recognized_sentence ) PostProcessNMEA( pos_valid, cog_sog_valid, sfixtime );
+
+    PublishOwnShipTelemetry();
 }
 
 void MyFrame::PostProcessNMEA( bool pos_valid, bool cog_sog_valid, const wxString &sfixtime )
@@ -9322,6 +9390,7 @@ void MyFrame::PostProcessNMEA( bool pos_valid, bool cog_sog_valid, const wxStrin
     if( !g_bHDT_Rx ) {
         if( !std::isnan(gVar) && !std::isnan(gHdm)) {
             gHdt = gHdm + gVar;
+            m_telemetry_fields |= OWNSHIP_FIELD_BIT( OWNSHIP_HDT );
             if (gHdt < 0)
                 gHdt += 360.0;
             else if (gHdt >= 360)
@@ -9488,6 +9557,32 @@ void MyFrame::PostProcessNMEA( bool pos_valid, bool cog_sog_valid, const wxStrin
 #endif            //ocpnUPDATE_SYSTEM_TIME
 }
 
+//    Copy the own ship globals to the telemetry store, stamping the fields
+//    received since the last publish, and make them visible to other threads.
+void MyFrame::PublishOwnShipTelemetry( void )
+{
+    g_OwnShipTelemetry.SetPosition( gLat, gLon );
+    g_OwnShipTelemetry.SetCog( gCog );
+    g_OwnShipTelemetry.SetSog( gSog );
+    g_OwnShipTelemetry.SetHdt( gHdt );
+    g_OwnShipTelemetry.SetHdm( gHdm );
+    g_OwnShipTelemetry.SetVar( gVar );
+    g_OwnShipTelemetry.SetSats( g_SatsInView );
+
+    int flags = 0;
+    if( bGPSValid ) flags |= OWNSHIP_GPS_VALID;
+    if( g_bSatValid ) flags |= OWNSHIP_SAT_VALID;
+    if( g_bHDT_Rx ) flags |= OWNSHIP_HDT_RX;
+    if( g_bVAR_Rx ) flags |= OWNSHIP_VAR_RX;
+    g_OwnShipTelemetry.SetFlags( flags );
+
+    if( m_telemetry_fields )
+        g_OwnShipTelemetry.MarkReceived( m_telemetry_fields, m_telemetry_source );
+    m_telemetry_fields = 0;
+
+    g_OwnShipTelemetry.Publish();
+}
+
 void MyFrame::FilterCogSog( void )
 {            
     if( g_bfilter_cogsog && !g_own_ship_sog_cog_calc ) {
@@ -3780,6 +3780,9 @@ void ChartCanvas::OnRolloverPopupTimerEvent( wxTimerEvent& event )
 
                 if( !m_pAISRolloverWin->IsActive() ) {
 
+                    //  UpdateAllCPA() may have skipped a target beyond the alarm horizon
+                    g_pAIS->UpdateOneCPA( ptarget );
+
                     wxString s = ptarget->GetRolloverString();
                     m_pAISRolloverWin->SetString( s );
 
@@ -3998,13 +4001,13 @@ void ChartCanvas::OnRolloverPopupTimerEvent( wxTimerEvent& event )
                         s.Append( pt->GetName() );
                     double tlenght = pt->Length();
                     s << _T("\n") << _("Total Track: ") << FormatDistanceAdaptive(tlenght);
-                    if( pt->GetLastPoint()->GetTimeString() && pt->GetPoint(0)->GetTimeString() ) {
+                    if( pt->GetLastPoint()->HasTime() && pt->GetPoint(0)->HasTime() ) {
                         wxTimeSpan ttime = pt->GetLastPoint()->GetCreateTime() - pt->GetPoint(0)->GetCreateTime();
                         double htime = ttime.GetSeconds().ToDouble() / 3600.;
                         s << wxString::Format( _T("  %.1f "), (float)(tlenght / htime) ) << getUsrSpeedUnit();
                         s << wxString(htime > 24.? ttime.Format(_T("  %Dd %H:%M")): ttime.Format(_T("  %H:%M")));
                     }
-                    if (g_bShowTrackPointTime && segShow_point_b->GetTimeString())
+                    if (g_bShowTrackPointTime && segShow_point_b->HasTime())
                         s << _T("\n") << _("Segment Created: ") << segShow_point_b->GetTimeString();
 
                     s << _T("\n");
@@ -4020,7 +4023,7 @@ void ChartCanvas::OnRolloverPopupTimerEvent( wxTimerEvent& event )
 
                     s << FormatDistanceAdaptive( dist );
 
-                    if(segShow_point_a->GetTimeString() && segShow_point_b->GetTimeString()){
+                    if(segShow_point_a->HasTime() && segShow_point_b->HasTime()){
                         double segmentSpeed = toUsrSpeed( dist / ( (segShow_point_b->GetCreateTime() - segShow_point_a->GetCreateTime()).GetSeconds().ToDouble() / 3600.) );
                         s << wxString::Format( _T("  %.1f "), (float)segmentSpeed ) << getUsrSpeedUnit();
                     }
@@ -7913,15 +7916,14 @@ bool ChartCanvas::MouseEventProcessObjects( wxMouseEvent& event )
                     m_pRoutePointEditTarget->SetPointFromDraghandlePoint(this, mouse_x, mouse_y);
                     // update the Drag Handle entry in the pSelect list
                     pSelect->ModifySelectablePoint( new_cursor_lat, new_cursor_lon, m_pRoutePointEditTarget, SELTYPE_DRAGHANDLE );
-                    m_pFoundPoint->m_slat = m_pRoutePointEditTarget->m_lat;             // update the SelectList entry
-                    m_pFoundPoint->m_slon = m_pRoutePointEditTarget->m_lon;
+                    pSelect->ModifySelectItem( m_pFoundPoint, m_pRoutePointEditTarget->m_lat,    // update the SelectList entry
+                                               m_pRoutePointEditTarget->m_lon );
                 }
                 else{
                     m_pRoutePointEditTarget->m_lat = new_cursor_lat;    // update the RoutePoint entry
                     m_pRoutePointEditTarget->m_lon = new_cursor_lon;
                     m_pRoutePointEditTarget->m_wpBBox.Invalidate();
-                    m_pFoundPoint->m_slat = new_cursor_lat;             // update the SelectList entry
-                    m_pFoundPoint->m_slon = new_cursor_lon;
+                    pSelect->ModifySelectItem( m_pFoundPoint, new_cursor_lat, new_cursor_lon );  // update the SelectList entry
                 }
                 
                 
@@ -8009,15 +8011,14 @@ bool ChartCanvas::MouseEventProcessObjects( wxMouseEvent& event )
                             m_pRoutePointEditTarget->SetPointFromDraghandlePoint(this, mouse_x, mouse_y);
                             // update the Drag Handle entry in the pSelect list
                             pSelect->ModifySelectablePoint( m_cursor_lat, m_cursor_lon, m_pRoutePointEditTarget, SELTYPE_DRAGHANDLE );
-                            m_pFoundPoint->m_slat = m_pRoutePointEditTarget->m_lat;             // update the SelectList entry
-                            m_pFoundPoint->m_slon = m_pRoutePointEditTarget->m_lon;
+                            pSelect->ModifySelectItem( m_pFoundPoint, m_pRoutePointEditTarget->m_lat,    // update the SelectList entry
+                                                       m_pRoutePointEditTarget->m_lon );
                         }
                         else{
                             m_pRoutePointEditTarget->m_lat = m_cursor_lat;    // update the RoutePoint entry
                             m_pRoutePointEditTarget->m_lon = m_cursor_lon;
                             m_pRoutePointEditTarget->m_wpBBox.Invalidate();
-                            m_pFoundPoint->m_slat = m_cursor_lat;             // update the SelectList entry
-                            m_pFoundPoint->m_slon = m_cursor_lon;
+                            pSelect->ModifySelectItem( m_pFoundPoint, m_cursor_lat, m_cursor_lon );  // update the SelectList entry
                         }
                         
                         
@@ -11320,8 +11321,10 @@ void ChartCanvas::RebuildTideSelectList( LLBBox& BBox )
     
     pSelectTC->DeleteAllSelectableTypePoints( SELTYPE_TIDEPOINT );
     
-    for( int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++ ) {
-        const IDX_entry *pIDX = ptcmgr->GetIDX_entry( i );
+    std::vector<int> stations;
+    ptcmgr->GetStationsInBBox( BBox, 0., stations );
+    for( size_t j = 0; j < stations.size(); j++ ) {
+        const IDX_entry *pIDX = ptcmgr->GetIDX_entry( stations[j] );
         double lon = pIDX->IDX_lon;
         double lat = pIDX->IDX_lat;
         
@@ -11440,8 +11443,10 @@ void ChartCanvas::DrawAllTidesInBBox( ocpnDC& dc, LLBBox& BBox )
         double lon_last = 0.;
         double lat_last = 0.;
         double marge = 0.05;
-        for( int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++ ) {
-            const IDX_entry *pIDX = ptcmgr->GetIDX_entry( i );
+        std::vector<int> stations;
+        ptcmgr->GetStationsInBBox( BBox, marge, stations );
+        for( size_t j = 0; j < stations.size(); j++ ) {
+            const IDX_entry *pIDX = ptcmgr->GetIDX_entry( stations[j] );
 
             char type = pIDX->IDX_type;             // Entry "TCtcIUu" identifier
             if( ( type == 't' ) || ( type == 'T' ) )  // only Tides
@@ -11614,8 +11619,10 @@ void ChartCanvas::RebuildCurrentSelectList( LLBBox& BBox )
     
     double lon_last = 0.;
     double lat_last = 0.;
-    for( int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++ ) {
-        const IDX_entry *pIDX = ptcmgr->GetIDX_entry( i );
+    std::vector<int> stations;
+    ptcmgr->GetStationsInBBox( BBox, 0., stations );
+    for( size_t j = 0; j < stations.size(); j++ ) {
+        const IDX_entry *pIDX = ptcmgr->GetIDX_entry( stations[j] );
         double lon = pIDX->IDX_lon;
         double lat = pIDX->IDX_lat;
         
@@ -11719,7 +11726,10 @@ void ChartCanvas::DrawAllCurrentsInBBox( ocpnDC& dc, LLBBox& BBox )
     
     {
 
-        for( int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++ ) {
+        std::vector<int> stations;
+        ptcmgr->GetStationsInBBox( BBox, marge, stations );
+        for( size_t j = 0; j < stations.size(); j++ ) {
+            int i = stations[j];
             const IDX_entry *pIDX = ptcmgr->GetIDX_entry( i );
             double lon = pIDX->IDX_lon;
             double lat = pIDX->IDX_lat;
@@ -3582,14 +3582,8 @@ S57Obj *cm93chart::CreateS57Obj ( int cell_index, int iobject, int subcell, Obje
             if ( sattr.Len() ) {
                 wxASSERT( sattr.Len() == 6);
                 wxCharBuffer dbuffer=sattr.ToUTF8();
-                if(dbuffer.data()) {                
-                    pobj->att_array = (char *)realloc(pobj->att_array, 6*(pobj->n_attr + 1));
-                
-                    strncpy(pobj->att_array + (6 * sizeof(char) * pobj->n_attr), dbuffer.data(), 6);
-                    pobj->n_attr++;
-                
-                    pobj->attVal->Add ( pattValTmp );
-                }
+                if(dbuffer.data())
+                    pobj->AddAttributeRecord( dbuffer.data(), pattValTmp );
                 else
                     delete pattValTmp;
             }
@@ -3628,6 +3622,7 @@ S57Obj *cm93chart::CreateS57Obj ( int cell_index, int iobject, int subcell, Obje
                       for(int i=0 ; i < pobj->n_attr ; i++) {           // find "INFORM"
                           if(!strncmp(patl, "INFORM", 6)){
                               memcpy ( patl, "OBJNAM", 6 );            // change to "OBJNAM"
+                              pobj->att_codes[i] = S57AttrCodeFromAcronym( "OBJNAM" );
                               break;
                           }
                           
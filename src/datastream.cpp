@@ -65,6 +65,7 @@
 #include "OCPN_DataStreamEvent.h"
 #include "OCP_DataStreamInput_Thread.h"
 #include "nmea0183.h"
+#include "OwnShipTelemetry.h"
 
 #ifdef USE_GARMINHOST
 #include "garmin_wrapper.h"
@@ -182,7 +183,8 @@ DataStream::DataStream(wxEvtHandler *input_consumer,
     m_connection_type(conn_type),
     m_bGarmin_GRMN_mode(bGarmin),
     m_GarminHandler(NULL),
-    m_params()
+    m_params(),
+    m_telemetry_source(-1)
 {
     wxLogMessage( _T("Classic CTOR"));
 
@@ -205,7 +207,8 @@ DataStream::DataStream(wxEvtHandler *input_consumer,
     m_connection_type(params->Type),
     m_bGarmin_GRMN_mode(params->Garmin),
     m_GarminHandler(NULL),
-    m_params(*params)
+    m_params(*params),
+    m_telemetry_source(-1)
 {
     m_BaudRate = wxString::Format(wxT("%i"), params->Baudrate),
     SetSecThreadInActive();
@@ -221,6 +224,13 @@ DataStream::DataStream(wxEvtHandler *input_consumer,
     SetChecksumCheck(params->ChecksumCheck);
 }
 
+int DataStream::GetTelemetrySource()
+{
+    if( m_telemetry_source < 0 )
+        m_telemetry_source = g_OwnShipTelemetry.GetSourceId( m_portstring );
+    return m_telemetry_source;
+}
+
 void DataStream::Open(void)
 {
     //  Open a port
@@ -3926,6 +3926,9 @@ void glChartCanvas::DrawGLTidesInBBox(ocpnDC& dc, LLBBox& BBox)
         
         // Texture is ready
         
+        std::vector<int> stations;
+        ptcmgr->GetStationsInBBox( BBox, 0., stations );
+
         glBindTexture( GL_TEXTURE_2D, m_tideTex);
         glEnable( GL_TEXTURE_2D );
         glEnable(GL_BLEND);
@@ -3933,8 +3936,8 @@ void glChartCanvas::DrawGLTidesInBBox(ocpnDC& dc, LLBBox& BBox)
 #ifndef USE_ANDROID_GLES2
         glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE );
         
-        for( int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++ ) {
-            const IDX_entry *pIDX = ptcmgr->GetIDX_entry( i );
+        for( size_t j = 0; j < stations.size(); j++ ) {
+            const IDX_entry *pIDX = ptcmgr->GetIDX_entry( stations[j] );
             
             char type = pIDX->IDX_type;             // Entry "TCtcIUu" identifier
             if( ( type == 't' ) || ( type == 'T' ) )  // only Tides
@@ -3966,8 +3969,8 @@ void glChartCanvas::DrawGLTidesInBBox(ocpnDC& dc, LLBBox& BBox)
             } // type 'T"
         }       //loop
 #else
-        for( int i = 1; i < ptcmgr->Get_max_IDX() + 1; i++ ) {
-            const IDX_entry *pIDX = ptcmgr->GetIDX_entry( i );
+        for( size_t j = 0; j < stations.size(); j++ ) {
+            const IDX_entry *pIDX = ptcmgr->GetIDX_entry( stations[j] );
     
             char type = pIDX->IDX_type;             // Entry "TCtcIUu" identifier
             if( ( type == 't' ) || ( type == 'T' ) )  // only Tides
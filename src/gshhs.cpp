@@ -39,6 +39,17 @@
 
 #include <wx/file.h>
 
+#include <algorithm>
+
+#ifdef __WXMSW__
+#include <wx/msw/wrapwin.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "dychart.h"
 
 #ifdef ocpnUSE_GL
@@ -66,6 +77,13 @@
 
 extern wxString gWorldMapLocation;
 
+//  Decoded (and GL tessellated) cells kept per quality level before the
+//  least recently drawn ones are released
+#define GSHHS_CELL_CACHE_BYTES          ( 64 << 20 )
+
+//  Larger views are left to load on demand at the new quality
+#define GSHHS_PREFETCH_MAX_CELLS        2048
+
 #ifdef USE_ANDROID_GLES2
 static const GLchar* vertex_shader_source =
     "attribute vec2 position;\n"
@@ -188,15 +206,127 @@ void GSHHSChart::RenderViewOnDC( ocpnDC& dc, ViewPort& vp )
 //    reader->drawBoundaries( dc, vp );
 }
 
-GshhsPolyCell::GshhsPolyCell( FILE *fpoly_, int x0_, int y0_, PolygonFileHeader *header_ )
+//-------------------------------------------------------------------------
+
+GshhsMappedFile::GshhsMappedFile()
+{
+    m_data = NULL;
+    m_size = 0;
+    m_mapped = false;
+#ifdef __WXMSW__
+    m_hfile = NULL;
+    m_hmap = NULL;
+#endif
+}
+
+GshhsMappedFile::~GshhsMappedFile()
+{
+    Close();
+}
+
+bool GshhsMappedFile::Open( const wxString &fname )
+{
+    Close();
+
+#ifdef __WXMSW__
+    HANDLE hfile = CreateFileW( fname.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( hfile != INVALID_HANDLE_VALUE ) {
+        LARGE_INTEGER size;
+        HANDLE hmap = NULL;
+        if( GetFileSizeEx( hfile, &size ) && size.QuadPart > 0 )
+            hmap = CreateFileMapping( hfile, NULL, PAGE_READONLY, 0, 0, NULL );
+        if( hmap ) {
+            void *data = MapViewOfFile( hmap, FILE_MAP_READ, 0, 0, 0 );
+            if( data ) {
+                m_hfile = hfile;
+                m_hmap = hmap;
+                m_data = (const unsigned char *) data;
+                m_size = (size_t) size.QuadPart;
+                m_mapped = true;
+                return true;
+            }
+            CloseHandle( hmap );
+        }
+        CloseHandle( hfile );
+    }
+#else
+    int fd = open( fname.mb_str(), O_RDONLY );
+    if( fd >= 0 ) {
+        struct stat st;
+        if( fstat( fd, &st ) == 0 && st.st_size > 0 ) {
+            void *data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+            if( data != MAP_FAILED ) {
+                close( fd );
+                m_data = (const unsigned char *) data;
+                m_size = st.st_size;
+                m_mapped = true;
+                return true;
+            }
+        }
+        close( fd );
+    }
+#endif
+
+    //  No mapping, so read the file in one piece
+    if( !wxFile::Exists( fname ) )
+        return false;
+
+    wxFile file( fname );
+    wxFileOffset len = file.IsOpened() ? file.Length() : 0;
+    if( len <= 0 )
+        return false;
+
+    unsigned char *buf = (unsigned char *) malloc( len );
+    if( !buf )
+        return false;
+    if( file.Read( buf, len ) != len ) {
+        free( buf );
+        return false;
+    }
+
+    m_data = buf;
+    m_size = len;
+    m_mapped = false;
+    return true;
+}
+
+void GshhsMappedFile::Close()
+{
+    if( m_data ) {
+        if( m_mapped ) {
+#ifdef __WXMSW__
+            UnmapViewOfFile( m_data );
+            CloseHandle( m_hmap );
+            CloseHandle( m_hfile );
+            m_hmap = m_hfile = NULL;
+#else
+            munmap( (void *) m_data, m_size );
+#endif
+        } else
+            free( (void *) m_data );
+    }
+
+    m_data = NULL;
+    m_size = 0;
+    m_mapped = false;
+}
+
+//-------------------------------------------------------------------------
+
+GshhsPolyCell::GshhsPolyCell( const GshhsMappedFile *file_, int x0_, int y0_, const PolygonFileHeader *header_ )
 {
     header = header_;
-    fpoly = fpoly_;
+    m_file = file_;
     x0cell = x0_;
     y0cell = y0_;
+    nbpoints = 0;
+    m_last_used = 0;
 
-    for(int i=0; i<6; i++)
+    for(int i=0; i<6; i++) {
         polyv[i] = NULL;
+        polyc[i] = 0;
+    }
 
     ReadPolygonFile( );
 
@@ -219,65 +349,95 @@ void GshhsPolyCell::ClearPolyV()
     for(int i=0; i<6; i++) {
         delete [] polyv[i];
         polyv[i] = NULL;
+        polyc[i] = 0;
     }
 }
 
-void GshhsPolyCell::ReadPoly(contour_list &poly)
+size_t GshhsPolyCell::GetMemorySize() const
+{
+    size_t size = sizeof( *this ) + nbpoints * sizeof( wxRealPoint );
+    for(int i=0; i<6; i++)
+        if( polyv[i] )
+            size += polyc[i] * sizeof( float_2Dpt );
+    return size;
+}
+
+//  The files are little endian and not aligned, so copy the values out
+static inline int32_t gshhs_get_int( const unsigned char *p )
+{
+    int32_t value;
+    memcpy( &value, p, sizeof value );
+    return value;
+}
+
+static inline double gshhs_get_double( const unsigned char *p )
+{
+    double value;
+    memcpy( &value, p, sizeof value );
+    return value;
+}
+
+bool GshhsPolyCell::ReadPoly( const unsigned char *&p, const unsigned char *end, contour_list &poly )
 {
-    double X,Y;
-    contour tmp_contour;
-    int32_t num_vertices, num_contours;
     poly.clear();
-    if(fread(&num_contours, sizeof num_contours, 1, fpoly) != 1)
-        goto fail;
+    if( end - p < 4 )
+        return false;
+
+    int32_t num_contours = gshhs_get_int( p );
+    p += 4;
+    if( num_contours < 0 )
+        return false;
 
     for (int c= 0; c < num_contours; c++)
     {
-        int32_t value;
-        if(fread(&value, sizeof value, 1, fpoly) != 1 ||  /* discarding hole value */
-           fread(&value, sizeof value, 1, fpoly) != 1)
-            goto fail;
-
-        num_vertices=value;
-
-        tmp_contour.clear();
+        if( end - p < 8 )
+            return false;
+
+        /* discarding hole value */
+        int32_t num_vertices = gshhs_get_int( p + 4 );
+        p += 8;
+        if( num_vertices < 0 || (size_t) num_vertices > (size_t) ( end - p ) / 16 )
+            return false;
+
+        poly.push_back( contour() );
+        contour &tmp_contour = poly.back();
+        tmp_contour.resize( num_vertices );
         for (int v= 0; v < num_vertices; v++)
         {
-            if(fread(&X, sizeof X, 1, fpoly) != 1 ||
-               fread(&Y, sizeof Y, 1, fpoly) != 1)
-                goto fail;
-
-            tmp_contour.push_back(wxRealPoint(X*GSHHS_SCL,Y*GSHHS_SCL));
+            tmp_contour[v].x = gshhs_get_double( p ) * GSHHS_SCL;
+            tmp_contour[v].y = gshhs_get_double( p + 8 ) * GSHHS_SCL;
+            p += 16;
         }
-        poly.push_back(tmp_contour);
+        nbpoints += num_vertices;
     }
-    return;
-
-fail:
-    wxLogMessage( _T("gshhs ReadPoly failed") );
+    return true;
 }
 
 void GshhsPolyCell::ReadPolygonFile()
 {
-    if(!fpoly)
+    if( !m_file || !m_file->IsOk() || header->pasx <= 0 || header->pasy <= 0 )
         return;
 
-    int pos_data;
-    int tab_data;
+    const unsigned char *data = m_file->GetData();
+    const unsigned char *end = data + m_file->GetSize();
 
-    tab_data = ( x0cell / header->pasx ) * ( 180 / header->pasy )
+    int tab_data = ( x0cell / header->pasx ) * ( 180 / header->pasy )
         + ( y0cell + 90 ) / header->pasy;
-    fseek( fpoly, sizeof(PolygonFileHeader) + tab_data * sizeof(int), SEEK_SET );
-    if(fread( &pos_data, sizeof(int), 1, fpoly ) != 1)
+    size_t tab_pos = sizeof(PolygonFileHeader) + tab_data * sizeof(int);
+    if( tab_data < 0 || tab_pos + sizeof(int) > m_file->GetSize() )
         goto fail;
 
-    fseek( fpoly, pos_data, SEEK_SET );
+    {
+        int pos_data = gshhs_get_int( data + tab_pos );
+        if( pos_data < 0 || (size_t) pos_data > m_file->GetSize() )
+            goto fail;
 
-    ReadPoly( poly1 );
-    ReadPoly( poly2 );
-    ReadPoly( poly3 );
-    ReadPoly( poly4 );
-    ReadPoly( poly5 );
+        const unsigned char *p = data + pos_data;
+        if( !ReadPoly( p, end, poly1 ) || !ReadPoly( p, end, poly2 ) ||
+            !ReadPoly( p, end, poly3 ) || !ReadPoly( p, end, poly4 ) ||
+            !ReadPoly( p, end, poly5 ) )
+            wxLogMessage( _T("gshhs ReadPoly failed") );
+    }
     return;
 
 fail:
@@ -733,13 +893,11 @@ void GshhsPolyCell::drawSeaBorderLines( ocpnDC &pnt, double dx, ViewPort &vp )
 
 GshhsPolyReader::GshhsPolyReader( int quality )
 {
-    fpoly = NULL;
+    m_level = NULL;
+    m_frame = 0;
+    m_prefetch_stop = false;
+    m_prefetch_quality = -1;
 
-    for( int i = 0; i < 360; i++ ) {
-        for( int j = 0; j < 180; j++ ) {
-            allCells[i][j] = NULL;
-        }
-    }
     currentQuality = -1;
     polyHeader.version = -1;
     InitializeLoadQuality( quality );
@@ -748,56 +906,215 @@ GshhsPolyReader::GshhsPolyReader( int quality )
 //-------------------------------------------------------------------------
 GshhsPolyReader::~GshhsPolyReader()
 {
-    for( int i = 0; i < 360; i++ ) {
-        for( int j = 0; j < 180; j++ ) {
-            if( allCells[i][j] != NULL ) {
-                delete allCells[i][j];
-                allCells[i][j] = NULL;
-            }
-        }
-    }
+    StopPrefetch();
 
-    if (fpoly) {
-        fclose(fpoly);
-    }
+    for( int q = 0; q < 5; q++ )
+        ClearLevel( m_levels[q] );
 }
 
 //-------------------------------------------------------------------------
 int GshhsPolyReader::ReadPolyVersion()
 {
-    wxString fname = GshhsReader::getFileName_Land( 0 );
-    if( fpoly ) fclose( fpoly );
-    fpoly = fopen( fname.mb_str(), "rb" );
-
-    /* init header */
-    if( !fpoly ) return 0;
+    if( !OpenLevel( 0 ) ) return 0;
 
-    readPolygonFileHeader( fpoly, &polyHeader );
+    polyHeader = m_levels[0].header;
 
     return polyHeader.version;
 }
 
+bool GshhsPolyReader::OpenLevel( int quality )
+{
+    GshhsPolyLevel &level = m_levels[quality];
+    if( level.file.IsOk() )
+        return true;
+
+    if( !level.file.Open( GshhsReader::getFileName_Land( quality ) ) )
+        return false;
+
+    if( level.file.GetSize() < sizeof(PolygonFileHeader) ) {
+        wxLogMessage( _T("gshhs ReadPolygonFileHeader failed") );
+        level.file.Close();
+        return false;
+    }
+
+    memcpy( &level.header, level.file.GetData(), sizeof(PolygonFileHeader) );
+    level.cells.assign( 360 * 180, (GshhsPolyCell *) NULL );
+    return true;
+}
+
+void GshhsPolyReader::ClearLevel( GshhsPolyLevel &level )
+{
+    for( size_t i = 0; i < level.cells.size(); i++ ) {
+        delete level.cells[i];
+        level.cells[i] = NULL;
+    }
+    level.nbytes = 0;
+}
+
 void GshhsPolyReader::InitializeLoadQuality( int quality )  // 5 levels: 0=low ... 4=full
 {
     if( currentQuality != quality ) {
         currentQuality = quality;
 
-        wxString fname = GshhsReader::getFileName_Land( quality );
+        //  Cells already decoded at the other levels stay cached
+        m_level = OpenLevel( quality ) ? &m_levels[quality] : NULL;
+        if( m_level )
+            polyHeader = m_level->header;
+    }
+}
+
+GshhsPolyCell *GshhsPolyReader::GetCell( GshhsPolyLevel &level, int clonx, int clat )
+{
+    GshhsPolyCell *&cel = level.cells[clonx * 180 + clat + 90];
+    if( !cel ) {
+        cel = new GshhsPolyCell( &level.file, clonx, clat, &level.header );
+        level.nbytes += cel->GetMemorySize();
+    }
+    cel->m_last_used = m_frame;
+    return cel;
+}
+
+static bool CellUsedBefore( GshhsPolyCell * const *a, GshhsPolyCell * const *b )
+{
+    return (*a)->m_last_used < (*b)->m_last_used;
+}
 
-        if( fpoly ) fclose( fpoly );
+void GshhsPolyReader::TrimCells( GshhsPolyLevel &level )
+{
+    if( level.nbytes <= GSHHS_CELL_CACHE_BYTES )
+        return;
 
-        fpoly = fopen( fname.mb_str(), "rb" );
-        if( fpoly ) readPolygonFileHeader( fpoly, &polyHeader );
+    //  Release the least recently drawn cells, never those of this frame,
+    //  down to 3/4 of the budget so this does not run on every frame
+    std::vector<GshhsPolyCell **> lru;
+    for( size_t i = 0; i < level.cells.size(); i++ )
+        if( level.cells[i] && level.cells[i]->m_last_used != m_frame )
+            lru.push_back( &level.cells[i] );
 
-        for( int i = 0; i < 360; i++ ) {
-            for( int j = 0; j < 180; j++ ) {
-                if( allCells[i][j] != NULL ) {
-                    delete allCells[i][j];
-                    allCells[i][j] = NULL;
-                }
-            }
+    std::sort( lru.begin(), lru.end(), CellUsedBefore );
+
+    size_t target = GSHHS_CELL_CACHE_BYTES / 4 * 3;
+    for( size_t i = 0; i < lru.size() && level.nbytes > target; i++ ) {
+        level.nbytes -= (*lru[i])->GetMemorySize();
+        delete *lru[i];
+        *lru[i] = NULL;
+    }
+}
+
+//-------------------------------------------------------------------------
+//    Background decoding of the cells of the quality level the user is
+//    zooming towards.  The worker only builds GshhsPolyCell objects from
+//    the mapped file; they are handed over to the level on the GUI thread
+//    in AdoptPrefetched(), and tessellated there when first drawn.
+//-------------------------------------------------------------------------
+void GshhsPolyReader::PrefetchQuality( int quality, const LLBBox &box )
+{
+    if( quality < 0 || quality > 4 || quality == currentQuality || !OpenLevel( quality ) )
+        return;
+
+    GshhsPolyLevel &level = m_levels[quality];
+
+    int clonmin = (int) floor( box.GetMinLon() ), clonmax = (int) ceil( box.GetMaxLon() );
+    int clatmin = wxMax( -90, (int) floor( box.GetMinLat() ) );
+    int clatmax = wxMin( 90, (int) ceil( box.GetMaxLat() ) );
+    if( clonmax - clonmin > 360 )
+        clonmax = clonmin + 360;
+
+    if( ( clonmax - clonmin ) * ( clatmax - clatmin ) > GSHHS_PREFETCH_MAX_CELLS )
+        return;
+
+    std::vector<int> todo;
+    for( int clon = clonmin; clon < clonmax; clon++ ) {
+        int clonx = clon;
+        while( clonx < 0 )
+            clonx += 360;
+        while( clonx >= 360 )
+            clonx -= 360;
+
+        for( int clat = clatmin; clat < clatmax; clat++ )
+            if( !level.cells[clonx * 180 + clat + 90] )
+                todo.push_back( clonx * 180 + clat + 90 );
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_prefetch_mutex );
+        m_prefetch_quality = quality;
+        m_prefetch_todo.swap( todo );       // replaces any older request
+    }
+
+    if( !m_prefetch_thread.joinable() )
+        m_prefetch_thread = std::thread( [this]() { PrefetchWorker(); } );
+    m_prefetch_cond.notify_one();
+}
+
+void GshhsPolyReader::PrefetchWorker()
+{
+    std::unique_lock<std::mutex> lock( m_prefetch_mutex );
+    for(;;) {
+        m_prefetch_cond.wait( lock, [this]() { return m_prefetch_stop || !m_prefetch_todo.empty(); } );
+        if( m_prefetch_stop )
+            break;
+
+        int quality = m_prefetch_quality;
+        int index = m_prefetch_todo.back();
+        m_prefetch_todo.pop_back();
+        lock.unlock();
+
+        //  The level's file and header do not change once opened
+        GshhsPolyLevel &level = m_levels[quality];
+        GshhsPolyCell *cel = new GshhsPolyCell( &level.file, index / 180, index % 180 - 90, &level.header );
+
+        lock.lock();
+        m_prefetch_done.push_back( std::make_pair( quality * 360 * 180 + index, cel ) );
+    }
+}
+
+void GshhsPolyReader::AdoptPrefetched()
+{
+    std::vector<std::pair<int, GshhsPolyCell *> > done;
+    {
+        std::lock_guard<std::mutex> lock( m_prefetch_mutex );
+        if( m_prefetch_done.empty() )
+            return;
+        done.swap( m_prefetch_done );
+    }
+
+    bool adopted[5] = { false, false, false, false, false };
+    for( size_t i = 0; i < done.size(); i++ ) {
+        int quality = done[i].first / ( 360 * 180 );
+        GshhsPolyLevel &level = m_levels[quality];
+        GshhsPolyCell *&cel = level.cells[done[i].first % ( 360 * 180 )];
+        if( cel ) {                         // loaded on demand meanwhile
+            delete done[i].second;
+            continue;
         }
+
+        cel = done[i].second;
+        cel->m_last_used = m_frame;
+        level.nbytes += cel->GetMemorySize();
+        adopted[quality] = true;
     }
+
+    for( int q = 0; q < 5; q++ )
+        if( adopted[q] )
+            TrimCells( m_levels[q] );
+}
+
+void GshhsPolyReader::StopPrefetch()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_prefetch_mutex );
+        m_prefetch_stop = true;
+        m_prefetch_todo.clear();
+    }
+    m_prefetch_cond.notify_all();
+
+    if( m_prefetch_thread.joinable() )
+        m_prefetch_thread.join();
+
+    for( size_t i = 0; i < m_prefetch_done.size(); i++ )
+        delete m_prefetch_done[i].second;
+    m_prefetch_done.clear();
 }
 
 static inline bool my_intersects( const wxLineF &line1, const wxLineF &line2 )
@@ -834,6 +1151,8 @@ static inline bool my_intersects( const wxLineF &line1, const wxLineF &line2 )
 
 bool GshhsPolyReader::crossing1( wxLineF trajectWorld )
 {
+    if( !m_level ) return false;
+
     double x1 = trajectWorld.p1().x, y1 = trajectWorld.p1().y;
     double x2 = trajectWorld.p2().x, y2 = trajectWorld.p2().y;
 
@@ -841,25 +1160,42 @@ bool GshhsPolyReader::crossing1( wxLineF trajectWorld )
     clonmin = (int) floor( GSSH_SUBM*wxMin( x1, x2 ) );
     clonmax = (int) ceil( GSSH_SUBM*wxMax( x1, x2 ) );
 
+    /* the segment in the same unwrapped longitudes as clon below */
+    double ux1 = x1, ux2 = x2;
+
     if(clonmin < 0) {
         clonmin += GSSH_SUBM*360;
         clonmax += GSSH_SUBM*360;
+        ux1 += 360, ux2 += 360;
     }
 
     if(clonmax - clonmin > GSSH_SUBM*180) { /* dont go long way around world */
         clonmin = (int) floor( GSSH_SUBM*wxMax( x1, x2 ) ) - GSSH_SUBM*360;
         clonmax = (int) ceil( GSSH_SUBM*wxMin( x1, x2 ) );
+        ux1 = x1, ux2 = x2;
+        if(ux1 > ux2) ux1 -= 360; else ux2 -= 360;
     }
 
     clatmin = (int) floor( GSSH_SUBM*wxMin( y1, y2 ));
     clatmax = (int) ceil( GSSH_SUBM*wxMax( y1, y2 ));
     wxASSERT(clatmin >= -GSSH_SUBM*90 && clatmax <= GSSH_SUBM*89);
 
-    // TODO: optimize by traversing only the cells the segment passes through,
-    //       rather than all of the cells which fit in the bounding box,
-    //       this may make a worthwhile difference for longer segments in some cases.
     int clon, clonx, clat;
     for( clon = clonmin; clon < clonmax; clon++ ) {
+        /* only visit the sub cells of this column the segment passes through,
+           not the whole bounding box */
+        double ylo = wxMin( y1, y2 ), yhi = wxMax( y1, y2 );
+        if(ux1 != ux2) {
+            double ta = ((double)clon/GSSH_SUBM - ux1) / (ux2 - ux1);
+            double tb = ((double)(clon+1)/GSSH_SUBM - ux1) / (ux2 - ux1);
+            if(ta > tb) std::swap(ta, tb);
+            ta = wxMax( ta, 0. ), tb = wxMin( tb, 1. );
+            double ya = y1 + (y2 - y1)*ta, yb = y1 + (y2 - y1)*tb;
+            ylo = wxMin( ya, yb ), yhi = wxMax( ya, yb );
+        }
+        int colmin = wxMax( clatmin, (int) floor( GSSH_SUBM*ylo - 1e-4 ) );
+        int colmax = wxMin( clatmax, (int) ceil( GSSH_SUBM*yhi + 1e-4 ) );
+
         clonx = clon;
         while( clonx < 0 )
             clonx += GSSH_SUBM*360;
@@ -878,19 +1214,25 @@ bool GshhsPolyReader::crossing1( wxLineF trajectWorld )
 
         wxLineF rtrajectWorld(x1, y1, x2, y2);
 
-        for( clat = clatmin; clat < clatmax; clat++ ) {
+        for( clat = colmin; clat < colmax; clat++ ) {
             int cloni = clonx/GSSH_SUBM, clati = (GSSH_SUBM*90+clat)/GSSH_SUBM;
-            GshhsPolyCell *&cel = allCells[cloni][clati];
+            /* cells are not evicted here, land crossing tests may run
+               concurrently from plugin threads */
+            GshhsPolyCell *&cel = m_level->cells[cloni*180 + clati];
             if(!cel) {
                 mutex1.Lock();
                 if(!cel) {
                     /* load the needed cell from disk */
-                    cel = new GshhsPolyCell(fpoly, cloni, clati-90, &polyHeader);
+                    cel = new GshhsPolyCell(&m_level->file, cloni, clati-90, &m_level->header);
                     wxASSERT( cel );
                 }
                 mutex1.Unlock();
             }
 
+            /* no land in this cell at all, so no coastline to cross */
+            if(cel->getPoly1().empty())
+                continue;
+
             int hash = GSSH_SUBM*(GSSH_SUBM*(90-clati) + clat - cloni) + clonx;
             std::vector<wxLineF> *&high_res_map = cel->high_res_map[hash];
             wxASSERT(hash >= 0 && hash < GSSH_SUBM*GSSH_SUBM);
@@ -946,18 +1288,14 @@ bool GshhsPolyReader::crossing1( wxLineF trajectWorld )
     return false;
 }
 
-void GshhsPolyReader::readPolygonFileHeader( FILE *polyfile, PolygonFileHeader *header )
-{
-    fseek( polyfile, 0, SEEK_SET );
-    if(fread( header, sizeof(PolygonFileHeader), 1, polyfile ) != 1)
-        wxLogMessage( _T("gshhs ReadPolygonFileHeader failed") );
-}
-
 //-------------------------------------------------------------------------
 void GshhsPolyReader::drawGshhsPolyMapPlain( ocpnDC &pnt, ViewPort &vp, wxColor const &seaColor,
                                              wxColor const &landColor )
 {
-    if( !fpoly ) return;
+    if( !m_level ) return;
+
+    AdoptPrefetched();
+    m_frame++;
 
     pnt.SetPen( wxNullPen );
 
@@ -979,10 +1317,15 @@ void GshhsPolyReader::drawGshhsPolyMapPlain( ocpnDC &pnt, ViewPort &vp, wxColor
            (last_rendered_vp.m_projection_type == PROJECTION_POLAR &&
             last_rendered_vp.clat*vp.clat <= 0)) {
             last_rendered_vp = vp;
-            for(int clon = 0; clon<360; clon++)
-                for(int clat = 0; clat<180; clat++)
-                    if(allCells[clon][clat])
-                        allCells[clon][clat]->ClearPolyV();
+            for( int q = 0; q < 5; q++ ) {
+                GshhsPolyLevel &level = m_levels[q];
+                for( size_t i = 0; i < level.cells.size(); i++ )
+                    if( level.cells[i] ) {
+                        level.nbytes -= level.cells[i]->GetMemorySize();
+                        level.cells[i]->ClearPolyV();
+                        level.nbytes += level.cells[i]->GetMemorySize();
+                    }
+            }
         }
 #ifndef USE_ANDROID_GLES2
         glEnableClientState(GL_VERTEX_ARRAY);
@@ -1006,13 +1349,7 @@ void GshhsPolyReader::drawGshhsPolyMapPlain( ocpnDC &pnt, ViewPort &vp, wxColor
 
         for( clat = clatmin; clat < clatmax; clat++ ) {
             if( clonx >= 0 && clonx <= 359 && clat >= -90 && clat <= 89 ) {
-                if( allCells[clonx][clat + 90] == NULL ) {
-                    cel = new GshhsPolyCell( fpoly, clonx, clat, &polyHeader );
-                    wxASSERT( cel );
-                    allCells[clonx][clat + 90] = cel;
-                } else {
-                    cel = allCells[clonx][clat + 90];
-                }
+                cel = GetCell( *m_level, clonx, clat );
                 bool idl = false;
 
                 // only mercator needs the special idl fixes
@@ -1035,11 +1372,15 @@ void GshhsPolyReader::drawGshhsPolyMapPlain( ocpnDC &pnt, ViewPort &vp, wxColor
                         dx = 0;
                 }
 
+                size_t size = cel->GetMemorySize();
                 cel->drawMapPlain( pnt, dx, nvp, seaColor, landColor, idl );
+                m_level->nbytes += cel->GetMemorySize() - size;     // GL vertex cache
             }
         }
     }
 
+    TrimCells( *m_level );
+
 #ifdef ocpnUSE_GL
 #ifndef USE_ANDROID_GLES2
     if(!pnt.GetDC()) { // opengl
@@ -1054,7 +1395,9 @@ void GshhsPolyReader::drawGshhsPolyMapPlain( ocpnDC &pnt, ViewPort &vp, wxColor
 //-------------------------------------------------------------------------
 void GshhsPolyReader::drawGshhsPolyMapSeaBorders( ocpnDC &pnt, ViewPort &vp )
 {
-    if( !fpoly ) return;
+    if( !m_level ) return;
+    m_frame++;
+
     int clonmin, clonmax, clatmax, clatmin;  // cellules visibles
     LLBBox bbox = vp.GetBBox();
     clonmin = bbox.GetMinLon(), clonmax = bbox.GetMaxLon(), clatmin = bbox.GetMinLat(), clatmax = bbox.GetMaxLat();
@@ -1071,18 +1414,14 @@ void GshhsPolyReader::drawGshhsPolyMapSeaBorders( ocpnDC &pnt, ViewPort &vp )
 
         for( clat = clatmin; clat < clatmax; clat++ ) {
             if( clonx >= 0 && clonx <= 359 && clat >= -90 && clat <= 89 ) {
-                if( allCells[clonx][clat + 90] == NULL ) {
-                    cel = new GshhsPolyCell( fpoly, clonx, clat, &polyHeader );
-                    wxASSERT( cel );
-                    allCells[clonx][clat + 90] = cel;
-                } else {
-                    cel = allCells[clonx][clat + 90];
-                }
+                cel = GetCell( *m_level, clonx, clat );
                 dx = clon - clonx;
                 cel->drawSeaBorderLines( pnt, dx, vp );
             }
         }
     }
+
+    TrimCells( *m_level );
 }
 
 int GshhsPolygon::readInt4()
@@ -1194,6 +1533,7 @@ GshhsReader::GshhsReader( )
 {
     maxQualityAvailable = -1;
     minQualityAvailable = -1;
+    m_last_scale = 0;
 
     for( int i=0; i<5; i++ ) {
         qualityAvailable[i] = false;
@@ -1487,6 +1827,22 @@ void GshhsReader::drawContinents( ocpnDC &pnt, ViewPort &vp, wxColor const &seaC
 {
     LoadQuality( selectBestQuality( vp ) );
     gshhsPoly_reader->drawGshhsPolyMapPlain( pnt, vp, seaColor, landColor );
+
+    //  Decode the next available level in the direction of the zoom in the
+    //  background, so that crossing a quality threshold does not stall
+    if( m_last_scale > 0 && vp.chart_scale != m_last_scale ) {
+        int next = -1;
+        if( vp.chart_scale < m_last_scale ) {
+            for( int q = quality + 1; q < 5 && next < 0; q++ )
+                if( qualityAvailable[q] ) next = q;
+        } else {
+            for( int q = quality - 1; q >= 0 && next < 0; q-- )
+                if( qualityAvailable[q] ) next = q;
+        }
+        if( next >= 0 )
+            gshhsPoly_reader->PrefetchQuality( next, vp.GetBBox() );
+    }
+    m_last_scale = vp.chart_scale;
 }
 
 //-----------------------------------------------------------------------
@@ -1577,3 +1933,28 @@ bool gshhsCrossesLand(double lat1, double lon1, double lat2, double lon2)
     wxLineF trajectWorld(lon1, lat1, lon2, lat2);
     return reader->crossing1(trajectWorld);
 }
+
+/* legs holds count tuples of lat1, lon1, lat2, lon2.  crosses[i] is set for
+   each leg, the number of legs crossing land is returned. */
+int gshhsCrossesLandBatch(int count, const double *legs, bool *crosses)
+{
+    if( ! reader ) {
+        gshhsCrossesLandInit();
+    }
+
+    int ncross = 0;
+    for(int i = 0; i < count; i++) {
+        const double *leg = legs + 4*i;
+        double lon1 = leg[1], lon2 = leg[3];
+        if(lon1 < 0)
+            lon1 += 360;
+        if(lon2 < 0)
+            lon2 += 360;
+
+        wxLineF trajectWorld(lon1, leg[0], lon2, leg[2]);
+        crosses[i] = reader->crossing1(trajectWorld);
+        if(crosses[i])
+            ncross++;
+    }
+    return ncross;
+}
@@ -38,6 +38,8 @@
 #include "OCPN_SignalKEvent.h"
 #include "datastream.h"
 #include "SerialDataStream.h"
+#include "ReplayDataStream.h"
+#include "NMEACapture.h"
 #include "wx/jsonval.h"
 #include "wx/jsonwriter.h"
 #include "wx/jsonreader.h"
@@ -59,6 +61,7 @@ Multiplexer::Multiplexer() : params_save(NULL)
 {
     m_aisconsumer = NULL;
     m_gpsconsumer = NULL;
+    m_capture = NULL;
     Connect(wxEVT_OCPN_DATASTREAM, (wxObjectEventFunction)(wxEventFunction)&Multiplexer::OnEvtStream);
     Connect( EVT_OCPN_SIGNALKSTREAM, (wxObjectEventFunction) (wxEventFunction) &Multiplexer::OnEvtSignalK );
 
@@ -72,6 +75,49 @@ Multiplexer::~Multiplexer()
     Disconnect(wxEVT_OCPN_DATASTREAM, (wxObjectEventFunction)(wxEventFunction)&Multiplexer::OnEvtStream);
     ClearStreams();
     delete m_pdatastreams;
+    StopCapture();
+}
+
+bool Multiplexer::StartCapture( const wxString &path )
+{
+    StopCapture();
+
+    m_capture = new NMEACaptureWriter;
+    if( !m_capture->Open( path ) ) {
+        delete m_capture;
+        m_capture = NULL;
+        return false;
+    }
+    return true;
+}
+
+void Multiplexer::StopCapture()
+{
+    delete m_capture;                   // flushes and closes the file
+    m_capture = NULL;
+}
+
+DataStream *Multiplexer::StartReplay( const wxString &path, double speed )
+{
+    DataStream *dstr = new ReplayDataStream( this, path, speed );
+    if( !dstr->IsOk() ) {
+        delete dstr;
+        return NULL;
+    }
+
+    AddStream( dstr );
+    return dstr;
+}
+
+bool Multiplexer::IsAISSentence( const wxString &message )
+{
+    return message.Mid(3,3).IsSameAs(_T("VDM")) ||
+           message.Mid(1,5).IsSameAs(_T("FRPOS")) ||
+           message.Mid(1,4).IsSameAs(_T("CDDS")) ||
+           message.Mid(3,3).IsSameAs(_T("TLL")) ||
+           message.Mid(3,3).IsSameAs(_T("TTM")) ||
+           message.Mid(3,3).IsSameAs(_T("OSD")) ||
+           ( g_bWplIsAprsPosition && message.Mid(3,3).IsSameAs(_T("WPL")) );
 }
 
 void Multiplexer::AddStream(DataStream *stream)
@@ -254,6 +300,10 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
     if( stream )
         port = wxString(stream->GetPort());
 
+    //  Record the raw input, but not input that is itself being replayed
+    if( m_capture && !port.StartsWith( REPLAY_PORT_PREFIX ) )
+        m_capture->Write( CAPTURE_RECORD_NMEA, port, event.GetNMEAString() );
+
     if( !message.IsEmpty() )
     {
         //Send to core consumers
@@ -264,13 +314,7 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
             bpass = stream->SentencePassesFilter( message, FILTER_INPUT );
 
         if( bpass ) {
-            if( message.Mid(3,3).IsSameAs(_T("VDM")) ||
-                message.Mid(1,5).IsSameAs(_T("FRPOS")) ||
-                message.Mid(1,4).IsSameAs(_T("CDDS")) ||
-                message.Mid(3,3).IsSameAs(_T("TLL")) ||
-                message.Mid(3,3).IsSameAs(_T("TTM")) ||
-                message.Mid(3,3).IsSameAs(_T("OSD")) ||
-                ( g_bWplIsAprsPosition && message.Mid(3,3).IsSameAs(_T("WPL")) ) )
+            if( IsAISSentence( message ) )
             {
                 if( m_aisconsumer )
                     m_aisconsumer->AddPendingEvent(event);
@@ -353,6 +397,12 @@ void Multiplexer::OnEvtStream(OCPN_DataStreamEvent& event)
 
 void Multiplexer::OnEvtSignalK(OCPN_SignalKEvent &event)
 {
+    //  Record the raw input, but not input that is itself being replayed
+    const wxString &stream_name = event.GetStreamName();
+    if( m_capture && !stream_name.StartsWith( REPLAY_PORT_PREFIX ) )
+        m_capture->Write( CAPTURE_RECORD_SIGNALK, stream_name.IsEmpty() ? wxString( _T("SignalK") ) : stream_name,
+                          event.GetString() );
+
     if( m_aisconsumer )
         m_aisconsumer->AddPendingEvent(event);
     if( m_gpsconsumer )
@@ -132,6 +132,7 @@ extern wxString         g_UserPresLibData;
 extern wxString         *pInit_Chart_Dir;
 extern wxString         gWorldMapLocation;
 extern WayPointman      *pWayPointMan;
+extern Routeman         *g_pRouteMan;
 
 extern bool             s_bSetSystemTime;
 extern bool             g_bDisplayGrid;         //Flag indicating if grid is to be displayed
@@ -1617,8 +1618,8 @@ void MyConfig::LoadNavObjects()
 
     int wpt_dups = 0;
     if( ::wxFileExists( m_sNavObjSetFile ) &&
-        m_pNavObjectInputSet->load_file( m_sNavObjSetFile.fn_str() ) )
-        m_pNavObjectInputSet->LoadAllGPXObjects(false, wpt_dups);
+        m_pNavObjectInputSet->OpenGPXStream( m_sNavObjSetFile ) )
+        m_pNavObjectInputSet->LoadAllGPXStreamObjects(false, wpt_dups);
 
     wxLogMessage( _T("Done loading navobjects, %d duplicate waypoints ignored"), wpt_dups );
     delete m_pNavObjectInputSet;
@@ -3096,9 +3097,9 @@ void UI_ImportGPX( wxWindow* parent, bool islayer, wxString dirpath, bool isdire
             if( ::wxFileExists( path ) ) {
 
                 NavObjectCollection1 *pSet = new NavObjectCollection1;
-                pSet->load_file(path.fn_str());
 
                 if(islayer){
+                    pSet->load_file(path.fn_str());
                     l->m_NoOfItems = pSet->LoadAllGPXObjectsAsLayer(l->m_LayerID, l->m_bIsVisibleOnChart, l->m_bHasVisibleNames);
                     l->m_LayerType = isPersistent ? _("Persistent") : _("Temporary") ;
                     
@@ -3129,7 +3130,8 @@ void UI_ImportGPX( wxWindow* parent, bool islayer, wxString dirpath, bool isdire
                 }
                 else {
                     int wpt_dups;
-                    pSet->LoadAllGPXObjects( !pSet->IsOpenCPN(), wpt_dups ); // Import with full visibility of names and objects
+                    pSet->OpenGPXStream( path );
+                    pSet->LoadAllGPXStreamObjects( !pSet->IsOpenCPN(), wpt_dups ); // Import with full visibility of names and objects
                     if(wpt_dups > 0) {
                         OCPNMessageBox(parent, wxString::Format(_T("%d ")+_("duplicate waypoints detected during import and ignored."), wpt_dups), _("OpenCPN Info"), wxICON_INFORMATION|wxOK, 10);
                     }
@@ -3183,41 +3185,12 @@ void SwitchInlandEcdisMode( bool Switch )
 //-------------------------------------------------------------------------
 RoutePoint *WaypointExists( const wxString& name, double lat, double lon )
 {
-    RoutePoint *pret = NULL;
-//    if( g_bIsNewLayer ) return NULL;
-    wxRoutePointListNode *node = pWayPointMan->GetWaypointList()->GetFirst();
-    while( node ) {
-        RoutePoint *pr = node->GetData();
-
-//        if( pr->m_bIsInLayer ) return NULL;
-
-        if( name == pr->GetName() ) {
-            if( fabs( lat - pr->m_lat ) < 1.e-6 && fabs( lon - pr->m_lon ) < 1.e-6 ) {
-                pret = pr;
-                break;
-            }
-        }
-        node = node->GetNext();
-    }
-
-    return pret;
+    return pWayPointMan->FindRoutePointByNamePosition( name, lat, lon );
 }
 
 RoutePoint *WaypointExists( const wxString& guid )
 {
-    wxRoutePointListNode *node = pWayPointMan->GetWaypointList()->GetFirst();
-    while( node ) {
-        RoutePoint *pr = node->GetData();
-
-//        if( pr->m_bIsInLayer ) return NULL;
-
-        if( guid == pr->m_GUID ) {
-            return pr;
-        }
-        node = node->GetNext();
-    }
-
-    return NULL;
+    return pWayPointMan->FindRoutePointByGUID( guid );
 }
 
 bool WptIsInRouteList( RoutePoint *pr )
@@ -3249,16 +3222,7 @@ bool WptIsInRouteList( RoutePoint *pr )
 
 Route *RouteExists( const wxString& guid )
 {
-    wxRouteListNode *route_node = pRouteList->GetFirst();
-
-    while( route_node ) {
-        Route *proute = route_node->GetData();
-
-        if( guid == proute->m_GUID ) return proute;
-
-        route_node = route_node->GetNext();
-    }
-    return NULL;
+    return g_pRouteMan->FindRouteByGUID( guid );
 }
 
 Route *RouteExists( Route * pTentRoute )
@@ -3277,16 +3241,7 @@ Route *RouteExists( Route * pTentRoute )
 
 Track *TrackExists( const wxString& guid )
 {
-    wxTrackListNode *track_node = pTrackList->GetFirst();
-
-    while( track_node ) {
-        Track *ptrack = track_node->GetData();
-
-        if( guid == ptrack->m_GUID ) return ptrack;
-
-        track_node = track_node->GetNext();
-    }
-    return NULL;
+    return g_pRouteMan->FindTrackByGUID( guid );
 }
 
 
@@ -1398,6 +1398,7 @@ bool PlugInManager::CallLateInit(void)
             case 115:
             case 116:
             case 117:
+            case 118:
                 ProcessLateInit(pic);
                 break;
         }
@@ -1440,6 +1441,7 @@ void PlugInManager::SendVectorChartObjectInfo(const wxString &chart, const wxStr
                 case 115:
                 case 116:
                 case 117:
+                case 118:
                 {
                     opencpn_plugin_112 *ppi = dynamic_cast<opencpn_plugin_112 *>(pic->m_pplugin);
                     if(ppi)
@@ -2387,6 +2389,7 @@ PlugInContainer *PlugInManager::LoadPlugIn(wxString plugin_file)
         break;
 
     case 117:
+    case 118:
         pic->m_pplugin = dynamic_cast<opencpn_plugin_117*>(plug_in);
         do /* force a local scope */ {
             auto p = dynamic_cast<opencpn_plugin_117*>(plug_in);
@@ -2468,6 +2471,7 @@ bool PlugInManager::RenderAllCanvasOverlayPlugIns( ocpnDC &dc, const ViewPort &v
                         }
                         case 116:
                         case 117:
+                        case 118:
                         {
                             opencpn_plugin_18 *ppi = dynamic_cast<opencpn_plugin_18 *>(pic->m_pplugin);
                             if (ppi) {
@@ -2533,6 +2537,7 @@ bool PlugInManager::RenderAllCanvasOverlayPlugIns( ocpnDC &dc, const ViewPort &v
                         }
                         case 116:
                         case 117:
+                        case 118:
                         {
                             opencpn_plugin_18 *ppi = dynamic_cast<opencpn_plugin_18 *>(pic->m_pplugin);
                             if (ppi) {
@@ -2608,6 +2613,7 @@ bool PlugInManager::RenderAllGLCanvasOverlayPlugIns( wxGLContext *pcontext, cons
                     }
                     case 116:
                     case 117:
+                    case 118:
                     {
                         opencpn_plugin_18 *ppi = dynamic_cast<opencpn_plugin_18 *>(pic->m_pplugin);
                         if (ppi) {
@@ -2647,6 +2653,7 @@ bool PlugInManager::SendMouseEventToPlugins( wxMouseEvent &event)
                     case 115:
                     case 116:
                     case 117:
+                    case 118:
                     {
                         opencpn_plugin_112 *ppi = dynamic_cast<opencpn_plugin_112*>(pic->m_pplugin);
                         if(ppi)
@@ -2681,6 +2688,7 @@ bool PlugInManager::SendKeyEventToPlugins( wxKeyEvent &event)
                         case 115:
                         case 116: 
                         case 117:
+                        case 118:
                         {
                             opencpn_plugin_113 *ppi = dynamic_cast<opencpn_plugin_113*>(pic->m_pplugin);
                             if(ppi && ppi->KeyboardEventHook( event ))
@@ -2745,6 +2753,7 @@ void NotifySetupOptionsPlugin( PlugInContainer *pic )
             case 115:
             case 116:    
             case 117:
+            case 118:
             {
                 opencpn_plugin_19 *ppi = dynamic_cast<opencpn_plugin_19 *>(pic->m_pplugin);
                 if(ppi) {
@@ -2931,6 +2940,7 @@ void PlugInManager::SendMessageToAllPlugins(const wxString &message_id, const wx
                 case 115:
                 case 116:
                 case 117:
+                case 118:
                 {
                     opencpn_plugin_18 *ppi = dynamic_cast<opencpn_plugin_18 *>(pic->m_pplugin);
                     if(ppi)
@@ -3013,6 +3023,7 @@ void PlugInManager::SendPositionFixToAllPlugIns(GenericPosDatEx *ppos)
                 case 115:
                 case 116:
                 case 117:
+                case 118:
                 {
                     opencpn_plugin_18 *ppi = dynamic_cast<opencpn_plugin_18 *>(pic->m_pplugin);
                     if(ppi)
@@ -3055,6 +3066,7 @@ void PlugInManager::SendActiveLegInfoToAllPlugIns(ActiveLegDat *leg_info)
         case 116:
           break;
         case 117:
+        case 118:
         {
           opencpn_plugin_117 *ppi = dynamic_cast<opencpn_plugin_117 *>(pic->m_pplugin);
           if (ppi)
@@ -3104,6 +3116,7 @@ void PlugInManager::PrepareAllPluginContextMenus()
                 {
                     case 116:
                     case 117:
+                    case 118:
                     {
                         opencpn_plugin_116 *ppi = dynamic_cast<opencpn_plugin_116 *>(pic->m_pplugin);
                         if(ppi)
@@ -4243,6 +4256,17 @@ bool PlugIn_GSHHS_CrossesLand(double lat1, double lon1, double lat2, double lon2
     return gshhsCrossesLand(lat1, lon1, lat2, lon2);
 }
 
+int PlugIn_GSHHS_CrossesLandBatch(int count, const double *legs, bool *crosses)
+{
+    static bool loaded = false;
+    if(!loaded) {
+        gshhsCrossesLandInit();
+        loaded = true;
+    }
+
+    return gshhsCrossesLandBatch(count, legs, crosses);
+}
+
 
 void PlugInPlaySound(wxString& sound_file)
 {
@@ -4447,8 +4471,7 @@ bool UpdateSingleWaypoint( PlugIn_Waypoint *pwaypoint )
 
         SelectItem *pFind = pSelect->FindSelection( gFrame->GetPrimaryCanvas(), lat_save, lon_save, SELTYPE_ROUTEPOINT );
         if( pFind ) {
-            pFind->m_slat = pwaypoint->m_lat;             // update the SelectList entry
-            pFind->m_slon = pwaypoint->m_lon;
+            pSelect->ModifySelectItem( pFind, pwaypoint->m_lat, pwaypoint->m_lon );    // update the SelectList entry
         }
 
         if(!prp->m_btemp)
@@ -172,6 +172,8 @@ Routeman::Routeman( MyApp *parent )
     pActiveRoute = NULL;
     pActivePoint = NULL;
     pRouteActivatePoint = NULL;
+    m_nindexed_routes = 0;
+    m_nindexed_tracks = 0;
 }
 
 Routeman::~Routeman()
@@ -906,6 +908,7 @@ bool Routeman::DeleteRoute( Route *pRoute )
         //    Remove the route from associated lists
         pSelect->DeleteAllSelectableRouteSegments( pRoute );
         pRouteList->DeleteObject( pRoute );
+        InvalidateGUIDIndex();
 
         // walk the route, tentatively deleting/marking points used only by this route
         wxRoutePointListNode *pnode = ( pRoute->pRoutePointList )->GetFirst();
@@ -1034,6 +1037,7 @@ void Routeman::DeleteTrack( Track *pTrack )
         //    Remove the track from associated lists
         pSelect->DeleteAllSelectableTrackSegments( pTrack );
         pTrackList->DeleteObject( pTrack );
+        InvalidateGUIDIndex();
 
 #if 0
         // walk the track, deleting points used by this track
@@ -1119,32 +1123,80 @@ wxString Routeman::GetRouteReverseMessage( void )
 
 Route *Routeman::FindRouteByGUID(const wxString &guid)
 {
-    wxRouteListNode *node1 = pRouteList->GetFirst();
-    while( node1 ) {
-        Route *pRoute = node1->GetData();
-        
-        if( pRoute->m_GUID == guid )
-            return pRoute;
-        node1 = node1->GetNext();
-    }
- 
+    if( m_nindexed_routes != pRouteList->GetCount() )
+        IndexNewRoutes();
+
+    RouteGUIDHash::iterator it = m_route_guid_index.find( guid );
+    if( it != m_route_guid_index.end() && it->second->m_GUID == guid )
+        return it->second;
+
     return NULL;
 }
 
 Track *Routeman::FindTrackByGUID(const wxString &guid)
 {
-    wxTrackListNode *node1 = pTrackList->GetFirst();
-    while( node1 ) {
-        Track *pTrack = node1->GetData();
-        
-        if( pTrack->m_GUID == guid )
-            return pTrack;
-        node1 = node1->GetNext();
-    }
- 
+    if( m_nindexed_tracks != pTrackList->GetCount() )
+        IndexNewTracks();
+
+    TrackGUIDHash::iterator it = m_track_guid_index.find( guid );
+    if( it != m_track_guid_index.end() && it->second->m_GUID == guid )
+        return it->second;
+
     return NULL;
 }
 
+void Routeman::InvalidateGUIDIndex()
+{
+    m_route_guid_index.clear();
+    m_nindexed_routes = 0;
+    m_track_guid_index.clear();
+    m_nindexed_tracks = 0;
+}
+
+//    Index the routes appended since the last lookup.
+//    The first route in the list wins if GUIDs are duplicated.
+void Routeman::IndexNewRoutes()
+{
+    size_t count = pRouteList->GetCount();
+    if( count < m_nindexed_routes ) {
+        m_route_guid_index.clear();
+        m_nindexed_routes = 0;
+    }
+
+    wxRouteListNode *node = pRouteList->GetLast();
+    for( size_t n = count - m_nindexed_routes; node && n > 1; n-- )
+        node = node->GetPrevious();
+
+    while( node ) {
+        Route *pRoute = node->GetData();
+        if( m_route_guid_index.find( pRoute->m_GUID ) == m_route_guid_index.end() )
+            m_route_guid_index[pRoute->m_GUID] = pRoute;
+        node = node->GetNext();
+    }
+    m_nindexed_routes = count;
+}
+
+void Routeman::IndexNewTracks()
+{
+    size_t count = pTrackList->GetCount();
+    if( count < m_nindexed_tracks ) {
+        m_track_guid_index.clear();
+        m_nindexed_tracks = 0;
+    }
+
+    wxTrackListNode *node = pTrackList->GetLast();
+    for( size_t n = count - m_nindexed_tracks; node && n > 1; n-- )
+        node = node->GetPrevious();
+
+    while( node ) {
+        Track *pTrack = node->GetData();
+        if( m_track_guid_index.find( pTrack->m_GUID ) == m_track_guid_index.end() )
+            m_track_guid_index[pTrack->m_GUID] = pTrack;
+        node = node->GetNext();
+    }
+    m_nindexed_tracks = count;
+}
+
 void Routeman::ZeroCurrentXTEToActivePoint()
 {
     // When zeroing XTE create a "virtual" waypoint at present position
@@ -1223,6 +1275,8 @@ bool WayPointman::AddRoutePoint(RoutePoint *prp)
     
     wxRoutePointListNode *prpnode = m_pWayPointList->Append(prp);
     prp->SetManagerListNode( prpnode );
+
+    IndexRoutePoint( prp );
     
     return true;
 }
@@ -1240,10 +1294,137 @@ bool WayPointman::RemoveRoutePoint(RoutePoint *prp)
         m_pWayPointList->DeleteObject(prp);
     
     prp->SetManagerListNode( NULL );
+
+    UnindexRoutePoint( prp );
     
     return true;
 }
 
+//    The (name, lat, lon) index quantises positions to cells of
+//    ROUTEPOINT_INDEX_CELL degrees, well above the match tolerance
+//    so that a lookup probes at most four cells.
+#define ROUTEPOINT_INDEX_CELL   1.e-4
+#define ROUTEPOINT_MATCH_TOL    1.e-6
+
+static long RoutePointIndexCell( double coord )
+{
+    return (long) floor( coord / ROUTEPOINT_INDEX_CELL );
+}
+
+static size_t RoutePointIndexKey( const wxString &name, long ilat, long ilon )
+{
+    size_t key = wxStringHash()( name );
+    key = key * 1000003 + (size_t) ilat;
+    key = key * 1000003 + (size_t) ilon;
+    return key;
+}
+
+void WayPointman::IndexRoutePoint( RoutePoint *prp )
+{
+    if( m_guid_index.find( prp->m_GUID ) == m_guid_index.end() )
+        m_guid_index[prp->m_GUID] = prp;
+    m_guid_count[prp->m_GUID]++;
+
+    size_t key = RoutePointIndexKey( prp->GetName(), RoutePointIndexCell( prp->m_lat ),
+                                     RoutePointIndexCell( prp->m_lon ) );
+    m_position_index.insert( std::make_pair( key, prp ) );
+    m_point_key[prp] = key;
+}
+
+void WayPointman::UnindexRoutePoint( RoutePoint *prp )
+{
+    std::unordered_map<RoutePoint*, size_t>::iterator itk = m_point_key.find( prp );
+    if( itk == m_point_key.end() )
+        return;
+
+    //    If other points share this GUID, hand the entry to the first of them
+    //    still in the list, as FindRoutePointByGUID() did before the index
+    RoutePointGUIDCount::iterator itc = m_guid_count.find( prp->m_GUID );
+    bool b_shared = false;
+    if( itc != m_guid_count.end() ) {
+        if( --itc->second > 0 )
+            b_shared = true;
+        else
+            m_guid_count.erase( itc );
+    }
+
+    RoutePointGUIDHash::iterator itg = m_guid_index.find( prp->m_GUID );
+    if( itg != m_guid_index.end() && itg->second == prp ) {
+        m_guid_index.erase( itg );
+        if( b_shared ) {
+            for( wxRoutePointListNode *node = m_pWayPointList->GetFirst(); node; node = node->GetNext() ) {
+                RoutePoint *pr = node->GetData();
+                if( pr != prp && pr->m_GUID == prp->m_GUID && m_point_key.count( pr ) ) {
+                    m_guid_index[prp->m_GUID] = pr;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::pair<std::unordered_multimap<size_t, RoutePoint*>::iterator,
+              std::unordered_multimap<size_t, RoutePoint*>::iterator> range =
+            m_position_index.equal_range( itk->second );
+    for( std::unordered_multimap<size_t, RoutePoint*>::iterator it = range.first; it != range.second; ++it ) {
+        if( it->second == prp ) {
+            m_position_index.erase( it );
+            break;
+        }
+    }
+    m_point_key.erase( itk );
+}
+
+//    Re-key a managed point after its name or position has changed
+void WayPointman::UpdateRoutePointIndex( RoutePoint *prp )
+{
+    std::unordered_map<RoutePoint*, size_t>::iterator itk = m_point_key.find( prp );
+    if( itk == m_point_key.end() )
+        return;
+
+    size_t key = RoutePointIndexKey( prp->GetName(), RoutePointIndexCell( prp->m_lat ),
+                                     RoutePointIndexCell( prp->m_lon ) );
+    if( key == itk->second )
+        return;
+
+    UnindexRoutePoint( prp );
+    IndexRoutePoint( prp );
+}
+
+//    Positions are also written directly to RoutePoint::m_lat/m_lon,
+//    bypassing SetPosition(), so bulk loaders resync the index first.
+void WayPointman::SyncRoutePointIndex( void )
+{
+    wxRoutePointListNode *node = m_pWayPointList->GetFirst();
+    while( node ) {
+        UpdateRoutePointIndex( node->GetData() );
+        node = node->GetNext();
+    }
+}
+
+RoutePoint *WayPointman::FindRoutePointByNamePosition( const wxString &name, double lat, double lon )
+{
+    long ilat0 = RoutePointIndexCell( lat - ROUTEPOINT_MATCH_TOL );
+    long ilat1 = RoutePointIndexCell( lat + ROUTEPOINT_MATCH_TOL );
+    long ilon0 = RoutePointIndexCell( lon - ROUTEPOINT_MATCH_TOL );
+    long ilon1 = RoutePointIndexCell( lon + ROUTEPOINT_MATCH_TOL );
+
+    for( long ilat = ilat0; ilat <= ilat1; ilat++ ) {
+        for( long ilon = ilon0; ilon <= ilon1; ilon++ ) {
+            std::pair<std::unordered_multimap<size_t, RoutePoint*>::iterator,
+                      std::unordered_multimap<size_t, RoutePoint*>::iterator> range =
+                    m_position_index.equal_range( RoutePointIndexKey( name, ilat, ilon ) );
+            for( std::unordered_multimap<size_t, RoutePoint*>::iterator it = range.first; it != range.second; ++it ) {
+                RoutePoint *pr = it->second;
+                if( name == pr->GetName() && fabs( lat - pr->m_lat ) < ROUTEPOINT_MATCH_TOL
+                        && fabs( lon - pr->m_lon ) < ROUTEPOINT_MATCH_TOL )
+                    return pr;
+            }
+        }
+    }
+
+    return NULL;
+}
+
 void WayPointman::ProcessUserIcons( ocpnStyle::Style* style )
 {
     wxString msg;
@@ -2172,14 +2353,9 @@ wxString WayPointman::CreateGUID( RoutePoint *pRP )
 
 RoutePoint *WayPointman::FindRoutePointByGUID(const wxString &guid)
 {
-    wxRoutePointListNode *prpnode = m_pWayPointList->GetFirst();
-    while( prpnode ) {
-        RoutePoint *prp = prpnode->GetData();
-
-        if( prp->m_GUID == guid ) return ( prp );
-
-        prpnode = prpnode->GetNext(); //RoutePoint
-    }
+    RoutePointGUIDHash::iterator it = m_guid_index.find( guid );
+    if( it != m_guid_index.end() && it->second->m_GUID == guid )
+        return it->second;
 
     return NULL;
 }
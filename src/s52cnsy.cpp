@@ -311,23 +311,6 @@ bool GetStringAttr(S57Obj *obj, const char *AttrName, char *pval, int nc)
         return false;
 }
 
-wxString *GetStringAttrWXS(S57Obj *obj, const char *AttrName)
-{
-    int idx = obj->GetAttributeIndex(AttrName);
-    
-    if(idx >= 0) {
-        //      using idx to get the attribute value
-        S57attVal *v = obj->attVal->Item(idx);
-        
-        assert(v->valType == OGR_STR);
-        char *val = (char *)(v->value);
-        
-        return new wxString(val,  wxConvUTF8);
-    }
-    else
-        return NULL;
-}
-
 static int      _parseList(const char *str_in, char *buf, int buf_size)
 // Put a string of comma delimited number in an array (buf).
 // Return: the number of value in buf.
@@ -1901,7 +1884,7 @@ static void *OBSTRN04 (void *param)
       wxString *quapnt01str = NULL;
 
       GetDoubleAttr(obj, "VALSOU", valsou);
-      wxString *objName = GetStringAttrWXS(obj, "OBJNAM");
+      const char *objName = obj->GetAttrString("OBJNAM");
 
       if (valsou != UNKNOWN)
       {
@@ -2552,13 +2535,13 @@ static void *RESARE02(void *param)
 
     wxString resare02;
 
-    wxString *restrnstr = GetStringAttrWXS(obj, "RESTRN");
+    const char *restrnstr = obj->GetAttrString("RESTRN");
 //    GString *restrnstr        = S57_getAttVal(geo, "RESTRN");
 
 
     char     restrn[LISTSIZE] = {'\0'};
 //    GString *catreastr        = S57_getAttVal(geo, "CATREA");
-    wxString *catreastr = GetStringAttrWXS(obj, "CATREA");
+    const char *catreastr = obj->GetAttrString("CATREA");
 
     char     catrea[LISTSIZE] = {'\0'};
     wxString symb;
@@ -2566,10 +2549,10 @@ static void *RESARE02(void *param)
     wxString prio;
 
     if (NULL != catreastr)
-          _parseList(catreastr->mb_str(), catrea, sizeof(catrea));
+          _parseList(catreastr, catrea, sizeof(catrea));
 
     if ( NULL != restrnstr) {
-          _parseList(restrnstr->mb_str(), restrn, sizeof(restrn));
+          _parseList(restrnstr, restrn, sizeof(restrn));
 
 
         if (strpbrk(restrn, "\007\010\016")) {                          // entry restrictions
@@ -2699,9 +2682,6 @@ static void *RESARE02(void *param)
     char *r = (char *)malloc(resare02.Len() + 1);
     strcpy(r, resare02.mb_str());
 
-    delete restrnstr;
-    delete catreastr;
-
     return r;
 }
 
@@ -2738,7 +2718,7 @@ static void *RESTRN01 (void *param)
     ObjRazRules *rzRules = (ObjRazRules *)param;
     S57Obj *obj = rzRules->obj;
 
-    wxString *restrnstr = GetStringAttrWXS(obj, "RESTRN");
+    const char *restrnstr = obj->GetAttrString("RESTRN");
 
 //    GString *restrn01str = S57_getAttVal(geo, "RESTRN");
     char *restrn01    = NULL;
@@ -2748,7 +2728,6 @@ static void *RESTRN01 (void *param)
     else
         restrn01 = NULL;
 
-    delete restrnstr;
     return restrn01;
 }
 
@@ -2760,14 +2739,14 @@ static void *_RESCSP01(void *param)
 
     wxString rescsp01;
 //    char *rescsp01         = NULL;
-    wxString *restrnstr = GetStringAttrWXS(obj, "RESTRN");
+    const char *restrnstr = obj->GetAttrString("RESTRN");
 //    GString *restrnstr        = S57_getAttVal(geo, "RESTRN");
     char     restrn[LISTSIZE] = {'\0'};   // restriction list
     wxString symb;
     char    *r = NULL;
 
-    if ( restrnstr->Len()) {
-          _parseList(restrnstr->mb_str(), restrn, sizeof(restrn));
+    if ( strlen(restrnstr)) {
+          _parseList(restrnstr, restrn, sizeof(restrn));
 
         if (strpbrk(restrn, "\007\010\016")) {
             // continuation A
@@ -2817,8 +2796,6 @@ static void *_RESCSP01(void *param)
 
         r = (char *)malloc(rescsp01.Len() + 1);
         strcpy(r, rescsp01.mb_str());
-
-        delete restrnstr;
     }
 
     return r;
@@ -2893,14 +2870,14 @@ wxString SNDFRM02(S57Obj *obj, double depth_value_in)
     
     char symbol_prefix_a[200];
     
-    wxString *tecsoustr = GetStringAttrWXS(obj, "TECSOU");
+    const char *tecsoustr = obj->GetAttrString("TECSOU");
     char     tecsou[LISTSIZE] = {'\0'};
     
-    wxString *quasoustr = GetStringAttrWXS(obj, "QUASOU");
+    const char *quasoustr = obj->GetAttrString("QUASOU");
     char     quasou[LISTSIZE] = {'\0'};
     
     
-    wxString *statusstr = GetStringAttrWXS(obj, "STATUS");
+    const char *statusstr = obj->GetAttrString("STATUS");
     char     status[LISTSIZE] = {'\0'};
     
     double   leading_digit    = 0.0;
@@ -2944,7 +2921,7 @@ wxString SNDFRM02(S57Obj *obj, double depth_value_in)
     
     if (NULL != tecsoustr)
     {
-        _parseList(tecsoustr->mb_str(), tecsou, sizeof(tecsou));
+        _parseList(tecsoustr, tecsou, sizeof(tecsou));
         if (strpbrk(tecsou, "\006"))
         {
             chk_snprintf(temp_str, LISTSIZE, ";SY(%sB1)", symbol_prefix_a);
@@ -2952,8 +2929,8 @@ wxString SNDFRM02(S57Obj *obj, double depth_value_in)
         }
     }
     
-    if (NULL != quasoustr) _parseList(quasoustr->mb_str(), quasou, sizeof(quasou));
-    if (NULL != statusstr) _parseList(statusstr->mb_str(), status, sizeof(status));
+    if (NULL != quasoustr) _parseList(quasoustr, quasou, sizeof(quasou));
+    if (NULL != statusstr) _parseList(statusstr, status, sizeof(status));
     
     if (strpbrk(quasou, "\003\004\005\010\011") || strpbrk(status, "\022"))
     {
@@ -3160,10 +3137,6 @@ wxString SNDFRM02(S57Obj *obj, double depth_value_in)
     return_point:
     sndfrm02.Append('\037');
     
-    delete tecsoustr;
-    delete quasoustr;
-    delete statusstr;
-    
     return sndfrm02;
 }
 
@@ -3375,7 +3348,7 @@ static void *WRECKS02 (void *param)
 
     int quasou = -9;
     // QUASOU is a list ie a string for us
-    wxString *quasoustr = GetStringAttrWXS(obj, "QUASOU");
+    const char *quasoustr = obj->GetAttrString("QUASOU");
     char     quasouchar[LISTSIZE] = {'\0'};
 
     double safety_contour = S52_getMarinerParam(S52_MAR_SAFETY_CONTOUR);
@@ -3458,7 +3431,7 @@ static void *WRECKS02 (void *param)
 
 
     }
-    if (NULL != quasoustr) _parseList(quasoustr->mb_str(), quasouchar, sizeof(quasouchar));
+    if (NULL != quasoustr) _parseList(quasoustr, quasouchar, sizeof(quasouchar));
 
     if (quasouchar[0] == 0 || NULL == strpbrk(quasouchar, "\07"))
     {
@@ -3626,7 +3599,6 @@ static void *WRECKS02 (void *param)
 
     delete udwhaz03str;
     delete quapnt01str;
-    delete quasoustr;
     return r;
 }
 
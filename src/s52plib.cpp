@@ -33,6 +33,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <algorithm>
 
 #include "config.h"
 
@@ -287,11 +288,26 @@ int CompareLUPObjects( LUPrec *item1, LUPrec *item2 )
 //-----------------------------------------------------------------------------
 //      LUPArrayContainer implementation
 //-----------------------------------------------------------------------------
+#define LUP_CLASS_HASH_MUL0     0x9E3779B97F4A7C15ULL
+
+//  Odd multipliers for the second level of the class hash, from splitmix64
+static uint64_t LUPHashMultiplier( unsigned int seed )
+{
+    uint64_t z = ( (uint64_t) seed + 1 ) * 0x9E3779B97F4A7C15ULL;
+    z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+    return ( z ^ ( z >> 31 ) ) | 1;
+}
+
 LUPArrayContainer::LUPArrayContainer()
 {
     //   Build the initially empty sorted arrays of LUP Records, per LUP type.
     //   Sorted on object name, e.g. ACHARE.  Why sorted?  Helps in the S52_LUPLookup method....
     LUPArray = new wxArrayOfLUPrec( CompareLUPObjects );
+
+    m_bucketShift = 63;
+    m_noClass.n_start = -1;
+    m_noClass.count = 0;
 }
 
 LUPArrayContainer::~LUPArrayContainer()
@@ -303,68 +319,164 @@ LUPArrayContainer::~LUPArrayContainer()
         LUPArray->Clear();
         delete LUPArray;
     }
-    
-    LUPArrayIndexHash::iterator it;
-    for( it = IndexHash.begin(); it != IndexHash.end(); ++it ){
-        free( it->second );
-    }
 }
 
-LUPHashIndex *LUPArrayContainer::GetArrayIndexHelper( const char *objectName )
+void LUPArrayContainer::BuildIndex( void )
 {
-    // Look for the key
-    wxString key(objectName, wxConvUTF8);
-    LUPArrayIndexHash::iterator it = IndexHash.find( key );
-    
-    if( it == IndexHash.end() ){             
-        //      Key not found, needs to be added
-        LUPHashIndex *pindex = (LUPHashIndex *)malloc(sizeof(LUPHashIndex));
-        pindex->n_start = -1;
-        pindex->count = 0;
-        IndexHash[key] = pindex;
-        
-        //      Find the first matching entry in the LUP Array
-        int index = 0;
-        int index_max = LUPArray->GetCount();
-        int first_match = 0;
-        int ocnt = 0;
-        LUPrec *LUPCandidate;
-        
-        //        This technique of extracting proper LUPs depends on the fact that
-        //        the LUPs have been sorted in their array, by OBCL.
-        //        Thus, all the LUPS with the same OBCL will be grouped together
-        
-        while( !first_match && ( index < index_max ) ) {
-            LUPCandidate = LUPArray->Item( index );
-            if( !strcmp( objectName, LUPCandidate->OBCL ) ) {
-                pindex->n_start = index;
-                first_match = 1;
-                ocnt++;
-                index++;
-                break;
+    m_classBuckets.clear();
+    m_classSlots.clear();
+    m_attMatches.clear();
+    m_attMatchStart.clear();
+
+    //  Find the range of each object class.
+    //  This depends on the fact that the LUPs have been sorted in their array, by OBCL.
+    //  Within a class they stay in match order, most attributes first.
+    std::vector<S57AttrCode> codes;
+    std::vector<LUPHashIndex> ranges;
+
+    for( unsigned int i = 0; i < LUPArray->GetCount(); i++ ) {
+        LUPrec *LUP = LUPArray->Item( i );
+
+        if( i && !strcmp( LUP->OBCL, LUPArray->Item( i - 1 )->OBCL ) )
+            ranges.back().count++;
+        else {
+            LUPHashIndex range;
+            range.n_start = i;
+            range.count = 1;
+            codes.push_back( S57AttrCodeFromAcronym( LUP->OBCL ) );
+            ranges.push_back( range );
+        }
+
+        //  Parse the attribute conditions, so FindBestLUP only compares values
+        m_attMatchStart.push_back( m_attMatches.size() );
+        for( unsigned int j = 0; j < LUP->ATTArray.size(); j++ ) {
+            char *slatc = LUP->ATTArray[j];
+
+            LUPAttMatch match;
+            match.code = 0;
+            match.type = LUPATT_SKIP;
+            match.ival = 0;
+            match.fval = 0;
+            match.sval = NULL;
+
+            if( slatc && ( strlen( slatc ) >= 6 ) ) {
+                match.code = S57AttrCodeFromAcronym( slatc );
+                match.sval = slatc + 6;
+
+                if( match.sval[0] == ' ' )
+                    match.type = LUPATT_ANY;
+                else if( match.sval[0] == '?' )
+                    match.type = LUPATT_UNDEFINED;
+                else {
+                    match.type = LUPATT_VALUE;
+                    match.ival = atoi( match.sval );
+                    match.fval = atof( match.sval );
+                }
             }
-            index++;
+
+            m_attMatches.push_back( match );
         }
-        
-        while( first_match && ( index < index_max ) ) {
-            LUPCandidate = LUPArray->Item( index );
-            if( !strcmp( objectName, LUPCandidate->OBCL ) ) {
-                ocnt++;
-            } else {
-                break;
+    }
+
+    if( codes.empty() )
+        return;
+
+    //  Two level perfect hash of the class codes.
+    //  The first level spreads the classes over buckets, each bucket then gets
+    //  a slot table of at least the square of its size, and a multiplier
+    //  that places its classes without collision.
+    int n_buckets = 2;
+    int bits = 1;
+    while( n_buckets < (int) codes.size() ) {
+        n_buckets <<= 1;
+        bits++;
+    }
+    m_bucketShift = 64 - bits;
+
+    std::vector< std::vector<int> > members( n_buckets );
+    for( unsigned int k = 0; k < codes.size(); k++ )
+        members[( codes[k] * LUP_CLASS_HASH_MUL0 ) >> m_bucketShift].push_back( k );
+
+    m_classBuckets.resize( n_buckets );
+    for( int b = 0; b < n_buckets; b++ ) {
+        LUPClassBucket &bucket = m_classBuckets[b];
+        int n_keys = members[b].size();
+
+        bucket.mul = 0;
+        bucket.shift = 0;
+        bucket.first_slot = m_classSlots.size();
+        bucket.n_slots = 0;
+
+        if( !n_keys )
+            continue;
+
+        int n_slots = 1;
+        int slot_bits = 0;
+        while( n_slots < n_keys * n_keys ) {
+            n_slots <<= 1;
+            slot_bits++;
+        }
+        bucket.n_slots = n_slots;
+
+        if( n_slots > 1 ) {
+            bucket.shift = 64 - slot_bits;
+
+            std::vector<bool> used( n_slots );
+            for( unsigned int seed = 0; ; seed++ ) {
+                bucket.mul = LUPHashMultiplier( seed );
+                std::fill( used.begin(), used.end(), false );
+
+                bool b_collision = false;
+                for( int k = 0; k < n_keys; k++ ) {
+                    int slot = ( codes[members[b][k]] * bucket.mul ) >> bucket.shift;
+                    if( used[slot] ) {
+                        b_collision = true;
+                        break;
+                    }
+                    used[slot] = true;
+                }
+                if( !b_collision )
+                    break;
             }
-            
-            index++;
         }
-        
-        pindex->count = ocnt;
-        
-        return pindex;
+
+        LUPClassSlot empty;
+        empty.code = 0;
+        empty.index = m_noClass;
+        m_classSlots.resize( bucket.first_slot + n_slots, empty );
+
+        for( int k = 0; k < n_keys; k++ ) {
+            S57AttrCode code = codes[members[b][k]];
+            int slot = bucket.first_slot;
+            if( n_slots > 1 )
+                slot += ( code * bucket.mul ) >> bucket.shift;
+
+            m_classSlots[slot].code = code;
+            m_classSlots[slot].index = ranges[members[b][k]];
+        }
     }
-    else
-        return it->second;              // return a pointer to the found record
-        
-    
+}
+
+LUPHashIndex *LUPArrayContainer::GetArrayIndexHelper( const char *objectName )
+{
+    if( m_classBuckets.empty() )
+        return &m_noClass;
+
+    S57AttrCode code = S57AttrCodeFromAcronym( objectName );
+
+    LUPClassBucket &bucket = m_classBuckets[( code * LUP_CLASS_HASH_MUL0 ) >> m_bucketShift];
+    if( !bucket.n_slots )
+        return &m_noClass;
+
+    int slot = bucket.first_slot;
+    if( bucket.n_slots > 1 )
+        slot += ( code * bucket.mul ) >> bucket.shift;
+
+    LUPClassSlot &class_slot = m_classSlots[slot];
+    if( class_slot.code != code )
+        return &m_noClass;
+
+    return &class_slot.index;
 }
 
 
@@ -378,6 +490,7 @@ s52plib::s52plib( const wxString& PLib, bool b_forceLegacy )
     pOBJLArray = new wxArrayPtrVoid;
 
     condSymbolLUPArray = NULL; // Dynamic Conditional Symbology
+    m_CSgeneration = 1;
 
     _symb_sym = NULL;
 
@@ -415,6 +528,8 @@ s52plib::s52plib( const wxString& PLib, bool b_forceLegacy )
     
     //        Set up some default flags
     m_bDeClutterText = false;
+    m_bTextBatch = false;
+    m_bSymbolBatch = false;
     m_bShowAtonText = true;
     m_bShowNationalTexts = false;
 
@@ -582,22 +697,10 @@ DisCat s52plib::findLUPDisCat(const char *objectName, LUPname TNAM)
 {
     LUPArrayContainer *plac = SelectLUPArrayContainer( TNAM );
     
-    wxArrayOfLUPrec *LUPArray = SelectLUPARRAY( TNAM  );
-    
-    
-    //      Find the first matching entry in the LUP Array
-    int index = 0;
-    int index_max = LUPArray->GetCount();
-    LUPrec *LUPCandidate;
-    
-    
-    while(  index < index_max  ) {
-        LUPCandidate = LUPArray->Item( index );
-        if( !strcmp( objectName, LUPCandidate->OBCL ) ) {
-            return LUPCandidate->DISC;
-        }
-        index++;
-    }
+    //      The first matching entry in the LUP Array
+    LUPHashIndex *hip = plac->GetArrayIndexHelper( objectName );
+    if( hip->count )
+        return plac->GetLUPArray()->Item( hip->n_start )->DISC;
     
     return (DisCat)(-1);
 }
@@ -732,6 +835,34 @@ void s52plib::GenerateStateHash()
     
 }
 
+long s52plib::GetRenderStateHash( void )
+{
+    //  The noshow list and the per class visibility are hashed by content, since
+    //  they change without GenerateStateHash(), e.g. by lights and anchor toggles,
+    //  or differ between canvases
+    std::vector<unsigned char> state;
+    state.reserve( 64 + 6 * m_noshow_array.GetCount() + pOBJLArray->GetCount() );
+
+    int params[6];
+    params[0] = (int)m_state_hash;
+    params[1] = m_nDisplayCategory;
+    params[2] = m_bShowMeta;
+    params[3] = m_qualityOfDataOn;
+    params[4] = m_bUseSCAMIN;
+    params[5] = g_chart_zoom_modifier_vector;
+    state.insert( state.end(), (unsigned char *)params, (unsigned char *)params + sizeof(params) );
+
+    for( unsigned int i = 0; i < m_noshow_array.GetCount(); i++ )
+        state.insert( state.end(), m_noshow_array[i].obj, m_noshow_array[i].obj + 6 );
+
+    for( unsigned int i = 0; i < pOBJLArray->GetCount(); i++ ) {
+        OBJLElement *pOLE = (OBJLElement *) ( pOBJLArray->Item( i ) );
+        state.push_back( pOLE->nViz ? 1 : 0 );
+    }
+
+    return crc32buf( &state[0], state.size() );
+}
+
 wxArrayOfLUPrec* s52plib::SelectLUPARRAY( LUPname TNAM  )
 {
     switch( TNAM ){
@@ -771,8 +902,10 @@ LUPArrayContainer *s52plib::SelectLUPArrayContainer( LUPname TNAM )
 
 extern Cond condTable[];
 
-LUPrec *s52plib::FindBestLUP( wxArrayOfLUPrec *LUPArray, unsigned int startIndex, unsigned int count, S57Obj *pObj, bool bStrict )
+LUPrec *s52plib::FindBestLUP( LUPArrayContainer *plac, unsigned int startIndex, unsigned int count, S57Obj *pObj, bool bStrict )
 {
+    wxArrayOfLUPrec *LUPArray = plac->GetLUPArray();
+
     //  Check the parameters
     if( 0 == count )
         return NULL;
@@ -791,138 +924,98 @@ LUPrec *s52plib::FindBestLUP( wxArrayOfLUPrec *LUPArray, unsigned int startIndex
         
     for( unsigned int i = 0; i < count; ++i ) {
         LUPrec *LUPCandidate = LUPArray->Item( startIndex + i );
+        unsigned int nattrs_on_candidate = LUPCandidate->ATTArray.size();
         
-        if( !LUPCandidate->ATTArray.size() )
+        if( !nattrs_on_candidate )
             continue;        // this LUP has no attributes coded
 
+        //  According to S52 specs, match must be perfect,
+        //  so the candidate is dropped at the first attribute that does not match
+        LUPAttMatch *pmatch = plac->GetAttMatches( startIndex + i );
         countATT = 0;
-        char *currATT = pObj->att_array;
-        int attIdx = 0;
 
-        for( unsigned int iLUPAtt = 0; iLUPAtt < LUPCandidate->ATTArray.size(); iLUPAtt++ ) {
+        for( unsigned int iLUPAtt = 0; iLUPAtt < nattrs_on_candidate; iLUPAtt++, pmatch++ ) {
 
-            // Get the LUP attribute name
-            char *slatc = LUPCandidate->ATTArray[iLUPAtt];
+            // LUP attribute value not UTF8 convertible (never seen in PLIB 3.x)
+            // or "undefined", which is not counted as a match
+            if( pmatch->type == LUPATT_SKIP || pmatch->type == LUPATT_UNDEFINED )
+                break;
 
-            if( slatc && (strlen(slatc) < 6) )
-                goto next_LUP_Attr;         // LUP attribute value not UTF8 convertible (never seen in PLIB 3.x)
+            int attIdx = pObj->GetAttributeIndex( pmatch->code );
+            if( attIdx < 0 )
+                break;
 
-            if( slatc ){
-                char *slatv = slatc + 6;
-                while( attIdx < pObj->n_attr ) {
-                    if( 0 == strncmp( slatc, currATT, 6 ) ) {
-                        //OK we have an attribute name match
-                        
-                        
-                        bool attValMatch = false;
-                        
-                        // special case (i)
-                        if( !strncmp( slatv, " ", 1 ) ) {        // any object value will match wild card (S52 para 8.3.3.4)
-                            ++countATT;
-                            goto next_LUP_Attr;
-                        }
-                        
-                        // special case (ii)
-                        //TODO  Find an ENC with "UNKNOWN" DRVAL1 or DRVAL2 and debug this code
-                        if( !strncmp( slatv, "?", 1) ){          // if LUP attribute value is "undefined"
+            // special case (i)
+            if( pmatch->type == LUPATT_ANY ) {          // any object value will match wild card (S52 para 8.3.3.4)
+                ++countATT;
+                continue;
+            }
 
-                        //  Match if the object does NOT contain this attribute
-                            goto next_LUP_Attr;
-                        }
-                        
-                        
-                        //checking against object attribute value
-                        S57attVal *v = ( pObj->attVal->Item( attIdx ) );
-                        
-                        switch( v->valType ){
-                            case OGR_INT: // S57 attribute type 'E' enumerated, 'I' integer
-                            {
-                                int LUP_att_val = atoi( slatv );
-                                if( LUP_att_val == *(int*) ( v->value ) )
-                                    attValMatch = true;
-                                break;
-                            }
-                            
-                            case OGR_INT_LST: // S57 attribute type 'L' list: comma separated integer
-                            {
-                                int a;
-                                char ss[41];
-                                strncpy( ss, slatv, 39 );
-                                ss[40] = '\0';
-                                char *s = &ss[0];
-                                
-                                int *b = (int*) v->value;
-                                sscanf( s, "%d", &a );
-                                
-                                while( *s != '\0' ) {
-                                    if( a == *b ) {
-                                        sscanf( ++s, "%d", &a );
-                                        b++;
-                                        attValMatch = true;
-                                        
-                                    } else
-                                        attValMatch = false;
-                                }
-                                break;
-                            }
-                            case OGR_REAL: // S57 attribute type'F' float
-                            {
-                                double obj_val = *(double*) ( v->value );
-                                float att_val = atof( slatv );
-                                if( fabs( obj_val - att_val ) < 1e-6 )
-                                    if( obj_val == att_val  )
-                                        attValMatch = true;
-                                break;
-                            }
-                            
-                            case OGR_STR: // S57 attribute type'A' code string, 'S' free text
-                            {
-                                //    Strings must be exact match
-                                //    n.b. OGR_STR is used for S-57 attribute type 'L', comma-separated list
-                                
-                                //wxString cs( (char *) v->value, wxConvUTF8 ); // Attribute from object
-                                //if( LATTC.Mid( 6 ) == cs )
-                                if( !strcmp((char *) v->value, slatv))
-                                    attValMatch = true;
-                                break;
-                            }
-                            
-                            default:
-                                break;
-                        } //switch
-                        
-                        // value match
-                        if( attValMatch )
-                            ++countATT;
-                                                
-                        goto next_LUP_Attr;
-                    } // if attribute name match
+            //checking against object attribute value
+            bool attValMatch = false;
+            S57attVal *v = ( pObj->attVal->Item( attIdx ) );
+            
+            switch( v->valType ){
+                case OGR_INT: // S57 attribute type 'E' enumerated, 'I' integer
+                {
+                    if( pmatch->ival == *(int*) ( v->value ) )
+                        attValMatch = true;
+                    break;
+                }
+                
+                case OGR_INT_LST: // S57 attribute type 'L' list: comma separated integer
+                {
+                    int a;
+                    char ss[41];
+                    strncpy( ss, pmatch->sval, 39 );
+                    ss[40] = '\0';
+                    char *s = &ss[0];
                     
-                    //  Advance to the next S57obj attribute
-                    currATT += 6;
-                    ++attIdx;
+                    int *b = (int*) v->value;
+                    sscanf( s, "%d", &a );
                     
-                } //while
-            } //if
+                    while( *s != '\0' ) {
+                        if( a == *b ) {
+                            sscanf( ++s, "%d", &a );
+                            b++;
+                            attValMatch = true;
+                            
+                        } else
+                            attValMatch = false;
+                    }
+                    break;
+                }
+                case OGR_REAL: // S57 attribute type'F' float
+                {
+                    double obj_val = *(double*) ( v->value );
+                    float att_val = pmatch->fval;
+                    if( fabs( obj_val - att_val ) < 1e-6 )
+                        if( obj_val == att_val  )
+                            attValMatch = true;
+                    break;
+                }
+                
+                case OGR_STR: // S57 attribute type'A' code string, 'S' free text
+                {
+                    //    Strings must be exact match
+                    //    n.b. OGR_STR is used for S-57 attribute type 'L', comma-separated list
+                    if( !strcmp((char *) v->value, pmatch->sval))
+                        attValMatch = true;
+                    break;
+                }
+                
+                default:
+                    break;
+            } //switch
             
-next_LUP_Attr:
-         
-            currATT = pObj->att_array; // restart the object attribute list
-            attIdx = 0;
+            if( !attValMatch )
+                break;
+
+            ++countATT;
         } // for iLUPAtt
         
-        //      Create a "match score", defined as fraction of candidate LUP attributes
-        //      actually matched by feature.
-        //      Used later for resolving "ties"
-        
-        int nattr_matching_on_candidate = countATT;
-        int nattrs_on_candidate = LUPCandidate->ATTArray.size();
-        double candidate_score = ( 1. * nattr_matching_on_candidate )
-        / ( 1. * nattrs_on_candidate );
-        
-        //       According to S52 specs, match must be perfect,
-        //         and the first 100% match is selected
-        if( candidate_score == 1.0 ) {
+        //       The first 100% match is selected
+        if( countATT == (int) nattrs_on_candidate ) {
             LUP = LUPCandidate;
             bmatch_found = true;
             break; // selects the first 100% match
@@ -1159,6 +1252,8 @@ int s52plib::S52_load_Plib( const wxString& PLib, bool b_forceLegacy )
     pointPaper_LAC= new LUPArrayContainer;
     
     condSymbolLUPArray = new wxArrayOfLUPrec( CompareLUPObjects ); // dynamic Cond Sym LUPs
+    m_CSLUPhash.clear();
+    m_CSgeneration++;
 
     m_unused_color.R = 2;
     m_unused_color.G = 2;
@@ -1204,6 +1299,13 @@ int s52plib::S52_load_Plib( const wxString& PLib, bool b_forceLegacy )
         return 0;
     }
 
+    //  The LUP tables are complete, so compile their lookup indices
+    line_LAC->BuildIndex();
+    areaPlain_LAC->BuildIndex();
+    areaSymbol_LAC->BuildIndex();
+    pointSimple_LAC->BuildIndex();
+    pointPaper_LAC->BuildIndex();
+
     //   Initialize the _cond_sym Hash Table from the jump table found in S52CNSY.CPP
     //   Hash Table indices are the literal CS Strings, e.g. "RESARE02"
     //   Hash Results Values are the Rule *, i.e. the CS procedure entry point
@@ -1389,6 +1491,8 @@ void s52plib::ClearCNSYLUPArray( void )
 
         condSymbolLUPArray->Clear();
     }
+    m_CSLUPhash.clear();
+    m_CSgeneration++;
 }
 
 bool s52plib::S52_flush_Plib()
@@ -1417,6 +1521,8 @@ bool s52plib::S52_flush_Plib()
 #endif
     
     DestroyLUPArray( condSymbolLUPArray );
+    m_CSLUPhash.clear();
+    m_CSgeneration++;
 
 //      Destroy Rules
     DestroyRules( _line_sym );
@@ -1450,7 +1556,7 @@ LUPrec *s52plib::S52_LUPLookup( LUPname LUP_Name, const char * objectName, S57Ob
     int nLUPs = hip->count;
     int nStartIndex = hip->n_start;
     
-    LUP = FindBestLUP( plac->GetLUPArray(), nStartIndex, nLUPs, pObj, bStrict );
+    LUP = FindBestLUP( plac, nStartIndex, nLUPs, pObj, bStrict );
     
     return LUP;
 }
@@ -2212,6 +2318,7 @@ extern GLenum       g_texture_rectangle_format;
             if (f_cache == 0) {
                 s_txf[i].key = ptext->pFont;
                 f_cache = &s_txf[i].cache;
+                f_cache->FlushBatch();      // pending quads use the old font texture
                 f_cache->Build(*ptext->pFont);
             }
 
@@ -2292,25 +2399,30 @@ extern GLenum       g_texture_rectangle_format;
 #ifndef USE_ANDROID_GLES2
                 wxColour wcolor = GetFontColour_PlugIn(_("ChartTexts"));
                 if( wcolor == *wxBLACK )
-                    glColor3ub( ptext->pcol->R, ptext->pcol->G, ptext->pcol->B );
-                else
+                    wcolor = wxColour( ptext->pcol->R, ptext->pcol->G, ptext->pcol->B );
+
+                if( m_bTextBatch ) {
+                    /* undo previous rotation to make text level */
+                    f_cache->AddStringToBatch( ptext->frmtd, xp, yp, -vp->rotation, wcolor );
+                } else {
                     glColor3ub( wcolor.Red(), wcolor.Green(), wcolor.Blue() );
                 
-                glEnable( GL_BLEND );
-                glEnable( GL_TEXTURE_2D );
-                glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
+                    glEnable( GL_BLEND );
+                    glEnable( GL_TEXTURE_2D );
+                    glTexEnvi( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE );
                 
-                glPushMatrix();
-                glTranslatef(xp, yp, 0);
+                    glPushMatrix();
+                    glTranslatef(xp, yp, 0);
                 
-                /* undo previous rotation to make text level */
-                glRotatef(vp->rotation*180/PI, 0, 0, -1);
+                    /* undo previous rotation to make text level */
+                    glRotatef(vp->rotation*180/PI, 0, 0, -1);
                 
-                f_cache->RenderString(ptext->frmtd);
-                glPopMatrix();
+                    f_cache->RenderString(ptext->frmtd);
+                    glPopMatrix();
                 
-                glDisable( GL_TEXTURE_2D );
-                glDisable( GL_BLEND );
+                    glDisable( GL_TEXTURE_2D );
+                    glDisable( GL_BLEND );
+                }
 #else
                 glEnable( GL_BLEND );
                 glEnable( GL_TEXTURE_2D );
@@ -2448,23 +2560,121 @@ extern GLenum       g_texture_rectangle_format;
 
 
 
-//    Return true if test_rect overlaps any rect in the current text rectangle list, except itself
-bool s52plib::CheckTextRectList( const wxRect &test_rect, S52_TextC *ptext )
+//-----------------------------------------------------------------------------
+//    S52TextGrid Implementation
+//-----------------------------------------------------------------------------
+#define TEXT_GRID_SHIFT         6       // 64 pixel cells
+#define TEXT_GRID_MAX_CELLS     64      // larger rects go on the short list
+
+static inline uint32_t TextGridKey( int ix, int iy )
 {
-    //    Iterate over the current object list, looking at rText
+    return ( (uint32_t) ( ix & 0xffff ) << 16 ) | (uint32_t) ( iy & 0xffff );
+}
 
-    for( TextObjList::Node *node = m_textObjList.GetFirst(); node; node = node->GetNext() ) {
-        wxRect *pcurrent_rect = &( node->GetData()->rText );
+bool S52TextGrid::GetCells( const wxRect &rect, int &ix0, int &iy0, int &ix1, int &iy1 ) const
+{
+    if( rect.width <= 0 || rect.height <= 0 )
+        return false;
+
+    ix0 = rect.x >> TEXT_GRID_SHIFT;
+    iy0 = rect.y >> TEXT_GRID_SHIFT;
+    ix1 = ( rect.x + rect.width - 1 ) >> TEXT_GRID_SHIFT;
+    iy1 = ( rect.y + rect.height - 1 ) >> TEXT_GRID_SHIFT;
+
+    return ( ix1 - ix0 + 1 ) * ( iy1 - iy0 + 1 ) <= TEXT_GRID_MAX_CELLS;
+}
 
-        if( pcurrent_rect->Intersects( test_rect ) ) {
-            if( node->GetData() != ptext )
+void S52TextGrid::File( S52_TextC *ptext, const wxRect &rect, bool badd )
+{
+    int ix0, iy0, ix1, iy1;
+    if( !GetCells( rect, ix0, iy0, ix1, iy1 ) ) {
+        if( badd )
+            m_large.push_back( ptext );
+        else
+            m_large.erase( std::remove( m_large.begin(), m_large.end(), ptext ), m_large.end() );
+        return;
+    }
+
+    for( int ix = ix0; ix <= ix1; ix++ ) {
+        for( int iy = iy0; iy <= iy1; iy++ ) {
+            std::vector<S52_TextC *> &cell = m_cells[TextGridKey( ix, iy )];
+            if( badd )
+                cell.push_back( ptext );
+            else
+                cell.erase( std::remove( cell.begin(), cell.end(), ptext ), cell.end() );
+        }
+    }
+}
+
+void S52TextGrid::Clear()
+{
+    m_cells.clear();
+    m_large.clear();
+    m_rects.clear();
+}
+
+void S52TextGrid::Update( S52_TextC *ptext )
+{
+    std::unordered_map<S52_TextC *, wxRect>::iterator it = m_rects.find( ptext );
+    if( it != m_rects.end() ) {
+        if( it->second == ptext->rText )
+            return;
+        File( ptext, it->second, false );
+        it->second = ptext->rText;
+    } else
+        m_rects[ptext] = ptext->rText;
+
+    File( ptext, ptext->rText, true );
+}
+
+void S52TextGrid::Remove( S52_TextC *ptext )
+{
+    std::unordered_map<S52_TextC *, wxRect>::iterator it = m_rects.find( ptext );
+    if( it == m_rects.end() )
+        return;
+
+    File( ptext, it->second, false );
+    m_rects.erase( it );
+}
+
+bool S52TextGrid::Intersects( const wxRect &test_rect, S52_TextC *ptext ) const
+{
+    for( size_t i = 0; i < m_large.size(); i++ )
+        if( m_large[i] != ptext && m_large[i]->rText.Intersects( test_rect ) )
+            return true;
+
+    int ix0, iy0, ix1, iy1;
+    if( !GetCells( test_rect, ix0, iy0, ix1, iy1 ) ) {
+        //  Too many cells to visit, check every filed text instead
+        for( std::unordered_map<S52_TextC *, wxRect>::const_iterator it = m_rects.begin();
+             it != m_rects.end(); ++it )
+            if( it->first != ptext && it->first->rText.Intersects( test_rect ) )
                 return true;
+        return false;
+    }
+
+    for( int ix = ix0; ix <= ix1; ix++ ) {
+        for( int iy = iy0; iy <= iy1; iy++ ) {
+            std::unordered_map<uint32_t, std::vector<S52_TextC *> >::const_iterator it =
+                m_cells.find( TextGridKey( ix, iy ) );
+            if( it == m_cells.end() )
+                continue;
 
+            const std::vector<S52_TextC *> &cell = it->second;
+            for( size_t i = 0; i < cell.size(); i++ )
+                if( cell[i] != ptext && cell[i]->rText.Intersects( test_rect ) )
+                    return true;
         }
     }
     return false;
 }
 
+//    Return true if test_rect overlaps any rect in the current text rectangle list, except itself
+bool s52plib::CheckTextRectList( const wxRect &test_rect, S52_TextC *ptext )
+{
+    return m_textGrid.Intersects( test_rect, ptext );
+}
+
 bool s52plib::TextRenderCheck( ObjRazRules *rzRules )
 {
     if( !m_bShowS57Text ) return false;
@@ -2654,22 +2864,17 @@ int s52plib::RenderT_All( ObjRazRules *rzRules, Rules *rules, ViewPort *vp, bool
         else
             text->rText = rect;
         
+        //      Keep the de-clutter index in step with the new rect
+        if( m_textGrid.Contains( text ) )
+            m_textGrid.Update( text );
         
         //      If this text was actually drawn, add a pointer to its rect to the de-clutter list if it doesn't already exist
         if( m_bDeClutterText ) {
             if( bwas_drawn ) {
-                bool b_found = false;
-                for( TextObjList::Node *node = m_textObjList.GetFirst(); node; node =  node->GetNext() ) {
-                    S52_TextC *oc = node->GetData();
-
-                    if( oc == text ) {
-                        if(!b_dupok)
-                            b_found = true;
-                        break;
-                    }
-                }
-                if( !b_found )
+                if( b_dupok || !m_textGrid.Contains( text ) ) {
                     m_textObjList.Append( text );
+                    m_textGrid.Update( text );
+                }
             }
         }
 
@@ -2788,6 +2993,8 @@ bool s52plib::RenderHPGL( ObjRazRules *rzRules, Rule *prule, wxPoint &r, ViewPor
     HPGL->SetVP(vp);
     
     if( !m_pdc ) { // OpenGL Mode, do a direct render
+        if( m_bSymbolBatch )
+            m_symbolBatch.Flush();              // keep the drawing order
         HPGL->SetTargetOpenGl();
         HPGL->Render( str, col, r, pivot, origin, xscale, render_angle, true );
 
@@ -3210,11 +3417,40 @@ bool s52plib::RenderRasterSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &r,
              return true;
      }
 
+#if defined(ocpnUSE_GL) && !defined(USE_ANDROID_GLES2)
+    //  Batched, the symbol quad is queued for FlushSymbolBatch()
+    if( !m_pdc && texture && m_bSymbolBatch ) {
+        extern GLenum       g_texture_rectangle_format;
+
+        float tx1 = texrect.x, ty1 = texrect.y;
+        float tx2 = tx1 + texrect.width, ty2 = ty1 + texrect.height;
+        if(g_texture_rectangle_format == GL_TEXTURE_2D) {
+            wxSize size = ChartSymbols::GLTextureSize();
+            tx1 /= size.x, tx2 /= size.x;
+            ty1 /= size.y, ty2 /= size.y;
+        }
+
+        AddSymbolToBatch( texture, tx1, ty1, tx2, ty2, r, pivot_x, pivot_y,
+                          texrect.width * scale_factor, texrect.height * scale_factor,
+                          vp->rotation, *wxWHITE );
+
+        //  As below, the queued symbol still grows the object box and drops the over-zoom cache
+        if( rzRules->obj->Primitive_type == GEO_POINT )
+            rzRules->obj->BBObj.Expand( symbox );
+        if(g_oz_vector_scale && (scale_factor > 1.0))
+            ClearRulesCache( prule );
+        return true;
+    }
+#endif
+
     //      Now render the symbol
 
     if( !m_pdc )          // opengl
     {
 #ifdef ocpnUSE_GL
+        if( m_bSymbolBatch )
+            m_symbolBatch.Flush();
+
         glEnable( GL_BLEND );
         
         if(texture) {
@@ -3584,6 +3820,8 @@ bool s52plib::RenderSoundingSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &
     // Build the texDepth object, if required
     if(!m_pdc){                         // OpenGL
         if(!m_texSoundings.IsBuilt() || (fabs(m_texSoundings.GetScale() - scale_factor) > 0.1) ){
+            if( m_bSymbolBatch )
+                m_symbolBatch.Flush();          // queued digits refer to the old texture
             m_texSoundings.Delete();
         
             m_soundFont = FindOrCreateFont_PlugIn( point_size, wxFONTFAMILY_SWISS,  wxFONTSTYLE_NORMAL, fontWeight, false, fontFacename );
@@ -3671,11 +3909,33 @@ bool s52plib::RenderSoundingSymbol( ObjRazRules *rzRules, Rule *prule, wxPoint &
     }
     symbox.Set( latmin, lonmin, latmax, lonmax );
 
+#if defined(ocpnUSE_GL) && !defined(USE_ANDROID_GLES2)
+    //  Batched, the digit quad is queued for FlushSymbolBatch()
+    if( !m_pdc && texture && m_bSymbolBatch ) {
+        extern GLenum       g_texture_rectangle_format;
+
+        float tx1 = texrect.x, ty1 = texrect.y;
+        float tx2 = tx1 + texrect.width, ty2 = ty1 + texrect.height;
+        if(g_texture_rectangle_format == GL_TEXTURE_2D) {
+            wxSize size = m_texSoundings.GLTextureSize();
+            tx1 /= size.x, tx2 /= size.x;
+            ty1 /= size.y, ty2 /= size.y;
+        }
+
+        AddSymbolToBatch( texture, tx1, ty1, tx2, ty2, r, pivot_x, pivot_y,
+                          texrect.width, texrect.height, vp->rotation, symColor );
+        return true;
+    }
+#endif
+
     //      Now render the symbol
 
     if( !m_pdc )          // opengl
     {
 #ifdef ocpnUSE_GL
+        if( m_bSymbolBatch )
+            m_symbolBatch.Flush();
+
         glEnable( GL_BLEND );
         
         if(texture) {
@@ -7195,6 +7455,11 @@ int s52plib::DoRenderObject( wxDC *pdcin, ObjRazRules *rzRules, ViewPort *vp )
     Rules *rules = rzRules->LUP->ruleList;
 
     while( rules != NULL ) {
+        //  Batched symbols must be drawn before anything rendered directly
+        if( m_bSymbolBatch && ( rules->ruleType != RUL_SYM_PT ) && ( rules->ruleType != RUL_MUL_SG )
+            && ( rules->ruleType != RUL_CND_SY ) )
+            m_symbolBatch.Flush();
+
         switch( rules->ruleType ){
             case RUL_TXT_TX:
                 RenderTX( rzRules, rules, vp );
@@ -7233,6 +7498,10 @@ int s52plib::DoRenderObject( wxDC *pdcin, ObjRazRules *rzRules, ViewPort *vp )
                 rules = rzRules->obj->CSrules;
 
                 while( NULL != rules ) {
+                        if( m_bSymbolBatch && ( rules->ruleType != RUL_SYM_PT )
+                            && ( rules->ruleType != RUL_MUL_SG ) )
+                            m_symbolBatch.Flush();
+
                         switch( rules->ruleType ){
                             case RUL_TXT_TX:
                                 RenderTX( rzRules, rules, vp );
@@ -9555,33 +9824,39 @@ int s52plib::RenderToGLAP( ObjRazRules *rzRules, Rules *rules, ViewPort *vp )
 
         
         if(w>0 && h>0) {
-            while( yr < vp->pix_height ) {
-                if( ( (yr + h) >= 0 ) && ( yr <= obj_ymax ) )  {
-                    xr = obj_xmin;   //reset
-                    while( xr < vp->pix_width ) {
-                    
-                        int xp = xr;
-                        if( yc & 1 ) xp += x_stagger_off;
-                    
-                    //    Render a quad.
-                        if( ( (xr + w) >= 0 ) && ( xr <= obj_xmax ) ){
-                            glBegin( GL_QUADS );
-                            glTexCoord2f( 0, 0 );
-                            glVertex3f( xp, yr, z_tex_geom );
-                            glTexCoord2f( ww, 0 );
-                            glVertex3f( xp + w, yr, z_tex_geom );
-                            glTexCoord2f( ww, hh );
-                            glVertex3f( xp + w, yr + h, z_tex_geom );
-                            glTexCoord2f( 0, hh );
-                            glVertex3f( xp, yr + h, z_tex_geom );
-                            glEnd();
-                        }
-                        xr += ppatt_spec->width;
+            //    Skip whole rows and columns of tiles lying off screen, keeping the pattern phase
+            //    and the stagger parity, then emit all visible tiles in a single quad run
+            if( yr + h < 0 ) {
+                int nskip = ( -( yr + h ) ) / h;
+                yr += nskip * h;
+                yc += nskip;
+            }
+            int x_start = obj_xmin;
+            if( x_start + w < 0 )
+                x_start += ( ( -( x_start + w ) ) / w ) * w;
+            int y_end = wxMin( vp->pix_height, obj_ymax + 1 );
+            int x_end = wxMin( vp->pix_width, obj_xmax + 1 );
+
+            glBegin( GL_QUADS );
+            while( yr < y_end ) {
+                if( (yr + h) >= 0 ) {
+                    int xoff = ( yc & 1 ) ? (int) x_stagger_off : 0;
+                    for( xr = x_start; xr < x_end; xr += w ) {
+                        int xp = xr + xoff;
+                        glTexCoord2f( 0, 0 );
+                        glVertex3f( xp, yr, z_tex_geom );
+                        glTexCoord2f( ww, 0 );
+                        glVertex3f( xp + w, yr, z_tex_geom );
+                        glTexCoord2f( ww, hh );
+                        glVertex3f( xp + w, yr + h, z_tex_geom );
+                        glTexCoord2f( 0, hh );
+                        glVertex3f( xp, yr + h, z_tex_geom );
                     }
                 }
-                yr += ppatt_spec->height;
+                yr += h;
                 yc++;
             }
+            glEnd();
         }
 
         glDisable( GL_TEXTURE_2D );
@@ -10639,41 +10914,66 @@ int s52plib::RenderAreaToDC( wxDC *pdcin, ObjRazRules *rzRules, ViewPort *vp,
 
 }
 
+unsigned int s52plib::GetCSInputHash( S57Obj *obj, unsigned int mariner_reads )
+{
+    //  Everything a CS procedure reads that is not an attribute of the object itself
+    double inputs[S52_MAR_NUM + 4];
+    int n = 0;
+
+    for( int i = 0; i < S52_MAR_NUM; i++ ) {
+        if( mariner_reads & ( 1u << i ) )
+            inputs[n++] = S52_getMarinerParam( (S52_MAR_param_t) i );
+    }
+
+    inputs[n++] = m_nSymbolStyle;
+    inputs[n++] = m_nBoundaryStyle;
+    inputs[n++] = m_nDepthUnitDisplay;
+
+    double safety_contour = 0;
+    if( obj->m_chart_context ) {
+        if( obj->m_chart_context->chart )
+            safety_contour = obj->m_chart_context->chart->GetCalculatedSafetyContour();
+        else
+            safety_contour = obj->m_chart_context->safety_contour;
+    }
+    inputs[n++] = safety_contour;
+
+    return crc32buf( (unsigned char *)inputs, n * sizeof(double) );
+}
+
 void s52plib::GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules )
 {
 
     LUPrec *NewLUP;
     LUPrec *LUP;
-    LUPrec *LUPCandidate;
 
+    S57Obj *obj = rzRules->obj;
+
+    //  Reuse the last result of this CS rule if nothing it read has changed since
+    if( obj->CSLUP && ( obj->CSsource == rules ) && ( obj->CSgeneration == m_CSgeneration )
+        && ( obj->CSInputHash == GetCSInputHash( obj, obj->CSMarinerReads ) ) ) {
+        obj->m_DisplayCat = obj->CSDisplayCat;              // as the CS procedure left it
+        obj->CSrules = obj->CSLUP->ruleList;
+        return;
+    }
+
+    S52_clearMarinerParamReads();
     char *rule_str1 = RenderCS( rzRules, rules );
+    unsigned int mariner_reads = S52_getMarinerParamReads();
+
     wxString cs_string( rule_str1, wxConvUTF8 );
     free( rule_str1 ); //delete rule_str1;
 
-//  Try to find a match for this object/attribute set in dynamic CS LUP Table
+//  Try to find a match for this object/attribute set in dynamic CS LUP Table,
+//  that is, a LUP with the same Object Name and Display Category,
+//  created earlier by exactly the same INSTruction string
 
-//  Do this by checking each LUP in the CS LUPARRAY and checking....
-//  a) is Object Name the same? and
-//  b) was LUP created earlier by exactly the same INSTruction string?
-//  c) does LUP have same Display Category and Priority?
+    wxString key( rzRules->LUP->OBCL, wxConvUTF8 );
+    key += (wxChar) rzRules->LUP->DISC;
+    key += cs_string;
 
-    wxArrayOfLUPrec *la = condSymbolLUPArray;
-    int index = 0;
-    int index_max = la->GetCount();
-    LUP = NULL;
-
-    while( ( index < index_max ) ) {
-        LUPCandidate = la->Item( index );
-        if( !strcmp( rzRules->LUP->OBCL, LUPCandidate->OBCL ) ) {
-            if( LUPCandidate->INST->IsSameAs( cs_string ) ) {
-                if( LUPCandidate->DISC == rzRules->LUP->DISC ) {
-                    LUP = LUPCandidate;
-                    break;
-                }
-            }
-        }
-        index++;
-    }
+    CSLUP_Hash::iterator it = m_CSLUPhash.find( key );
+    LUP = ( it != m_CSLUPhash.end() ) ? it->second : NULL;
 
 //  If not found, need to create a dynamic LUP and add to CS LUP Table
 
@@ -10699,6 +10999,7 @@ void s52plib::GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules )
         wxArrayOfLUPrec *pLUPARRAYtyped = condSymbolLUPArray;
 
         pLUPARRAYtyped->Add( NewLUP );
+        m_CSLUPhash[key] = NewLUP;
 
         LUP = NewLUP;
 
@@ -10708,6 +11009,12 @@ void s52plib::GetAndAddCSRules( ObjRazRules *rzRules, Rules *rules )
 
     rzRules->obj->CSrules = top; // patch in a new rule set
 
+    obj->CSLUP = LUP;
+    obj->CSsource = rules;
+    obj->CSgeneration = m_CSgeneration;
+    obj->CSMarinerReads = mariner_reads;
+    obj->CSInputHash = GetCSInputHash( obj, mariner_reads );
+    obj->CSDisplayCat = obj->m_DisplayCat;
 }
 
 bool s52plib::ObjectRenderCheck( ObjRazRules *rzRules, ViewPort *vp )
@@ -10945,6 +11252,37 @@ bool s52plib::ObjectRenderCheckRules( ObjRazRules *rzRules, ViewPort *vp, bool c
     return true;
 }
 
+bool s52plib::ObjectRenderCheckState( ObjRazRules *rzRules, ViewPort *vp )
+{
+    if( rzRules->obj == NULL )
+        return false;
+
+    if(m_nDisplayCategory == MARINERS_STANDARD){
+        if(strncmp(rzRules->obj->FeatureName, "M_QUAL", 6)){
+            if( IsObjNoshow( rzRules->LUP->OBCL) )
+                return false;
+        }
+        else{
+            if(!m_qualityOfDataOn)
+                return false;
+        }
+    }
+    else{
+        if( IsObjNoshow( rzRules->LUP->OBCL) )
+            return false;
+    }
+
+    //  SCAMIN only hides more objects as the scale number grows
+    if( ObjectRenderCheckCat( rzRules, vp ) )
+        return true;
+
+    //  A CS procedure not yet run may still move the object to a displayed category
+    if( !rzRules->obj->m_bcategory_mutable || rzRules->obj->bCS_Added )
+        return false;
+
+    return ObjectRenderCheckCS( rzRules, vp );
+}
+
 
 void s52plib::SetDisplayCategory(enum _DisCat cat)
 {
@@ -11273,7 +11611,48 @@ void s52plib::ClearTextList( void )
 {
     //      Clear the current text rectangle list
     m_textObjList.Clear();
+    m_textGrid.Clear();
+
+}
 
+void s52plib::BeginTextBatch( void )
+{
+    m_bTextBatch = true;
+}
+
+void s52plib::FlushTextBatch( void )
+{
+#ifdef ocpnUSE_GL
+    for( int i = 0; i < TXF_CACHE; i++ )
+        if( s_txf[i].key )
+            s_txf[i].cache.FlushBatch();
+#endif
+    m_bTextBatch = false;
+}
+
+void s52plib::BeginSymbolBatch( void )
+{
+#ifndef USE_ANDROID_GLES2
+    m_bSymbolBatch = true;
+#endif
+}
+
+void s52plib::FlushSymbolBatch( void )
+{
+    m_symbolBatch.Flush();
+    m_bSymbolBatch = false;
+}
+
+void s52plib::AddSymbolToBatch( unsigned int texture, float tx1, float ty1, float tx2, float ty2,
+                                const wxPoint &r, float pivot_x, float pivot_y, float w, float h,
+                                float rotation, const wxColour &color )
+{
+    //  One vertex array per atlas run.
+    //  Same transform as the direct render: translate to r, rotate by -rotation, offset by the pivot
+    m_symbolBatch.SetTexture( texture );
+    m_symbolBatch.AddQuad( r.x, r.y, cosf( rotation ), -sinf( rotation ),
+                           -pivot_x, -pivot_y, w - pivot_x, h - pivot_y,
+                           tx1, ty1, tx2, ty2, color );
 }
 
 bool s52plib::EnableGLLS(bool b_enable)
@@ -11302,6 +11681,10 @@ void s52plib::AdjustTextList( int dx, int dy, int screenw, int screenh )
         }
         node = next;
     }
+
+    m_textGrid.Clear();
+    for( node = m_textObjList.GetFirst(); node; node = node->GetNext() )
+        m_textGrid.Update( node->GetData() );
 }
 
 bool s52plib::GetPointPixArray( ObjRazRules *rzRules, wxPoint2DDouble* pd, wxPoint *pp, int nv, ViewPort *vp )
@@ -161,15 +161,29 @@ static double _MARparamVal[] = {
 };
 
 
+// bit mask of the parameters read since the last S52_clearMarinerParamReads()
+static unsigned int _MARparamReads = 0;
+
 double S52_getMarinerParam(S52_MAR_param_t param)
 // return Mariner parameter or '0.0' if fail
 // FIXME: check mariner param against groups selection
 {
 
 //      DSR
+    _MARparamReads |= 1u << param;
     return _MARparamVal[param];
 }
 
+unsigned int S52_getMarinerParamReads(void)
+{
+    return _MARparamReads;
+}
+
+void S52_clearMarinerParamReads(void)
+{
+    _MARparamReads = 0;
+}
+
 int    S52_setMarinerParam(S52_MAR_param_t param, double val)
 {
     if (S52_MAR_NONE<param && param<S52_MAR_NUM)
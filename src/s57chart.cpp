@@ -254,6 +254,9 @@ s57chart::s57chart()
 
     m_bLinePrioritySet = false;
     m_plib_state_hash = 0;
+    m_bRenderListValid = false;
+    m_render_list_hash = 0;
+    m_render_list_band = 0;
 
     m_btex_mem = false;
 
@@ -482,7 +485,6 @@ void s57chart::FreeObjectsAndRules()
 //      But we need to manually destroy any LUPS related to children
 
     ObjRazRules *top;
-    ObjRazRules *nxx;
     for( int i = 0; i < PRIO_NUM; ++i ) {
         for( int j = 0; j < LUPNAME_NUM; j++ ) {
 
@@ -490,7 +492,7 @@ void s57chart::FreeObjectsAndRules()
             while( top != NULL ) {
                 top->obj->nRef--;
                 if( 0 == top->obj->nRef )
-                    delete top->obj;
+                    S57Obj::Destroy( top->obj );
 
                 if( top->child ) {
                     ObjRazRules *ctop = top->child;
@@ -507,12 +509,14 @@ void s57chart::FreeObjectsAndRules()
                 }
                 free_mps( top->mps );
 
-                nxx = top->next;
-                free( top );
-                top = nxx;
+                top = top->next;
             }
+            razRules[i][j] = NULL;
         }
     }
+
+    //  The top level razRules nodes, and the SENC objects with their attributes, live in the arena
+    m_arena.Release();
 }
 
 void s57chart::ClearRenderedTextCache()
@@ -838,6 +842,104 @@ void s57chart::SetLinePriorities( void )
     m_bLinePrioritySet = true;
 }
 
+//----------------------------------------------------------------------------
+// S57RenderList implementation
+//----------------------------------------------------------------------------
+void S57RenderList::Clear()
+{
+    m_objs.clear();
+    m_minlat.clear();
+    m_maxlat.clear();
+    m_minlon.clear();
+    m_maxlon.clear();
+    m_visible.clear();
+}
+
+void S57RenderList::Add( ObjRazRules *rzRules )
+{
+    m_objs.push_back( rzRules );
+    m_minlat.push_back( 0 );
+    m_maxlat.push_back( 0 );
+    m_minlon.push_back( 0 );
+    m_maxlon.push_back( 0 );
+    m_visible.push_back( 0 );
+    UpdateBox( m_objs.size() - 1 );
+}
+
+void S57RenderList::UpdateBox( size_t i )
+{
+    const LLBBox &box = m_objs[i]->obj->BBObj;
+    m_minlat[i] = box.GetMinLat();
+    m_maxlat[i] = box.GetMaxLat();
+    m_minlon[i] = box.GetMinLon();
+    m_maxlon[i] = box.GetMaxLon();
+}
+
+void S57RenderList::UpdateBoxes()
+{
+    for( size_t i = 0; i < m_objs.size(); i++ )
+        UpdateBox( i );
+}
+
+void S57RenderList::Cull( const LLBBox &vpBox )
+{
+    size_t n = m_objs.size();
+    if( !n )
+        return;
+
+    const double vminlat = vpBox.GetMinLat(), vmaxlat = vpBox.GetMaxLat();
+    const double vminlon = vpBox.GetMinLon(), vmaxlon = vpBox.GetMaxLon();
+
+    const double *minlat = &m_minlat[0], *maxlat = &m_maxlat[0];
+    const double *minlon = &m_minlon[0], *maxlon = &m_maxlon[0];
+    unsigned char *visible = &m_visible[0];
+
+    //  Branch free, so the compiler can vectorise it.
+    //  Longitudes are also tried shifted by +-360, as in ObjectRenderCheckPos()
+    for( size_t i = 0; i < n; i++ ) {
+        int lat = !( ( vmaxlat < minlat[i] ) | ( vminlat > maxlat[i] ) );
+        int lon = ( ( vmaxlon >= minlon[i] ) & ( vminlon <= maxlon[i] ) )
+                | ( ( vmaxlon >= minlon[i] + 360 ) & ( vminlon <= maxlon[i] + 360 ) )
+                | ( ( vmaxlon >= minlon[i] - 360 ) & ( vminlon <= maxlon[i] - 360 ) );
+        visible[i] = lat & lon;
+    }
+}
+
+void s57chart::UpdateRenderList( const ViewPort &VPoint )
+{
+    if( !ps52plib ) return;
+
+    //  The lists hold for quarter octave bands of chart scale.
+    //  SCAMIN only hides more objects as the scale number grows, so an object
+    //  hidden at the bottom of the band stays hidden across all of it.
+    int band = (int) floor( log( wxMax(VPoint.chart_scale, 1.) ) / log( 2. ) * 4. );
+    long hash = ps52plib->GetRenderStateHash();
+
+    if( m_bRenderListValid && ( hash == m_render_list_hash ) && ( band == m_render_list_band ) )
+        return;
+
+    ViewPort vp = VPoint;
+    vp.chart_scale = pow( 2., band / 4. ) * 0.9999;        // just under the band edge, against rounding
+
+    for( int i = 0; i < PRIO_NUM; ++i ) {
+        for( int j = 0; j < LUPNAME_NUM; j++ ) {
+            S57RenderList &list = m_renderList[i][j];
+            list.Clear();
+
+            ObjRazRules *top = razRules[i][j];
+            while( top != NULL ) {
+                if( ps52plib->ObjectRenderCheckState( top, &vp ) )
+                    list.Add( top );
+                top = top->next;
+            }
+        }
+    }
+
+    m_bRenderListValid = true;
+    m_render_list_hash = hash;
+    m_render_list_band = band;
+}
+
 #if 0
 void s57chart::SetLinePriorities( void )
 {
@@ -1135,7 +1237,7 @@ void s57chart::AssembleLineGeometry( void )
                                     pcs = csit->second;
 
 
-                                line_segment_element *pls = new line_segment_element;
+                                line_segment_element *pls = NewLineSegmentElement( obj );
                                 pls->next = 0;
                                 //                            pls->n_points = 2;
                                 pls->priority = 0;
@@ -1149,7 +1251,7 @@ void s57chart::AssembleLineGeometry( void )
                         }
 
                         if(pedge && pedge->nCount){
-                            line_segment_element *pls = new line_segment_element;
+                            line_segment_element *pls = NewLineSegmentElement( obj );
                             pls->next = 0;
                             //                        pls->n_points = pedge->nCount;
                             pls->priority = 0;
@@ -1211,7 +1313,7 @@ void s57chart::AssembleLineGeometry( void )
                                     else
                                         pcs = csit->second;
 
-                                    line_segment_element *pls = new line_segment_element;
+                                    line_segment_element *pls = NewLineSegmentElement( obj );
                                     pls->next = 0;
                                     pls->priority = 0;
                                     pls->pcs = pcs;
@@ -1257,7 +1359,7 @@ void s57chart::AssembleLineGeometry( void )
                                     else
                                         pcs = csit->second;
 
-                                    line_segment_element *pls = new line_segment_element;
+                                    line_segment_element *pls = NewLineSegmentElement( obj );
                                     pls->next = 0;
                                     pls->priority = 0;
                                     pls->pcs = pcs;
@@ -1516,6 +1618,7 @@ bool s57chart::RenderViewOnGLTextOnly( const wxGLContext &glc, const ViewPort& V
     if( !ps52plib ) return false;
     
     SetVPParms( VPoint );
+    UpdateRenderList( VPoint );
     
 #ifndef USE_ANDROID_GLES2
     glPushMatrix(); //    Adjust for rotation
@@ -1555,6 +1658,7 @@ bool s57chart::DoRenderRegionViewOnGL( const wxGLContext &glc, const ViewPort& V
                                                         //for the case where depth(height) units change
         ResetPointBBoxes( m_last_vp, VPoint );
         SetSafetyContour();
+        m_bRenderListValid = false;                     // CS rules and categories were reset
 
         m_plib_state_hash = ps52plib->GetStateHash();
 
@@ -1562,10 +1666,15 @@ bool s57chart::DoRenderRegionViewOnGL( const wxGLContext &glc, const ViewPort& V
 
     if( VPoint.view_scale_ppm != m_last_vp.view_scale_ppm ) {
         ResetPointBBoxes( m_last_vp, VPoint );
+        for( int i = 0; i < PRIO_NUM; ++i ) {
+            m_renderList[i][0].UpdateBoxes();
+            m_renderList[i][1].UpdateBoxes();
+        }
     }
 
     BuildLineVBO();
     SetLinePriorities();
+    UpdateRenderList( VPoint );
 
     //        Clear the text declutter list
     ps52plib->ClearTextList();
@@ -1667,22 +1776,33 @@ bool s57chart::DoRenderOnGL( const wxGLContext &glc, const ViewPort& VPoint )
 {
 #ifdef ocpnUSE_GL
 
-    int i;
+    int i, j;
     ObjRazRules *top;
     ObjRazRules *crnt;
     ViewPort tvp = VPoint;                    // undo const  TODO fix this in PLIB
 
+    //      Viewport test of the lists to be drawn, on the packed bounding boxes
+    int jarea = ( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) ? 4 : 3;
+    int jpoint = ( ps52plib->m_nSymbolStyle == SIMPLIFIED ) ? 0 : 1;
+    for( i = 0; i < PRIO_NUM; ++i ) {
+        m_renderList[i][jarea].Cull( tvp.GetBBox() );
+        m_renderList[i][2].Cull( tvp.GetBBox() );
+        m_renderList[i][jpoint].Cull( tvp.GetBBox() );
+    }
+
 #if 1    
     //      Render the areas quickly
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            j = 4; // Area Symbolized Boundaries
         else
-            top = razRules[i][3]; // Area Plain Boundaries
+            j = 3; // Area Plain Boundaries
 
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;               // next object
+        S57RenderList &list = m_renderList[i][j];
+        for( size_t k = 0; k < list.GetCount(); k++ ) {
+            if( !list.IsVisible( k ) )
+                continue;
+            crnt = list.Item( k );
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderAreaToGL( glc, crnt, &tvp );
         }
@@ -1718,43 +1838,57 @@ bool s57chart::DoRenderOnGL( const wxGLContext &glc, const ViewPort& VPoint )
     //    Render the lines and points
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
+            j = 4; // Area Symbolized Boundaries
         else
-            top = razRules[i][3]; // Area Plain Boundaries
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;               // next object
+            j = 3; // Area Plain Boundaries
+
+        S57RenderList &list = m_renderList[i][j];
+        for( size_t k = 0; k < list.GetCount(); k++ ) {
+            if( !list.IsVisible( k ) )
+                continue;
+            crnt = list.Item( k );
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToGL( glc, crnt, &tvp );
+            list.UpdateBox( k );                    // symbols may have grown the object's box
         }
     }
     //qDebug() << "Done Boundaries" << sw.GetTime();
 
     for( i = 0; i < PRIO_NUM; ++i ) {
-        top = razRules[i][2];           //LINES
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;
+        S57RenderList &list = m_renderList[i][2];           //LINES
+        for( size_t k = 0; k < list.GetCount(); k++ ) {
+            if( !list.IsVisible( k ) )
+                continue;
+            crnt = list.Item( k );
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToGL( glc, crnt, &tvp );
+            list.UpdateBox( k );
         }
     }
  
  //qDebug() << "Done Lines" << sw.GetTime();
 
+    //    Atlas textured point symbols and soundings are queued, and drawn in one call per atlas run
+    ps52plib->BeginSymbolBatch();
+
     for( i = 0; i < PRIO_NUM; ++i ) {
         if( ps52plib->m_nSymbolStyle == SIMPLIFIED ) 
-            top = razRules[i][0];       //SIMPLIFIED Points
+            j = 0;       //SIMPLIFIED Points
         else
-            top = razRules[i][1];           //Paper Chart Points Points
+            j = 1;           //Paper Chart Points Points
 
-        while( top != NULL ) {
-            crnt = top;
-            top = top->next;
+        S57RenderList &list = m_renderList[i][j];
+        for( size_t k = 0; k < list.GetCount(); k++ ) {
+            if( !list.IsVisible( k ) )
+                continue;
+            crnt = list.Item( k );
             crnt->sm_transform_parms = &vp_transform;
             ps52plib->RenderObjectToGL( glc, crnt, &tvp );
+            list.UpdateBox( k );                    // symbols may have grown the object's box
         }
     }
+
+    ps52plib->FlushSymbolBatch();
     //qDebug() << "Done Points" << sw.GetTime();
 
 
@@ -1789,41 +1923,31 @@ bool s57chart::DoRenderOnGLText( const wxGLContext &glc, const ViewPort& VPoint
     }
 #endif
     
+    //    Glyph texture text is collected and drawn at the end in one call per font
+    ps52plib->BeginTextBatch();
+
     //    Render the lines and points
-    for( i = 0; i < PRIO_NUM; ++i ) {
-        if( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) 
-            top = razRules[i][4]; // Area Symbolized Boundaries
-        else
-            top = razRules[i][3]; // Area Plain Boundaries
+    int jlist[3];
+    jlist[0] = ( ps52plib->m_nBoundaryStyle == SYMBOLIZED_BOUNDARIES ) ? 4 : 3;   // Area Boundaries
+    jlist[1] = 2;                                                                   //LINES
+    jlist[2] = ( ps52plib->m_nSymbolStyle == SIMPLIFIED ) ? 0 : 1;                 // Points
 
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;               // next object
-                crnt->sm_transform_parms = &vp_transform;
-                ps52plib->RenderObjectToGLText( glc, crnt, &tvp );
-        }
-            
-        top = razRules[i][2];           //LINES
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;
-                crnt->sm_transform_parms = &vp_transform;
-                ps52plib->RenderObjectToGLText( glc, crnt, &tvp );
-        }
-            
-        if( ps52plib->m_nSymbolStyle == SIMPLIFIED ) 
-            top = razRules[i][0];       //SIMPLIFIED Points
-        else
-            top = razRules[i][1];           //Paper Chart Points Points
-            
-        while( top != NULL ) {
-                crnt = top;
-                top = top->next;
+    for( i = 0; i < PRIO_NUM; ++i ) {
+        for( int n = 0; n < 3; n++ ) {
+            S57RenderList &list = m_renderList[i][jlist[n]];
+            list.Cull( tvp.GetBBox() );
+            for( size_t k = 0; k < list.GetCount(); k++ ) {
+                if( !list.IsVisible( k ) )
+                    continue;
+                crnt = list.Item( k );
                 crnt->sm_transform_parms = &vp_transform;
                 ps52plib->RenderObjectToGLText( glc, crnt, &tvp );
+                list.UpdateBox( k );                // text may have grown the object's box
+            }
         }
-            
     }
+
+    ps52plib->FlushTextBatch();
     
 #endif          //#ifdef ocpnUSE_GL
     
@@ -4027,6 +4151,7 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
     VC_ElementVector VCs;
 
     sencfile.setRefLocn(ref_lat, ref_lon);
+    sencfile.setArena( &m_arena );
 
     int srv = sencfile.ingest200(FullPath, &Objects, &VEs, &VCs);
 
@@ -4152,7 +4277,7 @@ int s57chart::BuildRAZFromSENCFile( const wxString& FullPath )
                 msg.Prepend( _T("   Could not find LUP for ") );
                 LogMessageOnce( msg );
             }
-            delete obj;
+            S57Obj::Destroy( obj );
             obj = NULL;
             Objects[i] = NULL;
         } else {
@@ -4345,7 +4470,8 @@ int s57chart::_insertRules( S57Obj *obj, LUPrec *LUP, s57chart *pOwner )
     }
 
     // insert rules
-    rzRules = (ObjRazRules *) malloc( sizeof(ObjRazRules) );
+    m_bRenderListValid = false;
+    rzRules = (ObjRazRules *) m_arena.Alloc( sizeof(ObjRazRules) );
     rzRules->obj = obj;
     obj->nRef++;                         // Increment reference counter for delete check;
     rzRules->LUP = LUP;
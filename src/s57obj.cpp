@@ -86,6 +86,56 @@ extern bool              g_b_EnableVBO;
 extern PFNGLDELETEBUFFERSPROC              s_glDeleteBuffers;
 #endif
 
+//----------------------------------------------------------------------------------
+//      S57Arena Implementation
+//----------------------------------------------------------------------------------
+#define S57ARENA_CHUNK_SIZE     (64 * 1024)
+#define S57ARENA_ALIGN          8
+
+S57Arena::S57Arena()
+{
+    m_pfree = NULL;
+    m_nfree = 0;
+}
+
+S57Arena::~S57Arena()
+{
+    Release();
+}
+
+void *S57Arena::Alloc( size_t size )
+{
+    size = ( size + S57ARENA_ALIGN - 1 ) & ~( (size_t) S57ARENA_ALIGN - 1 );
+
+    //  Large requests get a chunk of their own, leaving the current chunk in use
+    if( size > S57ARENA_CHUNK_SIZE / 4 ) {
+        char *p = (char *) malloc( size );
+        m_chunks.push_back( p );
+        return p;
+    }
+
+    if( size > m_nfree ) {
+        m_pfree = (char *) malloc( S57ARENA_CHUNK_SIZE );
+        m_nfree = S57ARENA_CHUNK_SIZE;
+        m_chunks.push_back( m_pfree );
+    }
+
+    void *p = m_pfree;
+    m_pfree += size;
+    m_nfree -= size;
+    return p;
+}
+
+void S57Arena::Release()
+{
+    for( unsigned int i = 0; i < m_chunks.size(); i++ )
+        free( m_chunks[i] );
+    m_chunks.clear();
+
+    m_pfree = NULL;
+    m_nfree = 0;
+}
+
 //----------------------------------------------------------------------------------
 //      S57Obj CTOR
 //----------------------------------------------------------------------------------
@@ -103,16 +153,23 @@ S57Obj::~S57Obj()
 {
     //  Don't delete any allocated records of simple copy clones
     if( !bIsClone ) {
+        //  Attribute records and multipoint geometry of arena objects
+        //  are released with the arena
         if( attVal ) {
-            for( unsigned int iv = 0; iv < attVal->GetCount(); iv++ ) {
-                S57attVal *vv = attVal->Item( iv );
-                void *v2 = vv->value;
-                free( v2 );
-                delete vv;
+            if( !m_arena ) {
+                for( unsigned int iv = 0; iv < attVal->GetCount(); iv++ ) {
+                    S57attVal *vv = attVal->Item( iv );
+                    void *v2 = vv->value;
+                    free( v2 );
+                    delete vv;
+                }
             }
             delete attVal;
         }
-        free( att_array );
+        if( !m_arena ) {
+            free( att_array );
+            free( att_codes );
+        }
 
         if( pPolyTessGeo ) {
 #ifdef ocpnUSE_GL
@@ -129,12 +186,14 @@ S57Obj::~S57Obj()
         if( FText ) delete FText;
 
         if( geoPt ) free( geoPt );
-        if( geoPtz ) free( geoPtz );
-        if( geoPtMulti ) free( geoPtMulti );
+        if( !m_arena ) {
+            if( geoPtz ) free( geoPtz );
+            if( geoPtMulti ) free( geoPtMulti );
+        }
 
         if( m_lsindex_array ) free( m_lsindex_array );
 
-        if(m_ls_list){
+        if( m_ls_list && !m_arena ){
             line_segment_element *element = m_ls_list;
             while(element){
                 line_segment_element *next = element->next;
@@ -149,6 +208,7 @@ S57Obj::~S57Obj()
 void S57Obj::Init()
 {
     att_array = NULL;
+    att_codes = NULL;
     attVal = NULL;
     n_attr = 0;
 
@@ -157,6 +217,12 @@ void S57Obj::Init()
 
     bCS_Added = 0;
     CSrules = NULL;
+    CSLUP = NULL;
+    CSsource = NULL;
+    CSgeneration = 0;
+    CSMarinerReads = 0;
+    CSInputHash = 0;
+    CSDisplayCat = OTHER;
     FText = NULL;
     bFText_Added = 0;
     geoPtMulti = NULL;
@@ -187,6 +253,8 @@ void S57Obj::Init()
     auxParm1 = 0;
     auxParm2 = 0;
     auxParm3 = 0;
+
+    m_arena = NULL;
 }
 
 //----------------------------------------------------------------------------------
@@ -207,21 +275,45 @@ S57Obj::S57Obj( const char* featureName )
 }
 
 
+void S57Obj::AddAttributeRecord( const char *acronym, S57attVal *pattVal )
+{
+    if( m_arena ) {
+        //  The arena cannot realloc in place, so grow the acronym array geometrically
+        if( 0 == n_attr || ( n_attr >= 8 && 0 == ( n_attr & ( n_attr - 1 ) ) ) ) {
+            int n_alloc = wxMax( 8, 2 * n_attr );
+            char *pnew = (char *) m_arena->Alloc( 6 * n_alloc );
+            S57AttrCode *pnew_codes = (S57AttrCode *) m_arena->Alloc( n_alloc * sizeof(S57AttrCode) );
+            if( n_attr ) {
+                memcpy( pnew, att_array, 6 * n_attr );
+                memcpy( pnew_codes, att_codes, n_attr * sizeof(S57AttrCode) );
+            }
+            att_array = pnew;
+            att_codes = pnew_codes;
+        }
+    }
+    else {
+        att_array = (char *)realloc(att_array, 6*(n_attr + 1));
+        att_codes = (S57AttrCode *)realloc(att_codes, (n_attr + 1) * sizeof(S57AttrCode));
+    }
+
+    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
+    att_codes[n_attr] = S57AttrCodeFromAcronym( acronym );
+    n_attr++;
+
+    attVal->Add( pattVal );
+}
+
 bool S57Obj::AddIntegerAttribute( const char *acronym, int val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = m_arena ? (S57attVal *) m_arena->Alloc( sizeof(S57attVal) ) : new S57attVal;
 
-    int *pAVI = (int *) malloc( sizeof(int) );         //new int;
+    int *pAVI = (int *) ( m_arena ? m_arena->Alloc( sizeof(int) ) : malloc( sizeof(int) ) );
     *pAVI = val;
 
     pattValTmp->valType = OGR_INT;
     pattValTmp->value = pAVI;
 
-    att_array = (char *)realloc(att_array, 6*(n_attr + 1));
-    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
-    n_attr++;
-
-    attVal->Add( pattValTmp );
+    AddAttributeRecord( acronym, pattValTmp );
 
     if(!strncmp(acronym, "SCAMIN", 6))
         Scamin = val;
@@ -236,19 +328,15 @@ bool S57Obj::AddIntegerListAttribute( const char *acronym, int *pval, int nValue
 
 bool S57Obj::AddDoubleAttribute( const char *acronym, double val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = m_arena ? (S57attVal *) m_arena->Alloc( sizeof(S57attVal) ) : new S57attVal;
 
-    double *pAVI = (double *) malloc( sizeof(double) );         //new double;
+    double *pAVI = (double *) ( m_arena ? m_arena->Alloc( sizeof(double) ) : malloc( sizeof(double) ) );
     *pAVI = val;
 
     pattValTmp->valType = OGR_REAL;
     pattValTmp->value = pAVI;
 
-    att_array = (char *)realloc(att_array, 6*(n_attr + 1));
-    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
-    n_attr++;
-
-    attVal->Add( pattValTmp );
+    AddAttributeRecord( acronym, pattValTmp );
 
     return true;
 }
@@ -260,19 +348,16 @@ bool S57Obj::AddDoubleListAttribute( const char *acronym, double *pval, int nVal
 
 bool S57Obj::AddStringAttribute( const char *acronym, char *val ){
 
-    S57attVal *pattValTmp = new S57attVal;
+    S57attVal *pattValTmp = m_arena ? (S57attVal *) m_arena->Alloc( sizeof(S57attVal) ) : new S57attVal;
 
-    char *pAVS = (char *)malloc(strlen(val) + 1);   //new string
+    size_t len = strlen( val ) + 1;
+    char *pAVS = (char *) ( m_arena ? m_arena->Alloc( len ) : malloc( len ) );
     strcpy(pAVS, val);
 
     pattValTmp->valType = OGR_STR;
     pattValTmp->value = pAVS;
 
-    att_array = (char *)realloc(att_array, 6*(n_attr + 1));
-    strncpy(att_array + (6 * sizeof(char) * n_attr), acronym, 6);
-    n_attr++;
-
-    attVal->Add( pattValTmp );
+    AddAttributeRecord( acronym, pattValTmp );
 
     return true;
 }
@@ -366,8 +451,14 @@ bool S57Obj::SetMultipointGeometry( MultipointGeometryDescriptor *pGeo, double r
 
     npt = pGeo->pointCount;
 
-    geoPtz = (double *) malloc( npt * 3 * sizeof(double) );
-    geoPtMulti = (double *) malloc( npt * 2 * sizeof(double) );
+    if( m_arena ) {
+        geoPtz = (double *) m_arena->Alloc( npt * 3 * sizeof(double) );
+        geoPtMulti = (double *) m_arena->Alloc( npt * 2 * sizeof(double) );
+    }
+    else {
+        geoPtz = (double *) malloc( npt * 3 * sizeof(double) );
+        geoPtMulti = (double *) malloc( npt * 2 * sizeof(double) );
+    }
 
     double *pdd = geoPtz;
     double *pdl = geoPtMulti;
@@ -400,13 +491,24 @@ bool S57Obj::SetMultipointGeometry( MultipointGeometryDescriptor *pGeo, double r
 
 
 int S57Obj::GetAttributeIndex( const char *AttrSeek ) {
+    return GetAttributeIndex( S57AttrCodeFromAcronym( AttrSeek ) );
+}
+
+int S57Obj::GetAttributeIndex( S57AttrCode code ) {
+    if( att_codes ) {
+        for(int i=0 ; i < n_attr ; i++) {
+            if( att_codes[i] == code )
+                return i;
+        }
+        return -1;
+    }
+
+    //  Objects assembled outside of S57Obj, e.g. plugin chart objects, carry only the acronyms
     char *patl = att_array;
 
     for(int i=0 ; i < n_attr ; i++) {
-        if(!strncmp(patl, AttrSeek, 6)){
+        if( S57AttrCodeFromAcronym( patl ) == code )
             return i;
-            break;
-        }
 
         patl += 6;
     }
@@ -414,6 +516,47 @@ int S57Obj::GetAttributeIndex( const char *AttrSeek ) {
     return -1;
 }
 
+bool S57Obj::GetAttrInt( const char *acronym, int &val )
+{
+    int idx = GetAttributeIndex( acronym );
+    if( idx < 0 )
+        return false;
+
+    S57attVal *v = attVal->Item( idx );
+    if( v->valType != OGR_INT )
+        return false;
+
+    val = *(int *) ( v->value );
+    return true;
+}
+
+bool S57Obj::GetAttrDouble( const char *acronym, double &val )
+{
+    int idx = GetAttributeIndex( acronym );
+    if( idx < 0 )
+        return false;
+
+    S57attVal *v = attVal->Item( idx );
+    if( v->valType != OGR_REAL )
+        return false;
+
+    val = *(double *) ( v->value );
+    return true;
+}
+
+const char *S57Obj::GetAttrString( const char *acronym )
+{
+    int idx = GetAttributeIndex( acronym );
+    if( idx < 0 )
+        return NULL;
+
+    S57attVal *v = attVal->Item( idx );
+    if( v->valType != OGR_STR )
+        return NULL;
+
+    return (const char *) ( v->value );
+}
+
 
 wxString S57Obj::GetAttrValueAsString( const char *AttrName )
 {
@@ -38,6 +38,9 @@
 #include "tcmgr.h"
 #include "georef.h"
 #include "logger.h"
+#include "bbox.h"
+
+#include <algorithm>
 
 //-----------------------------------------------------------------------------------
 //    TIDELIB
@@ -178,9 +181,8 @@ double time2mean (time_t t, IDX_entry *pIDX)
 
     for (a=0; a<pIDX->num_csts; a++) {
         if (pIDX->m_cst_speeds[a] < 6e-6) {
-            tide += pIDX->m_work_buffer[a] *
-                    cos (pIDX->m_cst_speeds[a] * ((long)(t - pIDX->epoch) + pIDX->pref_sta_data->meridian) +
-                    pIDX->m_cst_epochs[a][pIDX->epoch_year-pIDX->first_year] - pIDX->pref_sta_data->epoch[a]);
+            tide += pIDX->m_year_mult[a] *
+                    cos (pIDX->m_cst_speeds[a] * (long)(t - pIDX->epoch) + pIDX->m_year_phase[a]);
         }
     }
 
@@ -415,10 +417,9 @@ double _time2dt_tide (time_t t, int deriv, IDX_entry *pIDX)
     tempd = M_PI / 2.0 * deriv;
     for (a=0; a<pIDX->num_csts; a++)
     {
-        term = pIDX->m_work_buffer[a] *
+        term = pIDX->m_year_mult[a] *
                cos(tempd +
-                   pIDX->m_cst_speeds[a] * ((long)(t - pIDX->epoch) + pIDX->pref_sta_data->meridian) +
-                   pIDX->m_cst_epochs[a][pIDX->epoch_year-pIDX->first_year] - pIDX->pref_sta_data->epoch[a]);
+                   pIDX->m_cst_speeds[a] * (long)(t - pIDX->epoch) + pIDX->m_year_phase[a]);
         for (b = deriv; b > 0; b--)
             term *= pIDX->m_cst_speeds[a];
         dt_tide += term;
@@ -480,8 +481,10 @@ double blend_tide (time_t t, unsigned int deriv, int first_year, double blend, I
     /*
      * If we are already happy_new_year()ed into one of the two years
      * of interest, compute that years tide values first.
+     * Go by the year actually loaded, not the year of t: the two
+     * differ inside the blend window.
      */
-    int year = yearoftimet(t);
+    int year = pIDX->epoch_year;
     if (year == first_year + 1)
         fp = fr;
     else if (year != first_year)
@@ -520,7 +523,6 @@ double blend_tide (time_t t, unsigned int deriv, int first_year, double blend, I
         f += fact * w[n] * (fr[deriv-n] - fl[deriv-n]);
         fact *= (double)(deriv - n)/(n+1) * (1.0/TIDE_BLEND_TIME);
     }
-    printf(" %ld  %g     %g %g %g\n", (long)t, blend, fr[0], fl[0], f);
     return f;
 }
 
@@ -592,14 +594,36 @@ void figure_max_amplitude (IDX_entry *pIDX)
 }
 
 /* Figure out normalized multipliers for constituents for a particular year. */
+/* The multipliers, and the part of each constituent's phase which is fixed
+ * for the year, are kept with the station.  They are only rebuilt when the
+ * year or the reference station data changes. */
 void figure_multipliers (IDX_entry *pIDX, int year)
 {
     int a;
+    Station_Data *pmsd = pIDX->pref_sta_data;
+
+    if (pIDX->m_table_sta != pmsd || pIDX->m_table_csts != pIDX->num_csts) {
+        free (pIDX->m_year_mult);
+        free (pIDX->m_year_phase);
+        pIDX->m_year_mult = (double *) malloc (pIDX->num_csts * sizeof (double));
+        pIDX->m_year_phase = (double *) malloc (pIDX->num_csts * sizeof (double));
+        pIDX->m_table_sta = pmsd;
+        pIDX->m_table_csts = pIDX->num_csts;
+        pIDX->m_table_year = 0;
+        pIDX->max_amplitude = 0.0;
+    }
+
+    if (pIDX->m_table_year == year)
+        return;
 
     figure_max_amplitude( pIDX );
+    int iyear = year - pIDX->first_year;
     for (a = 0; a < pIDX->num_csts; a++) {
-        pIDX->m_work_buffer[a] = pIDX->pref_sta_data->amplitude[a] * pIDX->m_cst_nodes[a][year-pIDX->first_year] / pIDX->max_amplitude;  // BOGUS_amplitude?
+        pIDX->m_year_mult[a] = pmsd->amplitude[a] * pIDX->m_cst_nodes[a][iyear] / pIDX->max_amplitude;  // BOGUS_amplitude?
+        pIDX->m_year_phase[a] = pIDX->m_cst_speeds[a] * pmsd->meridian +
+                                pIDX->m_cst_epochs[a][iyear] - pmsd->epoch[a];
     }
+    pIDX->m_table_year = year;
 }
 
 
@@ -674,15 +698,22 @@ int yearoftimet (time_t t)
 }
 
 
+/* time_t of 00:00 UTC January 1st of year.
+ * Same as tm2gmt() on that date, without the bitwise search. */
+time_t year_epoch (int year)
+{
+    if (year < 1970)
+        return 0;
+
+    long y = year - 1;
+    long days = 365L * (year - 1970) + (y / 4 - y / 100 + y / 400) - (1969 / 4 - 1969 / 100 + 1969 / 400);
+    return (time_t) days * 86400;
+}
+
 /* Calculate time_t of the epoch. */
 void set_epoch (IDX_entry *pIDX, int year)
 {
-    struct tm ht;
-
-    ht.tm_year = year - 1900;
-    ht.tm_sec = ht.tm_min = ht.tm_hour = ht.tm_mon = 0;
-    ht.tm_mday = 1;
-    pIDX->epoch = tm2gmt (&ht);
+    pIDX->epoch = year_epoch (year);
 }
 
 /* Re-initialize for a different year */
@@ -696,6 +727,7 @@ void happy_new_year (IDX_entry *pIDX, int new_year)
 //      TCMgr Implementation
 TCMgr::TCMgr()
 {
+    m_event_clock = 0;
 }
 
 TCMgr::~TCMgr()
@@ -712,6 +744,11 @@ void TCMgr::PurgeData()
         m_Combined_IDX_array.Detach(0);
     }
 
+    m_cell_start.clear();
+    m_cell_stations.clear();
+    m_name_index.clear();
+    m_event_cache.clear();
+
     //  Delete all the data sources
     m_source_array.Clear();
 }
@@ -756,6 +793,8 @@ TC_Error_Code TCMgr::LoadDataSources(wxArrayString &sources)
         }
     }
 
+    BuildStationIndex();
+
     bTCMReady = true;
     
     if (m_Combined_IDX_array.Count() <= 1)
@@ -800,7 +839,6 @@ bool TCMgr::GetTideOrCurrent(time_t t, int idx, float &tcvalue, float& dir)
             return false;
     }
 
-    pIDX->max_amplitude = 0.0;                // Force multiplier re-compute
     int yott = yearoftimet( t );
 
     happy_new_year (pIDX, yott);              //Calculate new multipliers
@@ -818,6 +856,79 @@ bool TCMgr::GetTideOrCurrent(time_t t, int idx, float &tcvalue, float& dir)
     return(true); // Got it!
 }
 
+//  Evaluate a station at count times t0, t0 + step, ...
+//  Stations without offsets are summed for all the times at once, rotating
+//  each constituent's phase by a fixed angle per step instead of calling cos()
+//  for every sample.  Stations with offsets, and spans that need new year
+//  blending, go through time2asecondary() sample by sample.
+bool TCMgr::GetTideOrCurrentSeries(time_t t0, int step, int count, int idx,
+                                   std::vector<float> &values, std::vector<float> &dirs)
+{
+    values.assign(count, 0.);
+    dirs.assign(count, 0.);
+
+    if( (idx < 1) || (idx >= (int)m_Combined_IDX_array.GetCount()) )
+        return false;
+
+    IDX_entry *pIDX = &m_Combined_IDX_array[idx];
+    if( !pIDX->IDX_Useable )
+        return false;
+
+    if(pIDX->pDataSource) {
+        if(pIDX->pDataSource->LoadHarmonicData(pIDX) != TC_NO_ERROR)
+            return false;
+    }
+
+    happy_new_year (pIDX, yearoftimet( t0 ));
+
+    time_t ta = t0 + pIDX->station_tz_offset;
+    time_t tb = ta + (time_t)step * (count - 1);
+    int year = yearoftimet( ta );
+    bool b_direct = !pIDX->have_offsets && (step > 0) && (count > 1)
+                    && (year == yearoftimet( tb ))
+                    && (year >= pIDX->first_year) && (year < pIDX->first_year + pIDX->num_epochs)
+                    && (ta - year_epoch( year ) > TIDE_BLEND_TIME)
+                    && (year_epoch( year + 1 ) - tb > TIDE_BLEND_TIME);
+
+    if( b_direct ) {
+        happy_new_year (pIDX, year);
+
+        int n = pIDX->num_csts;
+        std::vector<double> c(n), s(n), cd(n), sd(n);
+        for(int a = 0; a < n; a++) {
+            double speed = pIDX->m_cst_speeds[a];
+            double phase = speed * (long)(ta - pIDX->epoch) + pIDX->m_year_phase[a];
+            c[a] = pIDX->m_year_mult[a] * cos(phase);
+            s[a] = pIDX->m_year_mult[a] * sin(phase);
+            cd[a] = cos(speed * step);
+            sd[a] = sin(speed * step);
+        }
+
+        for(int i = 0; i < count; i++) {
+            double tide = 0.;
+            for(int a = 0; a < n; a++) {
+                tide += c[a];
+                double cn = c[a] * cd[a] - s[a] * sd[a];
+                s[a] = s[a] * cd[a] + c[a] * sd[a];
+                c[a] = cn;
+            }
+            values[i] = BOGUS_amplitude(tide, pIDX) + pIDX->pref_sta_data->DATUM;
+        }
+    }
+    else {
+        for(int i = 0; i < count; i++) {
+            time_t t = t0 + (time_t)step * i;
+            happy_new_year (pIDX, yearoftimet( t ));       // as GetTideOrCurrent(), blending relies on it
+            values[i] = time2asecondary (t, pIDX);
+        }
+    }
+
+    for(int i = 0; i < count; i++)
+        dirs[i] = (values[i] >= 0) ? pIDX->IDX_flood_dir : pIDX->IDX_ebb_dir;
+
+    return true;
+}
+
 extern wxDateTime gTimeSource;
 
 bool TCMgr::GetTideOrCurrent15(time_t t_d, int idx, float &tcvalue, float& dir, bool &bnew_val)
@@ -917,7 +1028,6 @@ bool TCMgr::GetTideFlowSens(time_t t, int sch_step, int idx, float &tcvalue_now,
             return false;
     }
 
-    pIDX->max_amplitude = 0.0;                // Force multiplier re-compute
     int yott = yearoftimet( t );
     happy_new_year (pIDX, yott);              //Force new multipliers
 
@@ -937,73 +1047,12 @@ void TCMgr::GetHightOrLowTide(time_t t, int sch_step_1, int sch_step_2, float ti
     tcvalue = 0;
     tctime = t;
 
-    //    Load up this location data
-    IDX_entry *pIDX = &m_Combined_IDX_array[idx];             // point to the index entry
-
-    if( !pIDX )
-        return;
-
-    if( !pIDX->IDX_Useable )
-        return;                                        // no error, but unuseable
-
-    if(pIDX->pDataSource) {
-        if(pIDX->pDataSource->LoadHarmonicData(pIDX) != TC_NO_ERROR)
-            return;
-    }
-
-    // Is the cache data reasonably fresh?
-    if( abs(t - pIDX->recent_highlow_calc_time) < 60){
-        if(w_t){
-            tcvalue = pIDX->recent_high_level;
-            tctime = pIDX->recent_high_time;
-        }else{
-            tcvalue = pIDX->recent_low_level;
-            tctime = pIDX->recent_low_time;
-        }
-        return;
+    //    The nearest high (w_t) or low in the direction of the search steps
+    TC_Event event;
+    if( GetNextTideEvent( idx, t, sch_step_1 > 0, w_t ? TC_EVENT_HIGHS : TC_EVENT_LOWS, event ) ) {
+        tcvalue = event.value;
+        tctime = event.t;
     }
-
-
-    pIDX->max_amplitude = 0.0;                // Force multiplier re-compute
-    int yott = yearoftimet( t );
-    happy_new_year (pIDX, yott);
-
-    // Finally, calculate the Hight and low tides
-    double newval = tide_val;
-    double oldval = ( w_t ) ? newval - 1: newval + 1 ;
-    int j = 0 ;
-    int k = 0 ;
-    int ttt = 0 ;
-    while ( (newval > oldval) == w_t )                  //searching each ten minute
-    {
-        j++;
-        oldval = newval;
-        ttt = t + ( sch_step_1 * j );
-        newval = time2asecondary (ttt, pIDX);
-    }
-    oldval = ( w_t ) ? newval - 1: newval + 1 ;
-    while ( (newval > oldval) == w_t )                  // searching back each minute
-    {
-        oldval = newval ;
-        k++;
-        ttt = t +  ( sch_step_1 * j ) - ( sch_step_2 * k ) ;
-        newval = time2asecondary (ttt, pIDX);
-    }
-    tcvalue = newval;
-    tctime = ttt + sch_step_2 ;
-    
-    // Cache the data
-    pIDX->recent_highlow_calc_time = t;
-    if(w_t){
-        pIDX->recent_high_level = newval;
-        pIDX->recent_high_time = tctime;
-    }
-    else{
-        pIDX->recent_low_level = newval;
-        pIDX->recent_low_time = tctime;
-    }
-        
-
 }
 
 int TCMgr::GetStationTimeOffset(IDX_entry *pIDX)
@@ -1023,36 +1072,221 @@ double  TCMgr::GetStationLon(IDX_entry *pIDX)
 
 int TCMgr::GetNextBigEvent(time_t *tm, int idx)
 {
-    float tcvalue[1];
-    float dir;
-    bool ret;
-    double p, q;
-    int flags = 0, slope = 0;
-    ret = GetTideOrCurrent(*tm, idx, tcvalue[0],  dir);
-    p = tcvalue[0];
-    *tm += 60;
-    ret = GetTideOrCurrent(*tm, idx, tcvalue[0],  dir);
-    q = tcvalue[0];
-    *tm += 60;
-    if (p < q)
-        slope = 1;
-    while (1) {
-        if ((slope == 1 && q < p) || (slope == 0 && p < q)) {
-            /* Tide event */
-            flags |= (1 << slope);
+    //    Returns 1 for a low, 2 for a high, with *tm set to its time
+    TC_Event event;
+    if( !GetNextTideEvent( idx, *tm, true, TC_EVENT_HIGHS | TC_EVENT_LOWS, event ) )
+        return 0;
+
+    *tm = event.t;
+    return ( TC_EVENT_BIT( event.type ) & TC_EVENT_HIGHS ) ? 2 : 1;
+}
+
+//      Tide and current events
+
+#define TC_EVENT_DAY            86400
+#define TC_EVENT_STEP           600             // sampling step, events closer than this may be missed
+#define TC_EVENT_HORIZON        ( 62 * TC_EVENT_DAY )   // longest span kept per station
+#define TC_EVENT_SEARCH_DAYS    4               // how far GetNextTideEvent() looks
+#define TC_EVENT_MAX_STATIONS   512
+
+/* Rate of change of the station tide, only its sign matters.
+ * Offsets make time2asecondary() a composite of the reference tide,
+ * so stations with offsets use a central difference over a minute. */
+static double tide_slope (time_t t, IDX_entry *pIDX)
+{
+    if (!pIDX->have_offsets)
+        return time2dt_tide (t + pIDX->station_tz_offset, 1, pIDX);
+
+    return time2asecondary (t + 30, pIDX) - time2asecondary (t - 30, pIDX);
+}
+
+/* Find the events with t0 <= time < t1 and append them to events.
+ * The tide is sampled every TC_EVENT_STEP seconds; a change of sign of the
+ * slope between samples brackets a high or low, a change of sign of a current
+ * brackets a slack.  Each is then narrowed to the second by bisection. */
+static void find_tide_events (IDX_entry *pIDX, time_t t0, time_t t1, std::vector<TC_Event> &events)
+{
+    bool bcurrent = (pIDX->IDX_type == 'c') || (pIDX->IDX_type == 'C');
+    size_t first = events.size();
+
+    happy_new_year (pIDX, yearoftimet (t0));
+
+    time_t t = t0;
+    double v = time2asecondary (t, pIDX);
+    bool brising = tide_slope (t, pIDX) > 0;
+
+    while (t < t1) {
+        time_t tn = t + TC_EVENT_STEP;
+        double vn = time2asecondary (tn, pIDX);
+        bool brising_n = tide_slope (tn, pIDX) > 0;
+
+        if (brising != brising_n) {
+            time_t lo = t, hi = tn;
+            while (hi - lo > 1) {
+                time_t mid = lo + (hi - lo) / 2;
+                if ((tide_slope (mid, pIDX) > 0) == brising)
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+
+            TC_Event event;
+            event.t = hi;
+            event.value = time2asecondary (hi, pIDX);
+            event.type = -1;
+            if (!bcurrent)
+                event.type = brising ? TC_EVENT_HIGH_TIDE : TC_EVENT_LOW_TIDE;
+            else if (brising && event.value > 0)
+                event.type = TC_EVENT_MAX_FLOOD;
+            else if (!brising && event.value < 0)
+                event.type = TC_EVENT_MAX_EBB;          // weaker turns of the current are not events
+
+            if (event.type >= 0)
+                events.push_back (event);
         }
-        if (flags) {
-            *tm -= 60;
-            if (flags < 4)
-                *tm -= 60;
-            return flags;
+
+        if (bcurrent && ((v > 0) != (vn > 0))) {
+            time_t lo = t, hi = tn;
+            while (hi - lo > 1) {
+                time_t mid = lo + (hi - lo) / 2;
+                if ((time2asecondary (mid, pIDX) > 0) == (v > 0))
+                    lo = mid;
+                else
+                    hi = mid;
+            }
+
+            TC_Event event;
+            event.t = hi;
+            event.value = time2asecondary (hi, pIDX);
+            event.type = TC_EVENT_SLACK;
+            events.push_back (event);
         }
-        p = q;
-        ret = GetTideOrCurrent(*tm, idx, tcvalue[0],  dir);
-        q = tcvalue[0];
-        *tm += 60;
+
+        t = tn;
+        v = vn;
+        brising = brising_n;
+    }
+
+    //  A slack and a turn in the same step may have been found out of order
+    for (size_t i = first + 1; i < events.size(); i++) {
+        for (size_t j = i; (j > first) && (events[j].t < events[j - 1].t); j--)
+            std::swap (events[j], events[j - 1]);
     }
-    return 0;
+}
+
+static bool TideEventBefore( const TC_Event &event, time_t t )
+{
+    return event.t < t;
+}
+
+//  The station's timeline, extended by whole days to cover t0 to t1
+TC_Event_Timeline *TCMgr::GetEventTimeline(int idx, time_t t0, time_t t1)
+{
+    if( ( idx < 1 ) || ( idx > Get_max_IDX() ) )
+        return NULL;
+
+    IDX_entry *pIDX = &m_Combined_IDX_array[idx];
+
+    if( !pIDX->IDX_Useable )
+        return NULL;
+
+    if(pIDX->pDataSource) {
+        if(pIDX->pDataSource->LoadHarmonicData(pIDX) != TC_NO_ERROR)
+            return NULL;
+    }
+
+    time_t day0 = t0 - ( ( t0 % TC_EVENT_DAY ) + TC_EVENT_DAY ) % TC_EVENT_DAY;
+    time_t day1 = t1 - ( ( t1 % TC_EVENT_DAY ) + TC_EVENT_DAY ) % TC_EVENT_DAY;
+    if( day1 < t1 )
+        day1 += TC_EVENT_DAY;
+
+    std::map<int, TC_Event_Timeline>::iterator it = m_event_cache.find( idx );
+    if( it == m_event_cache.end() ) {
+        //  Make room by dropping the least recently used station
+        if( m_event_cache.size() >= TC_EVENT_MAX_STATIONS ) {
+            std::map<int, TC_Event_Timeline>::iterator oldest = m_event_cache.begin();
+            for( std::map<int, TC_Event_Timeline>::iterator e = m_event_cache.begin(); e != m_event_cache.end(); ++e ) {
+                if( e->second.m_last_use < oldest->second.m_last_use )
+                    oldest = e;
+            }
+            m_event_cache.erase( oldest );
+        }
+        it = m_event_cache.insert( std::make_pair( idx, TC_Event_Timeline() ) ).first;
+    }
+    TC_Event_Timeline &timeline = it->second;
+    timeline.m_last_use = ++m_event_clock;
+
+    //  Start over rather than keep a span longer than the horizon
+    if( ( timeline.m_start == timeline.m_end ) ||
+        ( wxMax( day1, timeline.m_end ) - wxMin( day0, timeline.m_start ) > TC_EVENT_HORIZON ) ) {
+        timeline.m_events.clear();
+        timeline.m_start = timeline.m_end = day0;
+    }
+
+    if( day0 < timeline.m_start ) {
+        std::vector<TC_Event> before;
+        find_tide_events( pIDX, day0, timeline.m_start, before );
+        timeline.m_events.insert( timeline.m_events.begin(), before.begin(), before.end() );
+        timeline.m_start = day0;
+    }
+
+    if( day1 > timeline.m_end ) {
+        find_tide_events( pIDX, timeline.m_end, day1, timeline.m_events );
+        timeline.m_end = day1;
+    }
+
+    return &timeline;
+}
+
+bool TCMgr::GetTideEvents(int idx, time_t t0, time_t t1, std::vector<TC_Event> &events)
+{
+    events.clear();
+
+    TC_Event_Timeline *timeline = GetEventTimeline( idx, t0, t1 );
+    if( !timeline )
+        return false;
+
+    const std::vector<TC_Event> &cached = timeline->m_events;
+    std::vector<TC_Event>::const_iterator first =
+        std::lower_bound( cached.begin(), cached.end(), t0, TideEventBefore );
+    std::vector<TC_Event>::const_iterator last =
+        std::lower_bound( first, cached.end(), t1, TideEventBefore );
+    events.assign( first, last );
+    return true;
+}
+
+bool TCMgr::GetNextTideEvent(int idx, time_t t, bool bforward, int type_mask, TC_Event &event)
+{
+    for( int days = 1; days <= TC_EVENT_SEARCH_DAYS; days++ ) {
+        time_t t0 = bforward ? t : t - days * TC_EVENT_DAY;
+        time_t t1 = bforward ? t + days * TC_EVENT_DAY : t;
+
+        TC_Event_Timeline *timeline = GetEventTimeline( idx, t0, t1 );
+        if( !timeline )
+            return false;
+
+        const std::vector<TC_Event> &events = timeline->m_events;
+        std::vector<TC_Event>::const_iterator it =
+            std::lower_bound( events.begin(), events.end(), t, TideEventBefore );
+
+        if( bforward ) {
+            for( ; ( it != events.end() ) && ( it->t < t1 ); ++it ) {
+                if( TC_EVENT_BIT( it->type ) & type_mask ) {
+                    event = *it;
+                    return true;
+                }
+            }
+        } else {
+            while( ( it != events.begin() ) && ( ( it - 1 )->t >= t0 ) ) {
+                --it;
+                if( TC_EVENT_BIT( it->type ) & type_mask ) {
+                    event = *it;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
 }
 
 std::map<double, const IDX_entry*> TCMgr::GetStationsForLL(double xlat, double xlon) const
@@ -1077,59 +1311,192 @@ std::map<double, const IDX_entry*> TCMgr::GetStationsForLL(double xlat, double x
 
 int TCMgr::GetStationIDXbyName(const wxString & prefix, double xlat, double xlon) const
 {
-    const IDX_entry *lpIDX;
-    int jx = 0;
-    wxString locn;
-    double distx = 100000.;
+    return FindStationByName(prefix, xlat, xlon, "tT");        // only Tides
+}
 
-    int jmax = Get_max_IDX();
 
-    for ( int j=1 ; j<Get_max_IDX() +1 ; j++ ) {
-        lpIDX = GetIDX_entry ( j );
-        char type = lpIDX->IDX_type;             // Entry "TCtcIUu" identifier
-        wxString locnx ( lpIDX->IDX_station_name, wxConvUTF8 );
+int TCMgr::GetStationIDXbyNameType(const wxString & prefix, double xlat, double xlon, char type) const
+{
+    char types[2] = { type, 0 };
+    return FindStationByName(prefix, xlat, xlon, types);
+}
 
-        if ( (( type == 't' ) ||  ( type == 'T' ) )   // only Tides
-                && (locnx.StartsWith(prefix))) {
-            double brg, dist;
-            DistanceBearingMercator(xlat, xlon, lpIDX->IDX_lat, lpIDX->IDX_lon, &brg, &dist);
-            if (dist < distx) {
-                distx = dist;
-                jx = j;
-            }
+//  Nearest station whose name starts with prefix
+int TCMgr::FindStationByName(const wxString & prefix, double xlat, double xlon, const char *types) const
+{
+    if(prefix.IsEmpty())
+        return GetNearestStationIDX(xlat, xlon, types);
+
+    wxCharBuffer buf = prefix.ToUTF8();
+    const char *pfx = buf.data();
+    size_t len = strlen(pfx);
+
+    //  The matching names are contiguous in the name index
+    std::vector<int>::const_iterator it = m_name_index.begin();
+    int lo = 0, hi = m_name_index.size();
+    while(lo < hi) {
+        int mid = (lo + hi) / 2;
+        if(strncmp(m_Combined_IDX_array[m_name_index[mid]].IDX_station_name, pfx, MAXNAMELEN) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    int jx = 0;
+    double distx = 100000.;
+    for(it += lo ; it != m_name_index.end() ; ++it) {
+        const IDX_entry *lpIDX = &m_Combined_IDX_array[*it];
+        if(strncmp(lpIDX->IDX_station_name, pfx, len))
+            break;
+        if(!lpIDX->IDX_type || !strchr(types, lpIDX->IDX_type))
+            continue;
+
+        double brg, dist;
+        DistanceBearingMercator(xlat, xlon, lpIDX->IDX_lat, lpIDX->IDX_lon, &brg, &dist);
+        if((dist < distx) || ((dist == distx) && (*it < jx))) {
+            distx = dist;
+            jx = *it;
         }
-    } // end for loop
-    //} // end if @~~ found in WP
+    }
     return(jx);
 }
 
+//      Station index
 
-int TCMgr::GetStationIDXbyNameType(const wxString & prefix, double xlat, double xlon, char type) const
+#define TC_CELL_ROWS    180
+#define TC_CELL_COLS    360
+
+static int StationCellRow( double lat )
 {
-    const IDX_entry *lpIDX;
+    int row = (int) floor( lat ) + 90;
+    return wxMax( 0, wxMin( TC_CELL_ROWS - 1, row ) );
+}
+
+static int StationCellCol( int col )
+{
+    col %= TC_CELL_COLS;
+    return ( col < 0 ) ? col + TC_CELL_COLS : col;
+}
+
+static bool StationNameLess( const IDX_entry *a, const IDX_entry *b )
+{
+    int cmp = strncmp( a->IDX_station_name, b->IDX_station_name, MAXNAMELEN );
+    return ( cmp < 0 ) || ( ( cmp == 0 ) && ( a->IDX_rec_num < b->IDX_rec_num ) );
+}
+
+void TCMgr::BuildStationIndex(void)
+{
+    int n_stations = Get_max_IDX();
+
+    //  Count the stations in each cell, then lay them out in index order
+    std::vector<int> cells( n_stations + 1, -1 );
+    m_cell_start.assign( TC_CELL_ROWS * TC_CELL_COLS + 1, 0 );
+    for( int i = 1 ; i <= n_stations ; i++ ) {
+        const IDX_entry *pIDX = &m_Combined_IDX_array[i];
+        if( !( fabs( pIDX->IDX_lat ) <= 90. ) || !( fabs( pIDX->IDX_lon ) <= 360. ) )
+            continue;                   // not a position, never drawn
+        cells[i] = StationCellRow( pIDX->IDX_lat ) * TC_CELL_COLS
+                   + StationCellCol( (int) floor( pIDX->IDX_lon ) );
+        m_cell_start[cells[i] + 1]++;
+    }
+    for( int c = 0 ; c < TC_CELL_ROWS * TC_CELL_COLS ; c++ )
+        m_cell_start[c + 1] += m_cell_start[c];
+
+    m_cell_stations.resize( m_cell_start.back() );
+    std::vector<int> fill( m_cell_start.begin(), m_cell_start.end() - 1 );
+    for( int i = 1 ; i <= n_stations ; i++ ) {
+        if( cells[i] >= 0 )
+            m_cell_stations[fill[cells[i]]++] = i;
+    }
+
+    std::vector<const IDX_entry *> by_name( n_stations );
+    for( int i = 1 ; i <= n_stations ; i++ )
+        by_name[i - 1] = &m_Combined_IDX_array[i];
+    std::sort( by_name.begin(), by_name.end(), StationNameLess );
+
+    m_name_index.resize( n_stations );
+    for( int i = 0 ; i < n_stations ; i++ )
+        m_name_index[i] = by_name[i]->IDX_rec_num;
+}
+
+void TCMgr::GetStationsInBBox(const LLBBox &box, double marge, std::vector<int> &stations) const
+{
+    stations.clear();
+
+    int row0 = StationCellRow( box.GetMinLat() - marge );
+    int row1 = StationCellRow( box.GetMaxLat() + marge );
+    double minlon = box.GetMinLon() - marge;
+    double maxlon = box.GetMaxLon() + marge;
+
+    //  A box wider than the index is cheaper to answer with every station
+    long n_cells = (long) ( row1 - row0 + 1 ) * (long) ( maxlon - minlon + 2 );
+    if( !box.GetValid() || ( maxlon - minlon >= TC_CELL_COLS - 1 ) ||
+        ( n_cells > (long) m_cell_stations.size() ) ) {
+        for( int i = 1 ; i <= Get_max_IDX() ; i++ )
+            stations.push_back( i );
+        return;
+    }
+
+    //  Columns wrap, so a box crossing the date line needs no special case
+    int col0 = (int) floor( minlon );
+    int col1 = (int) floor( maxlon );
+    for( int row = row0 ; row <= row1 ; row++ ) {
+        for( int col = col0 ; col <= col1 ; col++ ) {
+            int cell = row * TC_CELL_COLS + StationCellCol( col );
+            stations.insert( stations.end(), m_cell_stations.begin() + m_cell_start[cell],
+                             m_cell_stations.begin() + m_cell_start[cell + 1] );
+        }
+    }
+
+    std::sort( stations.begin(), stations.end() );
+}
+
+int TCMgr::GetNearestStationIDX(double xlat, double xlon, const char *types) const
+{
+    if( m_cell_start.empty() )
+        return 0;
+
+    int row0 = StationCellRow( xlat );
+    int col0 = (int) floor( xlon );
     int jx = 0;
-    wxString locn;
     double distx = 100000.;
 
-    // if (prp->m_MarkName.Find(_T("@~~")) != wxNOT_FOUND) {
-    //tide_form = prp->m_MarkName.Mid(prp->m_MarkName.Find(_T("@~~"))+3);
-    int jmax = Get_max_IDX();
-
-    for ( int j=1 ; j<Get_max_IDX() +1 ; j++ ) {
-        lpIDX = GetIDX_entry ( j );
-        char typep = lpIDX->IDX_type;             // Entry "TCtcIUu" identifier
-        wxString locnx ( lpIDX->IDX_station_name, wxConvUTF8 );
+    //  Search outward ring by ring.  Every station in ring r is more than
+    //  r-1 degrees away in latitude or in longitude, which bounds its distance.
+    for( int r = 0 ; r <= TC_CELL_COLS / 2 ; r++ ) {
+        if( jx ) {
+            double lat_bound = wxMin( 90., fabs( xlat ) + r + 1 );
+            double min_dist = 60. * ( r - 1 ) * cos( lat_bound * PI / 180. );
+            if( min_dist > distx )
+                break;
+        }
 
-        if ( ( type == typep ) && (locnx.StartsWith(prefix))) {
-            double brg, dist;
-            DistanceBearingMercator(xlat, xlon, lpIDX->IDX_lat, lpIDX->IDX_lon, &brg, &dist);
-            if (dist < distx) {
-                distx = dist;
-                jx = j;
+        for( int dr = -r ; dr <= r ; dr++ ) {
+            int row = row0 + dr;
+            if( ( row < 0 ) || ( row >= TC_CELL_ROWS ) )
+                continue;
+
+            //  Whole edge rows of the ring, only the two end cells in between
+            int step = ( ( dr == -r ) || ( dr == r ) ) ? 1 : 2 * r;
+            for( int dc = -r ; dc <= r ; dc += wxMax( step, 1 ) ) {
+                int cell = row * TC_CELL_COLS + StationCellCol( col0 + dc );
+                for( int k = m_cell_start[cell] ; k < m_cell_start[cell + 1] ; k++ ) {
+                    int j = m_cell_stations[k];
+                    const IDX_entry *lpIDX = &m_Combined_IDX_array[j];
+                    if( !lpIDX->IDX_type || !strchr( types, lpIDX->IDX_type ) )
+                        continue;
+
+                    double brg, dist;
+                    DistanceBearingMercator( xlat, xlon, lpIDX->IDX_lat, lpIDX->IDX_lon, &brg, &dist );
+                    if( ( dist < distx ) || ( ( dist == distx ) && ( j < jx ) ) ) {
+                        distx = dist;
+                        jx = j;
+                    }
+                }
             }
         }
-    } // end for loop
-    return(jx);
+    }
+    return jx;
 }
 
 